@@ -0,0 +1,24 @@
+#version 460 core
+
+in vec3 normal;
+in vec2 uv;
+in float brightness;
+
+uniform sampler2D diffuse_map;
+
+// Same direction as the main scene's directional light.
+const vec3 light_direction = normalize(vec3(-0.35, -1.0, -0.35));
+const float ambient = 0.55;
+const float diffuse = 0.45;
+
+out vec4 out_color;
+
+void main()
+{
+    vec4 color = texture(diffuse_map, uv);
+
+    // The brightness (light level and ambient occlusion) scales the ambient and the diffuse term alike, so a face in
+    // the dark stays dark no matter which way it faces.
+    float lighting = (ambient + diffuse * max(dot(normalize(normal), -light_direction), 0.0)) * brightness;
+    out_color = vec4(color.rgb * lighting, color.a);
+}
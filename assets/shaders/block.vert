@@ -0,0 +1,28 @@
+#version 460 core
+
+layout (location = 0) in vec3 in_position;
+layout (location = 1) in vec3 in_normal;
+layout (location = 2) in vec2 in_uv;
+layout (location = 3) in float in_brightness;
+
+layout (std140, binding = 0) uniform Camera
+{
+    mat4 view_projection;
+    vec3 camera_position;
+};
+
+uniform mat4 model;
+
+out vec3 normal;
+out vec2 uv;
+out float brightness;
+
+void main()
+{
+    gl_Position = view_projection * model * vec4(in_position, 1.0);
+
+    // Chunks are only ever translated, so the normals don't have to be transformed.
+    normal = in_normal;
+    uv = in_uv;
+    brightness = in_brightness;
+}
@@ -2,4 +2,16 @@
 
 #include <battery/embed.hpp>
 
+namespace {
+
+[[nodiscard]] auto as_text(std::span<const std::byte> data) -> std::string_view
+{
+    return std::string_view{ reinterpret_cast<const char*>(data.data()), data.size() };
+}
+
+} // namespace
+
 const std::span<const std::byte> blocks_texture_data = b::embed<"assets/textures/blocks.png">().data();
+
+const std::string_view block_vertex_shader_source = as_text(b::embed<"assets/shaders/block.vert">().data());
+const std::string_view block_fragment_shader_source = as_text(b::embed<"assets/shaders/block.frag">().data());
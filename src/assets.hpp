@@ -1,3 +1,6 @@
 #pragma once
 
 extern const std::span<const std::byte> blocks_texture_data;
+
+extern const std::string_view block_vertex_shader_source;
+extern const std::string_view block_fragment_shader_source;
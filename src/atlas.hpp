@@ -2,6 +2,7 @@
 
 using QuadTextureCoordinates = std::array<glm::vec2, zth::vertices_per_quad>;
 
+// Everything is constexpr, so that the coordinates of fixed tiles can be worked out at compile time.
 class TextureAtlas
 {
 public:
@@ -11,8 +12,35 @@ public:
           _col_step(1.0f / static_cast<float>(_cols))
     {}
 
-    [[nodiscard]] auto operator[](usize index) const -> QuadTextureCoordinates;
-    [[nodiscard]] auto operator[](usize row, usize col) const -> QuadTextureCoordinates;
+    [[nodiscard]] constexpr auto operator[](usize index) const -> QuadTextureCoordinates
+    {
+        return operator[](index / _cols, index % _cols);
+    }
+
+    [[nodiscard]] constexpr auto operator[](usize row, usize col) const -> QuadTextureCoordinates
+    {
+        // Tiles used at compile time are checked with a static_assert by the caller.
+        if !consteval
+        {
+            ZTH_ASSERT(row < _rows && col < _cols);
+        }
+
+        row = _rows - row - 1; // Have to reverse the row because OpenGL textures have 0 at the bottom on the y-axis.
+
+        auto x1 = static_cast<float>(col) * _col_step;
+        auto x2 = static_cast<float>(col + 1) * _col_step;
+        auto y1 = static_cast<float>(row + 1) * _row_step;
+        auto y2 = static_cast<float>(row) * _row_step;
+
+        return QuadTextureCoordinates{
+            glm::vec2{ x1, y1 }, // top-left
+            glm::vec2{ x1, y2 }, // bottom-left
+            glm::vec2{ x2, y2 }, // bottom-right
+            glm::vec2{ x2, y1 }, // top-right
+        };
+    }
+
+    [[nodiscard]] constexpr auto tile_count() const -> usize { return _rows * _cols; }
 
 private:
     usize _rows = 0;
@@ -0,0 +1,163 @@
+#include "flight_path.hpp"
+
+#include <fstream>
+
+auto FlightPath::sprint(glm::vec3 start, glm::vec3 direction, float speed, double duration) -> FlightPath
+{
+    direction = glm::normalize(direction);
+
+    FlightPath result;
+    result.add({ .time = 0.0, .position = start, .direction = direction });
+    result.add({
+        .time = duration,
+        .position = start + direction * speed * static_cast<float>(duration),
+        .direction = direction,
+    });
+    return result;
+}
+
+auto FlightPath::circle(glm::vec3 center, float radius, float speed, double duration) -> FlightPath
+{
+    // The circle is approximated with a waypoint every few blocks.
+    constexpr auto waypoint_spacing = 4.0f;
+
+    FlightPath result;
+
+    auto angular_speed = speed / radius;
+    auto time_step = static_cast<double>(waypoint_spacing / speed);
+    auto steps = static_cast<usize>(std::ceil(duration / time_step));
+
+    for (usize i = 0; i <= steps; i++)
+    {
+        auto time = std::min(static_cast<double>(i) * time_step, duration);
+        auto angle = angular_speed * static_cast<float>(time);
+        auto offset = glm::vec3{ std::cos(angle), 0.0f, std::sin(angle) };
+
+        result.add({
+            .time = time,
+            .position = center + offset * radius,
+            .direction = glm::vec3{ -offset.z, 0.0f, offset.x },
+        });
+    }
+
+    return result;
+}
+
+auto FlightPath::teleports(glm::vec3 start, glm::vec3 offset, usize count, double hold_time) -> FlightPath
+{
+    // Every hold ends at the same time as the next one starts, which is what makes the camera teleport.
+
+    FlightPath result;
+
+    for (usize i = 0; i <= count; i++)
+    {
+        auto time = static_cast<double>(i) * hold_time;
+        auto position = start + offset * static_cast<float>(i);
+
+        result.add({ .time = time, .position = position, .direction = zth::math::world_forward });
+        result.add({ .time = time + hold_time, .position = position, .direction = zth::math::world_forward });
+    }
+
+    return result;
+}
+
+auto FlightPath::load(const std::filesystem::path& path) -> Optional<FlightPath>
+{
+    std::ifstream file{ path };
+
+    if (!file)
+        return nil;
+
+    FlightPath result;
+    FlightWaypoint waypoint;
+
+    while (file >> waypoint.time >> waypoint.position.x >> waypoint.position.y >> waypoint.position.z
+           >> waypoint.direction.x >> waypoint.direction.y >> waypoint.direction.z)
+    {
+        if (!result.empty() && waypoint.time < result._waypoints.back().time)
+            return nil;
+
+        result.add(waypoint);
+    }
+
+    if (!file.eof())
+        return nil;
+
+    return result;
+}
+
+auto FlightPath::save(const std::filesystem::path& path) const -> bool
+{
+    std::ofstream file{ path };
+
+    if (!file)
+        return false;
+
+    for (const auto& [time, position, direction] : _waypoints)
+    {
+        file << std::format("{} {} {} {} {} {} {}\n", time, position.x, position.y, position.z, direction.x,
+                            direction.y, direction.z);
+    }
+
+    return static_cast<bool>(file);
+}
+
+auto FlightPath::add(const FlightWaypoint& waypoint) -> void
+{
+    ZTH_ASSERT(_waypoints.empty() || waypoint.time >= _waypoints.back().time);
+    _waypoints.push_back(waypoint);
+}
+
+auto FlightPath::clear() -> void
+{
+    _waypoints.clear();
+}
+
+auto FlightPath::duration() const -> double
+{
+    if (_waypoints.empty())
+        return 0.0;
+
+    return _waypoints.back().time;
+}
+
+auto FlightPath::sample(double time) const -> FlightWaypoint
+{
+    if (_waypoints.empty())
+        return FlightWaypoint{ .time = time };
+
+    // First waypoint which comes after the time. Out of two waypoints with the same time, this always picks the one
+    // after the teleport.
+    auto next = std::ranges::upper_bound(_waypoints, time, {}, &FlightWaypoint::time);
+
+    if (next == _waypoints.begin())
+        return _waypoints.front();
+
+    if (next == _waypoints.end())
+        return _waypoints.back();
+
+    const auto& a = *std::prev(next);
+    const auto& b = *next;
+
+    auto t = static_cast<float>((time - a.time) / (b.time - a.time));
+    auto direction = glm::mix(a.direction, b.direction, t);
+
+    return FlightWaypoint{
+        .time = time,
+        .position = glm::mix(a.position, b.position, t),
+        .direction = glm::length(direction) > 0.0f ? glm::normalize(direction) : b.direction,
+    };
+}
+
+auto FlightPath::teleports_between(double from, double to) const -> bool
+{
+    for (usize i = 1; i < _waypoints.size(); i++)
+    {
+        auto time = _waypoints[i].time;
+
+        if (time == _waypoints[i - 1].time && time > from && time <= to)
+            return true;
+    }
+
+    return false;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+struct FlightWaypoint
+{
+    double time = 0.0; // In seconds.
+    glm::vec3 position{ 0.0f };
+    glm::vec3 direction = zth::math::world_forward;
+};
+
+// Path the camera follows during a benchmark, made out of waypoints sorted by time. The pose is interpolated linearly
+// between the waypoints, except for two consecutive waypoints with the same time, which make the camera teleport.
+class FlightPath
+{
+public:
+    explicit FlightPath() = default;
+
+    // Flies in a straight line.
+    [[nodiscard]] static auto sprint(glm::vec3 start, glm::vec3 direction, float speed, double duration)
+        -> FlightPath;
+    // Flies around a horizontal circle, looking along it.
+    [[nodiscard]] static auto circle(glm::vec3 center, float radius, float speed, double duration) -> FlightPath;
+    // Stays at every location for hold_time seconds, then teleports by offset.
+    [[nodiscard]] static auto teleports(glm::vec3 start, glm::vec3 offset, usize count, double hold_time)
+        -> FlightPath;
+
+    // The file holds one waypoint per line: time, position and direction, separated by spaces.
+    [[nodiscard]] static auto load(const std::filesystem::path& path) -> Optional<FlightPath>;
+    [[nodiscard]] auto save(const std::filesystem::path& path) const -> bool;
+
+    // The time of the waypoint mustn't be earlier than the time of the last one.
+    auto add(const FlightWaypoint& waypoint) -> void;
+    auto clear() -> void;
+
+    [[nodiscard]] auto empty() const -> bool { return _waypoints.empty(); }
+    [[nodiscard]] auto duration() const -> double;
+
+    [[nodiscard]] auto sample(double time) const -> FlightWaypoint;
+    // Returns true if the path teleports at some point in (from, to].
+    [[nodiscard]] auto teleports_between(double from, double to) const -> bool;
+
+private:
+    zth::Vector<FlightWaypoint> _waypoints;
+};
@@ -0,0 +1,41 @@
+#include "frame_budget.hpp"
+
+auto CostModel::add(double size, std::chrono::microseconds cost) -> void
+{
+    auto cost_us = static_cast<double>(cost.count());
+
+    _weight = _weight * decay + 1.0;
+    _size = _size * decay + size;
+    _cost = _cost * decay + cost_us;
+    _size_squared = _size_squared * decay + size * size;
+    _size_times_cost = _size_times_cost * decay + size * cost_us;
+}
+
+auto CostModel::predict(double size) const -> std::chrono::microseconds
+{
+    if (_weight == 0.0)
+        return _initial_estimate;
+
+    auto mean_cost = _cost / _weight;
+    auto denominator = _weight * _size_squared - _size * _size;
+
+    // All the measurements had (almost) the same size, so the best we can do is the mean.
+    if (denominator <= std::numeric_limits<double>::epsilon() * _weight * _size_squared)
+        return std::chrono::microseconds{ static_cast<i64>(std::ceil(mean_cost)) };
+
+    auto slope = (_weight * _size_times_cost - _size * _cost) / denominator;
+    auto intercept = (_cost - slope * _size) / _weight;
+    auto prediction = std::max(intercept + slope * size, 0.0);
+
+    return std::chrono::microseconds{ static_cast<i64>(std::ceil(prediction)) };
+}
+
+auto FrameBudget::fits(std::chrono::microseconds predicted_cost) const -> bool
+{
+    return elapsed() + predicted_cost <= _budget;
+}
+
+auto FrameBudget::elapsed() const -> std::chrono::microseconds
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - _start);
+}
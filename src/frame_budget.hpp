@@ -0,0 +1,45 @@
+#pragma once
+
+// Predicts how long a piece of work takes from its size (e.g. the number of vertices of a mesh), as a linear function
+// fitted to the recent measurements with least squares. Older measurements are gradually forgotten, so the model
+// follows changes in the cost of the work.
+class CostModel
+{
+public:
+    // Weight which every measurement loses when a new one is added.
+    static constexpr double decay = 0.95;
+
+public:
+    // The initial estimate is used until there are any measurements.
+    explicit CostModel(std::chrono::microseconds initial_estimate) : _initial_estimate(initial_estimate) {}
+
+    auto add(double size, std::chrono::microseconds cost) -> void;
+    [[nodiscard]] auto predict(double size) const -> std::chrono::microseconds;
+
+private:
+    std::chrono::microseconds _initial_estimate;
+
+    // Weighted sums of the measurements.
+    double _weight = 0.0;
+    double _size = 0.0;
+    double _cost = 0.0;
+    double _size_squared = 0.0;
+    double _size_times_cost = 0.0;
+};
+
+// Time which the main thread can spend on some work during one frame.
+class FrameBudget
+{
+public:
+    explicit FrameBudget(std::chrono::microseconds budget) : _budget(budget), _start(Clock::now()) {}
+
+    // Returns true if there's enough time left for work which is predicted to take the given time.
+    [[nodiscard]] auto fits(std::chrono::microseconds predicted_cost) const -> bool;
+    [[nodiscard]] auto elapsed() const -> std::chrono::microseconds;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::chrono::microseconds _budget;
+    Clock::time_point _start;
+};
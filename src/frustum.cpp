@@ -0,0 +1,88 @@
+#include "frustum.hpp"
+
+auto bounds_of(std::span<const BlockVertex> vertices) -> Aabb
+{
+    if (vertices.empty())
+        return Aabb{};
+
+    Aabb result{ .min = vertices.front().position, .max = vertices.front().position };
+
+    for (const auto& vertex : vertices)
+    {
+        result.min = glm::min(result.min, vertex.position);
+        result.max = glm::max(result.max, vertex.position);
+    }
+
+    return result;
+}
+
+Frustum::Frustum(const glm::mat4& view_projection)
+{
+    // Gribb-Hartmann plane extraction. GLM matrices are column-major, so a row is made out of the i-th element of
+    // every column.
+    auto row = [&view_projection](glm::length_t i) {
+        return glm::vec4{ view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i] };
+    };
+
+    std::array planes = {
+        row(3) + row(0), // Left.
+        row(3) - row(0), // Right.
+        row(3) + row(1), // Bottom.
+        row(3) - row(1), // Top.
+        row(3) + row(2), // Near.
+        row(3) - row(2), // Far.
+    };
+
+    for (usize i = 0; i < plane_count; i++)
+    {
+        auto normal = glm::vec3{ planes[i] };
+        auto length = glm::length(normal);
+
+        _normals[i] = normal / length;
+        _abs_normals[i] = glm::abs(_normals[i]);
+        _distances[i] = planes[i].w / length;
+    }
+}
+
+auto Frustum::from_camera(const zth::CameraComponent& camera, glm::vec3 position, glm::vec3 forward) -> Frustum
+{
+    auto view = glm::lookAt(position, position + forward, zth::math::world_up);
+    auto projection = glm::perspective(camera.fov, camera.aspect_ratio, camera.near, camera.far);
+    return Frustum{ projection * view };
+}
+
+auto Frustum::intersects(const Aabb& box) const -> bool
+{
+    u8 visible = 0;
+    cull(std::span{ &box, 1 }, std::span{ &visible, 1 });
+    return visible;
+}
+
+auto Frustum::cull(std::span<const Aabb> boxes, std::span<u8> visible) const -> usize
+{
+    ZTH_ASSERT(boxes.size() == visible.size());
+
+    usize visible_count = 0;
+
+    // A box is outside of the frustum if it's entirely behind any of the planes. Written without branches so that the
+    // compiler can vectorize the loop over the boxes.
+    for (usize i = 0; i < boxes.size(); i++)
+    {
+        auto center = (boxes[i].min + boxes[i].max) * 0.5f;
+        auto extent = (boxes[i].max - boxes[i].min) * 0.5f;
+
+        auto inside = true;
+
+        for (usize plane = 0; plane < plane_count; plane++)
+        {
+            auto distance = glm::dot(_normals[plane], center) + _distances[plane];
+            auto radius = glm::dot(_abs_normals[plane], extent);
+            inside &= distance + radius >= 0.0f;
+        }
+
+        visible[i] = inside;
+        visible_count += inside;
+    }
+
+    return visible_count;
+}
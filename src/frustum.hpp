@@ -0,0 +1,37 @@
+#pragma once
+
+#include "world/block_vertex.hpp"
+
+struct Aabb
+{
+    glm::vec3 min{ 0.0f };
+    glm::vec3 max{ 0.0f };
+};
+
+// Bounding box of the vertices' positions.
+[[nodiscard]] auto bounds_of(std::span<const BlockVertex> vertices) -> Aabb;
+
+class Frustum
+{
+public:
+    // The frustum is extracted from the combined view-projection matrix, so it's in world space.
+    explicit Frustum(const glm::mat4& view_projection);
+
+    [[nodiscard]] static auto from_camera(const zth::CameraComponent& camera, glm::vec3 position, glm::vec3 forward)
+        -> Frustum;
+
+    [[nodiscard]] auto intersects(const Aabb& box) const -> bool;
+
+    // Tests every box against the frustum and writes the result into the corresponding element of visible. Returns the
+    // number of visible boxes.
+    auto cull(std::span<const Aabb> boxes, std::span<u8> visible) const -> usize;
+
+private:
+    static constexpr usize plane_count = 6;
+
+    // Planes are stored as a normal pointing into the frustum and a distance. The absolute values of the normals are
+    // precomputed for the box tests.
+    std::array<glm::vec3, plane_count> _normals;
+    std::array<glm::vec3, plane_count> _abs_normals;
+    std::array<float, plane_count> _distances;
+};
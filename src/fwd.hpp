@@ -1,3 +1,4 @@
 #pragma once
 
-class ChunkData;
\ No newline at end of file
+class ChunkData;
+class ChunkNeighborhood;
\ No newline at end of file
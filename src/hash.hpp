@@ -11,3 +11,14 @@ template<> struct std::hash<glm::ivec2>
         return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
     }
 };
+
+template<> struct std::hash<glm::ivec3>
+{
+    [[nodiscard]] auto operator()(const glm::ivec3& vec) const noexcept -> std::size_t
+    {
+        auto h1 = std::hash<glm::ivec2>{}(glm::ivec2{ vec.x, vec.y });
+        auto h2 = std::hash<i32>{}(vec.z);
+
+        return h1 ^ (h2 + 0x9e3779b9 + (h1 << 6) + (h1 >> 2));
+    }
+};
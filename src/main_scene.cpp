@@ -1,5 +1,6 @@
 #include "main_scene.hpp"
 
+#include "scripts/benchmark.hpp"
 #include "scripts/player.hpp"
 #include "scripts/world_manager.hpp"
 
@@ -14,11 +15,24 @@ auto MainScene::on_load() -> void
         .far = 1000.0f,
     });
 
-    _player.emplace_or_replace<zth::ScriptComponent>(zth::make_unique<scripts::Player>());
     _player.transform().set_translation(glm::vec3{ 0.0f, 120.0f, 0.0f }).set_direction(zth::math::world_backward);
 
     _directional_light.emplace_or_replace<zth::LightComponent>(zth::DirectionalLight{});
     _directional_light.transform().set_direction(glm::normalize(glm::vec3{ -0.35f, -1.0f, -0.35f }));
 
-    _world_manager.emplace_or_replace<zth::ScriptComponent>(zth::make_unique<scripts::WorldManager>(_player));
+    auto world_manager = zth::make_unique<scripts::WorldManager>(_player);
+    auto& world_manager_ref = *world_manager;
+
+    auto player = zth::make_unique<scripts::Player>(world_manager_ref.get_chunk_lookup());
+    auto& player_ref = *player;
+    _player.emplace_or_replace<zth::ScriptComponent>(std::move(player));
+
+    // Chunks pre-generated with craftmine_pregen --out world.
+    if (std::filesystem::is_directory("world"))
+        world_manager->chunk_store = std::make_shared<ChunkStore>("world");
+
+    _world_manager.emplace_or_replace<zth::ScriptComponent>(std::move(world_manager));
+
+    _benchmark.emplace_or_replace<zth::ScriptComponent>(
+        zth::make_unique<scripts::Benchmark>(_player, player_ref, world_manager_ref));
 }
@@ -14,6 +14,7 @@ private:
     zth::EntityHandle _player = create_entity("Player");
     zth::EntityHandle _directional_light = create_entity("Directional Light");
     zth::EntityHandle _world_manager = create_entity("World Manager");
+    zth::EntityHandle _benchmark = create_entity("Benchmark");
 
 private:
     auto on_load() -> void override;
@@ -0,0 +1,455 @@
+#include "profiling.hpp"
+
+#include <fstream>
+#include <mutex>
+
+namespace profiling {
+
+namespace {
+
+#if defined(CRAFTMINE_PROFILING)
+
+// Durations are bucketed by their power of two, with every power of two split into 4 sub-buckets, which bounds the
+// error of the percentiles to about 25%.
+constexpr usize sub_bucket_bits = 2;
+constexpr usize sub_bucket_count = 1 << sub_bucket_bits;
+constexpr usize bucket_count = (64 - sub_bucket_bits + 1) * sub_bucket_count;
+
+[[nodiscard]] auto bucket_of(u64 nanoseconds) -> usize
+{
+    if (nanoseconds < sub_bucket_count)
+        return nanoseconds;
+
+    auto msb = static_cast<usize>(std::bit_width(nanoseconds)) - 1;
+    auto sub_bucket = (nanoseconds >> (msb - sub_bucket_bits)) & (sub_bucket_count - 1);
+    return (msb - sub_bucket_bits + 1) * sub_bucket_count + sub_bucket;
+}
+
+// Returns the smallest duration which falls into the bucket.
+[[nodiscard]] auto bucket_lower_bound(usize bucket) -> u64
+{
+    if (bucket < sub_bucket_count)
+        return bucket;
+
+    auto msb = bucket / sub_bucket_count + sub_bucket_bits - 1;
+    auto sub_bucket = bucket % sub_bucket_count;
+    return (sub_bucket_count + sub_bucket) << (msb - sub_bucket_bits);
+}
+
+// Only ever written by the thread which owns it, so the counters are updated with plain relaxed loads and stores
+// instead of read-modify-write operations. Other threads only read them.
+struct StageCounters
+{
+    std::array<std::atomic<u64>, bucket_count> buckets{};
+    std::atomic<u64> count = 0;
+    std::atomic<u64> total = 0;
+    std::atomic<u64> bytes = 0;
+};
+
+struct TraceEvent
+{
+    Stage stage;
+    bool has_chunk;
+    glm::ivec3 chunk;
+    Timestamp begin;
+    Timestamp end;
+};
+
+// Ring buffer of the most recent trace events of one thread. The owning thread is the only writer; the mutex is only
+// ever contended while the trace is being exported or cleared.
+struct TraceBuffer
+{
+    static constexpr usize capacity = 1 << 15;
+
+    std::mutex mutex;
+    std::unique_ptr<TraceEvent[]> events; // Allocated when the thread records its first event.
+    usize next = 0;
+    usize size = 0;
+
+    auto push(const TraceEvent& event) -> void
+    {
+        std::scoped_lock lock{ mutex };
+
+        if (!events)
+            events = std::make_unique_for_overwrite<TraceEvent[]>(capacity);
+
+        events[next] = event;
+        next = (next + 1) % capacity;
+        size = std::min(size + 1, capacity);
+    }
+
+    auto clear() -> void
+    {
+        std::scoped_lock lock{ mutex };
+        next = 0;
+        size = 0;
+    }
+
+    // Calls func for every event, from the oldest to the newest.
+    template<typename Func> auto for_each(Func&& func) -> void
+    {
+        std::scoped_lock lock{ mutex };
+
+        for (usize i = 0; i < size; i++)
+            func(events[(next + capacity - size + i) % capacity]);
+    }
+};
+
+// Aligned to a cache line so that threads don't invalidate each other's counters.
+struct alignas(64) ThreadCounters
+{
+    u32 thread_id = 0;
+    std::array<StageCounters, stage_count> stages{};
+    TraceBuffer trace;
+};
+
+auto increment(std::atomic<u64>& counter, u64 value) -> void
+{
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+// Owns the counters of every thread. The counters of threads which exited are handed over to new threads, so that
+// short-lived threads (std::async might create a new one for every task) don't make the registry grow indefinitely.
+// A reused set of counters keeps its thread id, so in a trace every id stands for one worker slot rather than one OS
+// thread.
+class Registry
+{
+public:
+    [[nodiscard]] auto acquire() -> ThreadCounters*
+    {
+        std::scoped_lock lock{ _mutex };
+
+        if (!_free.empty())
+        {
+            auto counters = _free.back();
+            _free.pop_back();
+            return counters;
+        }
+
+        auto& counters = _all.emplace_back(std::make_unique<ThreadCounters>());
+        counters->thread_id = static_cast<u32>(_all.size());
+        return counters.get();
+    }
+
+    auto release(ThreadCounters* counters) -> void
+    {
+        std::scoped_lock lock{ _mutex };
+        _free.push_back(counters);
+    }
+
+    template<typename Func> auto for_each(Func&& func) -> void
+    {
+        std::scoped_lock lock{ _mutex };
+
+        for (auto& counters : _all)
+            func(*counters);
+    }
+
+private:
+    std::mutex _mutex;
+    zth::Vector<std::unique_ptr<ThreadCounters>> _all;
+    zth::Vector<ThreadCounters*> _free;
+};
+
+Registry registry;
+
+struct ThreadSlot
+{
+    ThreadCounters* counters = registry.acquire();
+
+    ThreadSlot() = default;
+    ZTH_NO_COPY(ThreadSlot)
+    ~ThreadSlot() { registry.release(counters); }
+};
+
+[[nodiscard]] auto thread_counters() -> ThreadCounters&
+{
+    thread_local ThreadSlot slot;
+    return *slot.counters;
+}
+
+[[nodiscard]] auto thread_counters(Stage stage) -> StageCounters&
+{
+    return thread_counters().stages[std::to_underlying(stage)];
+}
+
+std::atomic<bool> tracing_active = false;
+
+// Trace timestamps are relative to the start of the program.
+const Timestamp trace_epoch = now();
+
+struct Totals
+{
+    std::array<std::array<u64, bucket_count>, stage_count> buckets{};
+    std::array<u64, stage_count> count{};
+    std::array<u64, stage_count> total{};
+    std::array<u64, stage_count> bytes{};
+};
+
+[[nodiscard]] auto totals() -> Totals
+{
+    Totals result;
+
+    registry.for_each([&result](const ThreadCounters& counters) {
+        for (usize stage = 0; stage < stage_count; stage++)
+        {
+            const auto& stage_counters = counters.stages[stage];
+
+            for (usize bucket = 0; bucket < bucket_count; bucket++)
+                result.buckets[stage][bucket] += stage_counters.buckets[bucket].load(std::memory_order_relaxed);
+
+            result.count[stage] += stage_counters.count.load(std::memory_order_relaxed);
+            result.total[stage] += stage_counters.total.load(std::memory_order_relaxed);
+            result.bytes[stage] += stage_counters.bytes.load(std::memory_order_relaxed);
+        }
+    });
+
+    return result;
+}
+
+// Totals at the time of the last reset, which are subtracted from the current ones.
+std::mutex baseline_mutex;
+Totals baseline;
+
+#endif
+
+} // namespace
+
+auto stage_name(Stage stage) -> std::string_view
+{
+    switch (stage)
+    {
+        using enum Stage;
+    case Frame:
+        return "Frame";
+    case Load:
+        return "Load";
+    case Generate:
+        return "Generate";
+    case Mesh:
+        return "Mesh";
+    case Upload:
+        return "Upload";
+    case Unload:
+        return "Unload";
+    case LoadQueueWait:
+        return "Load queue wait";
+    case UpdateQueueWait:
+        return "Update queue wait";
+    case FarTerrain:
+        return "Far terrain";
+    case PopIn:
+        return "Pop-in";
+    case Tick:
+        return "Tick";
+    case Count:
+        break;
+    }
+
+    ZTH_ASSERT(false);
+    std::unreachable();
+}
+
+#if defined(CRAFTMINE_PROFILING)
+
+auto record(Stage stage, std::chrono::nanoseconds duration) -> void
+{
+    auto nanoseconds = static_cast<u64>(std::max(duration.count(), std::chrono::nanoseconds::rep{ 0 }));
+    auto& counters = thread_counters(stage);
+
+    increment(counters.buckets[bucket_of(nanoseconds)], 1);
+    increment(counters.count, 1);
+    increment(counters.total, nanoseconds);
+}
+
+auto record_bytes(Stage stage, usize bytes) -> void
+{
+    increment(thread_counters(stage).bytes, bytes);
+}
+
+auto stats() -> Stats
+{
+    auto current = totals();
+
+    std::scoped_lock lock{ baseline_mutex };
+
+    Stats result;
+
+    for (usize stage = 0; stage < stage_count; stage++)
+    {
+        auto& stage_stats = result[stage];
+
+        stage_stats.count = current.count[stage] - baseline.count[stage];
+        stage_stats.bytes = current.bytes[stage] - baseline.bytes[stage];
+        stage_stats.total = std::chrono::nanoseconds{ current.total[stage] - baseline.total[stage] };
+
+        auto percentile = [&](u64 percent) {
+            // Rank of the sample we're looking for, rounded up.
+            auto rank = (stage_stats.count * percent + 99) / 100;
+            u64 seen = 0;
+
+            for (usize bucket = 0; bucket < bucket_count; bucket++)
+            {
+                seen += current.buckets[stage][bucket] - baseline.buckets[stage][bucket];
+
+                if (seen >= rank && seen > 0)
+                    return std::chrono::nanoseconds{ bucket_lower_bound(bucket) };
+            }
+
+            return std::chrono::nanoseconds{ 0 };
+        };
+
+        stage_stats.p50 = percentile(50);
+        stage_stats.p95 = percentile(95);
+        stage_stats.p99 = percentile(99);
+    }
+
+    return result;
+}
+
+auto reset() -> void
+{
+    auto current = totals();
+    std::scoped_lock lock{ baseline_mutex };
+    baseline = current;
+}
+
+auto trace(Stage stage, Timestamp begin, Timestamp end, Optional<glm::ivec3> chunk_position) -> void
+{
+    if (!tracing_active.load(std::memory_order_relaxed))
+        return;
+
+    thread_counters().trace.push(TraceEvent{
+        .stage = stage,
+        .has_chunk = chunk_position.has_value(),
+        .chunk = chunk_position.value_or(glm::ivec3{ 0 }),
+        .begin = begin,
+        .end = end,
+    });
+}
+
+auto start_tracing() -> void
+{
+    registry.for_each([](ThreadCounters& counters) { counters.trace.clear(); });
+    tracing_active.store(true, std::memory_order_relaxed);
+}
+
+auto stop_tracing() -> void
+{
+    tracing_active.store(false, std::memory_order_relaxed);
+}
+
+auto tracing() -> bool
+{
+    return tracing_active.load(std::memory_order_relaxed);
+}
+
+auto export_trace(const std::filesystem::path& path) -> bool
+{
+    std::ofstream file{ path };
+
+    if (!file)
+        return false;
+
+    auto to_us = [](Timestamp timestamp) {
+        return std::chrono::duration<double, std::micro>{ timestamp - trace_epoch }.count();
+    };
+
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    auto first = true;
+    auto separator = [&first] {
+        auto result = first ? "\n" : ",\n";
+        first = false;
+        return result;
+    };
+
+    registry.for_each([&](ThreadCounters& counters) {
+        auto tid = counters.thread_id;
+
+        file << separator()
+             << std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":"Thread {}"}}}})", tid,
+                            tid);
+
+        counters.trace.for_each([&](const TraceEvent& event) {
+            file << separator()
+                 << std::format(R"({{"name":"{}","cat":"chunk","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f})",
+                                stage_name(event.stage), tid, to_us(event.begin),
+                                to_us(event.end) - to_us(event.begin));
+
+            if (event.has_chunk)
+            {
+                file << std::format(R"(,"args":{{"x":{},"y":{},"z":{}}})", event.chunk.x, event.chunk.y,
+                                    event.chunk.z);
+            }
+
+            file << '}';
+        });
+    });
+
+    file << "\n]}\n";
+
+    return static_cast<bool>(file);
+}
+
+#else
+
+auto stats() -> Stats
+{
+    return Stats{};
+}
+
+auto reset() -> void {}
+
+auto start_tracing() -> void {}
+auto stop_tracing() -> void {}
+
+auto tracing() -> bool
+{
+    return false;
+}
+
+auto export_trace([[maybe_unused]] const std::filesystem::path& path) -> bool
+{
+    return false;
+}
+
+#endif
+
+auto dump(const std::filesystem::path& path) -> bool
+{
+    std::ofstream file{ path };
+
+    if (!file)
+        return false;
+
+    dump(file);
+
+    return static_cast<bool>(file);
+}
+
+auto dump(std::ostream& stream) -> void
+{
+    auto to_us = [](std::chrono::nanoseconds duration) {
+        return std::chrono::duration<double, std::micro>{ duration }.count();
+    };
+
+    stream << std::format("{:<20}{:>12}{:>14}{:>12}{:>12}{:>12}{:>12}{:>16}\n", "stage", "count", "total_ms",
+                          "mean_us", "p50_us", "p95_us", "p99_us", "bytes");
+
+    auto all_stats = stats();
+
+    for (usize i = 0; i < stage_count; i++)
+    {
+        const auto& stage_stats = all_stats[i];
+        auto total_ms = std::chrono::duration<double, std::milli>{ stage_stats.total }.count();
+        auto mean_us = stage_stats.count ? to_us(stage_stats.total) / static_cast<double>(stage_stats.count) : 0.0;
+
+        stream << std::format("{:<20}{:>12}{:>14.3f}{:>12.2f}{:>12.2f}{:>12.2f}{:>12.2f}{:>16}\n",
+                              stage_name(static_cast<Stage>(i)), stage_stats.count, total_ms, mean_us,
+                              to_us(stage_stats.p50), to_us(stage_stats.p95), to_us(stage_stats.p99),
+                              stage_stats.bytes);
+    }
+}
+
+} // namespace profiling
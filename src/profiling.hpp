@@ -0,0 +1,136 @@
+#pragma once
+
+#include <iosfwd>
+
+// Lightweight instrumentation of the chunk pipeline. Every thread records into its own set of histograms, which only
+// that thread ever writes to, so recording doesn't need any locking. The histograms are aggregated only when someone
+// asks for the statistics. While tracing is active, every timed scope is additionally recorded as an event into
+// a per-thread ring buffer, and the events can be exported as a Chrome trace (viewable in Perfetto or
+// chrome://tracing). When CRAFTMINE_PROFILING isn't defined, all of the recording functions are empty and compile out
+// to nothing.
+
+namespace profiling {
+
+enum class Stage : u8
+{
+    Frame = 0,
+    Load,
+    Generate,
+    Mesh,
+    Upload,
+    Unload,
+    LoadQueueWait,
+    UpdateQueueWait,
+    FarTerrain,
+    PopIn, // From the creation of a chunk's entity until its first mesh is uploaded.
+    Tick,
+    Count,
+};
+
+constexpr inline usize stage_count = std::to_underlying(Stage::Count);
+
+[[nodiscard]] auto stage_name(Stage stage) -> std::string_view;
+
+struct StageStats
+{
+    u64 count = 0;
+    u64 bytes = 0;
+    std::chrono::nanoseconds total{ 0 };
+    std::chrono::nanoseconds p50{ 0 };
+    std::chrono::nanoseconds p95{ 0 };
+    std::chrono::nanoseconds p99{ 0 };
+};
+
+using Stats = std::array<StageStats, stage_count>;
+
+#if defined(CRAFTMINE_PROFILING)
+
+constexpr inline bool enabled = true;
+
+using Timestamp = std::chrono::steady_clock::time_point;
+
+[[nodiscard]] inline auto now() -> Timestamp
+{
+    return std::chrono::steady_clock::now();
+}
+
+auto record(Stage stage, std::chrono::nanoseconds duration) -> void;
+auto record_bytes(Stage stage, usize bytes) -> void;
+
+// Adds an event to the calling thread's trace buffer if tracing is active.
+auto trace(Stage stage, Timestamp begin, Timestamp end, Optional<glm::ivec3> chunk_position = nil) -> void;
+
+inline auto record_since(Stage stage, Timestamp start, Optional<glm::ivec3> chunk_position = nil) -> void
+{
+    auto end = now();
+    record(stage, end - start);
+    trace(stage, start, end, chunk_position);
+}
+
+class ScopedTimer
+{
+public:
+    explicit ScopedTimer(Stage stage, Optional<glm::ivec3> chunk_position = nil)
+        : _stage(stage), _chunk_position(chunk_position), _start(now())
+    {}
+    ZTH_NO_COPY(ScopedTimer)
+    ~ScopedTimer() { record_since(_stage, _start, _chunk_position); }
+
+private:
+    Stage _stage;
+    Optional<glm::ivec3> _chunk_position;
+    Timestamp _start;
+};
+
+#else
+
+constexpr inline bool enabled = false;
+
+struct Timestamp
+{};
+
+[[nodiscard]] inline auto now() -> Timestamp
+{
+    return Timestamp{};
+}
+
+inline auto record([[maybe_unused]] Stage stage, [[maybe_unused]] std::chrono::nanoseconds duration) -> void {}
+inline auto record_bytes([[maybe_unused]] Stage stage, [[maybe_unused]] usize bytes) -> void {}
+inline auto trace([[maybe_unused]] Stage stage, [[maybe_unused]] Timestamp begin, [[maybe_unused]] Timestamp end,
+                  [[maybe_unused]] Optional<glm::ivec3> chunk_position = nil) -> void
+{}
+inline auto record_since([[maybe_unused]] Stage stage, [[maybe_unused]] Timestamp start,
+                         [[maybe_unused]] Optional<glm::ivec3> chunk_position = nil) -> void
+{}
+
+#endif
+
+// Aggregates the histograms of all threads. Only counts what was recorded since the last reset.
+[[nodiscard]] auto stats() -> Stats;
+auto reset() -> void;
+
+// Writes the statistics of every stage as a table. Returns false if the file couldn't be written.
+[[nodiscard]] auto dump(const std::filesystem::path& path) -> bool;
+auto dump(std::ostream& stream) -> void;
+
+// Starting a trace discards the events of the previous one.
+auto start_tracing() -> void;
+auto stop_tracing() -> void;
+[[nodiscard]] auto tracing() -> bool;
+
+// Writes the recorded events in the Chrome Trace Event format. Returns false if the file couldn't be written.
+[[nodiscard]] auto export_trace(const std::filesystem::path& path) -> bool;
+
+} // namespace profiling
+
+#if defined(CRAFTMINE_PROFILING)
+#define CRAFTMINE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define CRAFTMINE_PROFILE_CONCAT(a, b) CRAFTMINE_PROFILE_CONCAT_IMPL(a, b)
+#define CRAFTMINE_PROFILE_SCOPE(stage)                                                                                 \
+    const ::profiling::ScopedTimer CRAFTMINE_PROFILE_CONCAT(profile_scope_, __LINE__) { stage }
+#define CRAFTMINE_PROFILE_CHUNK_SCOPE(stage, chunk_position)                                                           \
+    const ::profiling::ScopedTimer CRAFTMINE_PROFILE_CONCAT(profile_scope_, __LINE__) { stage, chunk_position }
+#else
+#define CRAFTMINE_PROFILE_SCOPE(stage) static_cast<void>(0)
+#define CRAFTMINE_PROFILE_CHUNK_SCOPE(stage, chunk_position) static_cast<void>(0)
+#endif
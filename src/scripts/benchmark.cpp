@@ -0,0 +1,262 @@
+#include "benchmark.hpp"
+
+#include <fstream>
+
+#include "profiling.hpp"
+
+namespace scripts {
+
+namespace {
+
+[[nodiscard]] auto to_seconds(std::chrono::steady_clock::duration duration) -> double
+{
+    return std::chrono::duration<double>{ duration }.count();
+}
+
+[[nodiscard]] auto to_mib(usize bytes) -> double
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+Benchmark::Benchmark(zth::EntityHandle player, Player& player_controller, WorldManager& world_manager)
+    : _player{ player }, _player_controller{ player_controller }, _world_manager{ world_manager }
+{}
+
+auto Benchmark::display_label() const -> const char*
+{
+    return "Benchmark";
+}
+
+auto Benchmark::debug_edit() -> void
+{
+    if (_run)
+    {
+        zth::debug::text("Running {}: {:.1f}s / {:.1f}s", _run->name, static_cast<double>(_run->frame) * timestep,
+                         _run->path.duration());
+
+        if (zth::debug::button("Stop benchmark"))
+            finish(*_run, true);
+
+        return;
+    }
+
+    zth::debug::drag_float("Settle Timeout", settle_timeout);
+
+    zth::debug::drag_float("Sprint Speed", sprint_speed);
+    zth::debug::drag_float("Sprint Duration", sprint_duration);
+
+    if (zth::debug::button("Run sprint benchmark"))
+    {
+        start("Sprint", FlightPath::sprint(start_position, zth::math::world_forward, sprint_speed,
+                                           static_cast<double>(sprint_duration)));
+    }
+
+    zth::debug::drag_float("Circle Radius", circle_radius);
+    zth::debug::drag_float("Circle Speed", circle_speed);
+    zth::debug::drag_float("Circle Duration", circle_duration);
+
+    if (zth::debug::button("Run circle benchmark"))
+    {
+        start("Circle", FlightPath::circle(start_position, circle_radius, circle_speed,
+                                           static_cast<double>(circle_duration)));
+    }
+
+    zth::debug::input_int("Teleport Count", teleport_count);
+    zth::debug::drag_float("Teleport Distance", teleport_distance);
+    zth::debug::drag_float("Teleport Hold Time", teleport_hold_time);
+
+    if (zth::debug::button("Run teleport benchmark"))
+    {
+        start("Teleports", FlightPath::teleports(start_position, zth::math::world_forward * teleport_distance,
+                                                 teleport_count, static_cast<double>(teleport_hold_time)));
+    }
+
+    if (!_recording)
+    {
+        if (zth::debug::button("Record flight"))
+        {
+            _recorded_path.clear();
+            _recording = true;
+        }
+    }
+    else if (zth::debug::button("Stop recording"))
+    {
+        _recording = false;
+
+        if (!_recorded_path.save(recorded_path_file))
+            ZTH_ERROR("Failed to save the recorded flight.");
+    }
+
+    if (zth::debug::button("Replay recorded flight"))
+    {
+        if (auto path = FlightPath::load(recorded_path_file))
+            start("Recorded", std::move(*path));
+        else
+            ZTH_ERROR("Failed to load the recorded flight.");
+    }
+}
+
+auto Benchmark::start(std::string_view name, FlightPath&& path) -> void
+{
+    _recording = false;
+
+    // Every run starts with an empty world, so that the runs don't depend on what was loaded before.
+    _world_manager.clear_world();
+    profiling::reset();
+
+    // The player's input and physics would fight the flight path.
+    _player_controller.controls_enabled = false;
+
+    _run = Run{
+        .name = std::string{ name },
+        .path = std::move(path),
+        .started_at = Clock::now(),
+    };
+}
+
+auto Benchmark::on_update([[maybe_unused]] zth::EntityHandle actor) -> void
+{
+    if (_recording)
+    {
+        const auto& transform = _player.transform();
+
+        _recorded_path.add({
+            .time = _recorded_path.empty() ? 0.0 : _recorded_path.duration() + timestep,
+            .position = transform.translation(),
+            .direction = transform.forward(),
+        });
+    }
+
+    if (_run)
+        step(*_run);
+}
+
+auto Benchmark::step(Run& run) -> void
+{
+    auto now = Clock::now();
+    auto time = static_cast<double>(run.frame) * timestep;
+    auto pose = run.path.sample(time);
+
+    _player.transform().set_translation(pose.position).set_direction(pose.direction);
+
+    if (run.frame == 0 || run.path.teleports_between(time - timestep, time))
+    {
+        run.fill_started_at = now;
+        run.fill_started_frame = run.frame;
+    }
+
+    if (!run.path_ended_at && time >= run.path.duration())
+    {
+        run.path_ended_at = now;
+
+        if (!run.fill_started_at)
+        {
+            run.fill_started_at = now;
+            run.fill_started_frame = run.frame;
+        }
+    }
+
+    auto memory_usage = _world_manager.memory_usage();
+
+    if (memory_usage.total() > run.peak_memory)
+    {
+        run.peak_memory = memory_usage.total();
+        run.peak_memory_usage = memory_usage;
+    }
+
+    // The world manager only sees the new position of the player on the next frame at the latest.
+    if (run.fill_started_at && run.frame > run.fill_started_frame && _world_manager.idle())
+    {
+        run.fill_times.push_back(to_seconds(now - *run.fill_started_at));
+        run.fill_started_at = nil;
+    }
+
+    run.frame++;
+
+    if (!run.path_ended_at)
+        return;
+
+    if (!run.fill_started_at)
+        finish(run, false);
+    else if (to_seconds(now - *run.path_ended_at) > static_cast<double>(settle_timeout))
+        finish(run, true);
+}
+
+auto Benchmark::finish(const Run& run, bool timed_out) -> void
+{
+    if (write_report(run, timed_out))
+        ZTH_INFO("Benchmark {} finished. The report was written to {}.", run.name, report_file.string());
+    else
+        ZTH_ERROR("Failed to write the benchmark report.");
+
+    _player_controller.controls_enabled = true;
+    _run = nil;
+}
+
+auto Benchmark::write_report(const Run& run, bool timed_out) const -> bool
+{
+    std::ofstream file{ report_file };
+
+    if (!file)
+        return false;
+
+    auto wall_time = to_seconds(Clock::now() - run.started_at);
+
+    file << std::format("benchmark: {}\n", run.name);
+    file << std::format("frames: {} ({:.2f}s simulated, {:.2f}s wall)\n", run.frame,
+                        static_cast<double>(run.frame) * timestep, wall_time);
+    file << std::format("distance: {}, vertical distance: {}, surface distance: {}\n", _world_manager.distance,
+                        _world_manager.vertical_distance, _world_manager.surface_distance);
+
+    if (timed_out)
+        file << "the world manager didn't finish its work before the run ended\n";
+
+    file << "\ntime to full view (s):";
+
+    for (auto fill_time : run.fill_times)
+        file << std::format(" {:.3f}", fill_time);
+
+    if (!run.fill_times.empty())
+    {
+        auto [min, max] = std::ranges::minmax(run.fill_times);
+        auto sum = std::ranges::fold_left(run.fill_times, 0.0, std::plus{});
+        auto mean = sum / static_cast<double>(run.fill_times.size());
+        file << std::format("\n  min {:.3f}, mean {:.3f}, max {:.3f}", min, mean, max);
+    }
+
+    const auto& peak = run.peak_memory_usage;
+
+    file << std::format("\n\npeak memory: {:.2f} MiB (chunk data {:.2f} MiB, chunk meshes {:.2f} MiB, far terrain "
+                        "meshes {:.2f} MiB, caches {:.2f} MiB)\n",
+                        to_mib(peak.total()), to_mib(peak.chunk_data), to_mib(peak.chunk_meshes),
+                        to_mib(peak.far_terrain_meshes), to_mib(peak.caches));
+
+    if constexpr (profiling::enabled)
+    {
+        auto stats = profiling::stats();
+        auto stage = [&stats](profiling::Stage s) -> const profiling::StageStats& {
+            return stats[std::to_underlying(s)];
+        };
+        auto to_ms = [](std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::milli>{ duration }.count();
+        };
+
+        const auto& pop_in = stage(profiling::Stage::PopIn);
+        file << std::format("chunk pop-in latency (ms): p50 {:.2f}, p95 {:.2f}, p99 {:.2f} over {} chunks\n",
+                            to_ms(pop_in.p50), to_ms(pop_in.p95), to_ms(pop_in.p99), pop_in.count);
+
+        auto busy_time = stage(profiling::Stage::Generate).total + stage(profiling::Stage::Mesh).total
+                         + stage(profiling::Stage::FarTerrain).total;
+        auto available_time = wall_time * static_cast<double>(std::max(std::thread::hardware_concurrency(), 1u));
+        file << std::format("worker utilization: {:.1f}%\n\n",
+                            100.0 * std::chrono::duration<double>{ busy_time }.count() / available_time);
+
+        profiling::dump(file);
+    }
+
+    return static_cast<bool>(file);
+}
+
+} // namespace scripts
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "flight_path.hpp"
+#include "scripts/player.hpp"
+#include "scripts/world_manager.hpp"
+
+namespace scripts {
+
+// Streaming benchmark. Takes over the player's transform and flies it along a flight path, advancing the path by
+// a fixed timestep every frame regardless of how long the frame actually took, so every run visits the same positions
+// in the same frames. Meanwhile, it measures:
+//
+// - Time to full view: how long it takes for the world manager to run out of work after the start of the run, after
+//   every teleport and after the end of the path.
+// - Chunk pop-in latency: how long it takes from the creation of a chunk until its first mesh is uploaded.
+// - Peak memory used by chunk data and meshes.
+// - Worker utilization: the time spent generating and meshing relative to the time the hardware threads had available.
+//
+// The report is written to a file once the world manager has no work left after the end of the path. Latency and
+// utilization come from the profiling module, so they are only measured when CRAFTMINE_PROFILING is enabled.
+class Benchmark : public zth::Script
+{
+public:
+    static constexpr double timestep = 1.0 / 60.0;
+
+    // If the world manager is still busy this long (in seconds) after the end of the path, the run ends anyway.
+    float settle_timeout = 60.0f;
+
+    // Every built-in path starts here.
+    glm::vec3 start_position{ 0.0f, 120.0f, 0.0f };
+
+    // Durations are in seconds.
+    float sprint_speed = 30.0f;
+    float sprint_duration = 30.0f;
+    float circle_radius = 128.0f;
+    float circle_speed = 30.0f;
+    float circle_duration = 30.0f;
+    usize teleport_count = 5;
+    float teleport_distance = 512.0f;
+    float teleport_hold_time = 5.0f;
+
+    std::filesystem::path recorded_path_file = "craftmine_flight.txt";
+    std::filesystem::path report_file = "craftmine_benchmark.txt";
+
+public:
+    explicit Benchmark(zth::EntityHandle player, Player& player_controller, WorldManager& world_manager);
+    ZTH_NO_COPY_NO_MOVE(Benchmark)
+    ~Benchmark() override = default;
+
+    [[nodiscard]] auto display_label() const -> const char* override;
+    auto debug_edit() -> void override;
+
+    auto start(std::string_view name, FlightPath&& path) -> void;
+    [[nodiscard]] auto running() const -> bool { return _run.has_value(); }
+
+private:
+    zth::EntityHandle _player;
+    Player& _player_controller;
+    WorldManager& _world_manager;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Run
+    {
+        std::string name;
+        FlightPath path;
+
+        usize frame = 0;
+        Clock::time_point started_at;
+
+        // Set while we're waiting for the world manager to run out of work.
+        Optional<Clock::time_point> fill_started_at = nil;
+        usize fill_started_frame = 0;
+        zth::Vector<double> fill_times; // In seconds.
+        Optional<Clock::time_point> path_ended_at = nil;
+
+        usize peak_memory = 0;
+        WorldManager::MemoryUsage peak_memory_usage;
+    };
+
+    Optional<Run> _run = nil;
+
+    // Recording samples the player's transform once every timestep.
+    bool _recording = false;
+    FlightPath _recorded_path;
+
+private:
+    auto on_update(zth::EntityHandle actor) -> void override;
+
+    auto step(Run& run) -> void;
+    // Writes the report and ends the run.
+    auto finish(const Run& run, bool timed_out) -> void;
+    [[nodiscard]] auto write_report(const Run& run, bool timed_out) const -> bool;
+};
+
+} // namespace scripts
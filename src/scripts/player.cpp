@@ -2,6 +2,8 @@
 
 namespace scripts {
 
+Player::Player(ChunkLookup world) : _world(std::move(world)) {}
+
 auto Player::display_label() const -> const char*
 {
     return "Player";
@@ -24,6 +26,18 @@ auto Player::debug_edit() -> void
         zth::debug::select_key("Sprint Key", sprint_key);
         zth::debug::drag_float("Sprinting Speed Multiplier", sprinting_speed_multiplier);
     }
+
+    zth::debug::checkbox("Flying", flying);
+    zth::debug::select_key("Toggle Flying Key", toggle_flying_key);
+
+    if (!flying)
+    {
+        zth::debug::select_key("Jump Key", jump_key);
+        zth::debug::drag_float("Gravity", gravity);
+        zth::debug::drag_float("Jump Speed", jump_speed);
+        zth::debug::drag_float("Max Fall Speed", max_fall_speed);
+        zth::debug::text("Grounded: {}", _grounded);
+    }
 }
 
 void Player::on_event(zth::EntityHandle actor, const zth::Event& event)
@@ -42,35 +56,39 @@ void Player::on_event(zth::EntityHandle actor, const zth::Event& event)
 
 auto Player::on_update(zth::EntityHandle actor) -> void
 {
+    if (!controls_enabled)
+    {
+        _vertical_velocity = 0.0f;
+        return;
+    }
+
     auto& transform = actor.transform();
 
     {
         // Move around.
 
-        auto speed = movement_speed * zth::Time::delta_time<float>();
+        auto toggle_flying_key_pressed = zth::Input::is_key_pressed(toggle_flying_key);
 
-        if (sprinting_enabled)
+        if (toggle_flying_key_pressed && !_toggle_flying_key_was_pressed)
         {
-            if (zth::Input::is_key_pressed(sprint_key))
-                speed *= sprinting_speed_multiplier;
+            flying = !flying;
+            _vertical_velocity = 0.0f;
         }
 
-        auto forward = transform.forward() * speed;
-        auto backward = -forward;
-        auto right = transform.right() * speed;
-        auto left = -right;
+        _toggle_flying_key_was_pressed = toggle_flying_key_pressed;
 
-        if (zth::Input::is_key_pressed(move_forward_key))
-            transform.translate(forward);
+        auto speed = movement_speed;
 
-        if (zth::Input::is_key_pressed(move_backward_key))
-            transform.translate(backward);
-
-        if (zth::Input::is_key_pressed(move_right_key))
-            transform.translate(right);
+        if (sprinting_enabled)
+        {
+            if (zth::Input::is_key_pressed(sprint_key))
+                speed *= sprinting_speed_multiplier;
+        }
 
-        if (zth::Input::is_key_pressed(move_left_key))
-            transform.translate(left);
+        if (flying || !_world)
+            fly(actor, speed);
+        else
+            walk(actor, speed);
     }
 
     if (!zth::Window::cursor_enabled())
@@ -91,4 +109,77 @@ auto Player::on_update(zth::EntityHandle actor) -> void
     }
 }
 
+auto Player::fly(zth::EntityHandle actor, float speed) const -> void
+{
+    auto& transform = actor.transform();
+    auto distance = speed * zth::Time::delta_time<float>();
+
+    auto forward = transform.forward() * distance;
+    auto backward = -forward;
+    auto right = transform.right() * distance;
+    auto left = -right;
+
+    if (zth::Input::is_key_pressed(move_forward_key))
+        transform.translate(forward);
+
+    if (zth::Input::is_key_pressed(move_backward_key))
+        transform.translate(backward);
+
+    if (zth::Input::is_key_pressed(move_right_key))
+        transform.translate(right);
+
+    if (zth::Input::is_key_pressed(move_left_key))
+        transform.translate(left);
+}
+
+auto Player::walk(zth::EntityHandle actor, float speed) -> void
+{
+    auto& transform = actor.transform();
+    auto delta_time = zth::Time::delta_time<float>();
+
+    // Walking only moves the player horizontally, no matter where the player looks.
+    auto forward = transform.forward();
+    forward.y = 0.0f;
+    forward = glm::length(forward) > 0.0f ? glm::normalize(forward) : glm::vec3{ 0.0f };
+    auto right = transform.right();
+    right.y = 0.0f;
+    right = glm::length(right) > 0.0f ? glm::normalize(right) : glm::vec3{ 0.0f };
+
+    glm::vec3 direction{ 0.0f };
+
+    if (zth::Input::is_key_pressed(move_forward_key))
+        direction += forward;
+
+    if (zth::Input::is_key_pressed(move_backward_key))
+        direction -= forward;
+
+    if (zth::Input::is_key_pressed(move_right_key))
+        direction += right;
+
+    if (zth::Input::is_key_pressed(move_left_key))
+        direction -= right;
+
+    if (glm::length(direction) > 0.0f)
+        direction = glm::normalize(direction);
+
+    if (_grounded && zth::Input::is_key_pressed(jump_key))
+        _vertical_velocity = jump_speed;
+
+    _vertical_velocity = std::max(_vertical_velocity - gravity * delta_time, -max_fall_speed);
+
+    auto position = transform.translation();
+    auto displacement = direction * speed * delta_time;
+    displacement.y = _vertical_velocity * delta_time;
+
+    auto result = move_box(_world, Aabb{ .min = position + collision_box.min, .max = position + collision_box.max },
+                           displacement);
+
+    transform.translate(result.displacement);
+    _grounded = result.grounded;
+
+    // Landing on the ground or hitting the head on a ceiling stops the vertical movement.
+    if (result.collided.y)
+        _vertical_velocity = 0.0f;
+}
+
 } // namespace scripts
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "world/collision.hpp"
+
 namespace scripts {
 
 class Player : public zth::Script
@@ -20,17 +22,44 @@ public:
     zth::Key sprint_key = zth::Key::LeftShift;
     float sprinting_speed_multiplier = 3.0f;
 
+    // While flying, the player moves freely through everything. While walking, the player collides with the terrain,
+    // falls and can jump.
+    bool flying = true;
+    zth::Key toggle_flying_key = zth::Key::F;
+    zth::Key jump_key = zth::Key::Space;
+    float gravity = 28.0f;        // In blocks per second squared.
+    float jump_speed = 9.0f;      // In blocks per second.
+    float max_fall_speed = 60.0f; // In blocks per second.
+
+    // While disabled, the player neither reacts to the input nor falls, so that something else (like the benchmark)
+    // can drive its transform.
+    bool controls_enabled = true;
+
+    // Collision box of the player relative to the camera.
+    static constexpr Aabb collision_box{ .min = { -0.3f, -1.62f, -0.3f }, .max = { 0.3f, 0.18f, 0.3f } };
+
 public:
     Player() = default;
+    // The player can only walk if it can look up the chunks of the world.
+    explicit Player(ChunkLookup world);
     ZTH_DEFAULT_COPY_DEFAULT_MOVE(Player)
     ~Player() override = default;
 
     [[nodiscard]] auto display_label() const -> const char* override;
     auto debug_edit() -> void override;
 
+private:
+    ChunkLookup _world;
+    float _vertical_velocity = 0.0f;
+    bool _grounded = false;
+    bool _toggle_flying_key_was_pressed = false;
+
 private:
     auto on_event(zth::EntityHandle actor, const zth::Event& event) -> void override;
     auto on_update(zth::EntityHandle actor) -> void override;
+
+    auto fly(zth::EntityHandle actor, float speed) const -> void;
+    auto walk(zth::EntityHandle actor, float speed) -> void;
 };
 
 } // namespace scripts
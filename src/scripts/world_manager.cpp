@@ -1,6 +1,7 @@
 #include "scripts/world_manager.hpp"
 
 #include "assets.hpp"
+#include "profiling.hpp"
 #include "world/generator.hpp"
 
 namespace scripts {
@@ -13,16 +14,178 @@ WorldManager::WorldManager(zth::ConstEntityHandle player) : player{ player } {}
 auto WorldManager::debug_edit() -> void
 {
     zth::debug::slide_int("Distance", distance, 0, 100);
+    zth::debug::slide_int("Vertical distance", vertical_distance, 0, 100);
+    zth::debug::slide_int("Surface distance", surface_distance, 0, 100);
 
     zth::debug::input_int("Max load chunk tasks", max_load_chunk_tasks);
+    zth::debug::slide_int("Load region size", load_region_size, 1, 16);
+    zth::debug::input_int("Max chunks per load task", max_chunks_per_load_task);
     zth::debug::input_int("Max update chunk tasks", max_update_chunk_tasks);
 
-    zth::debug::input_int("Max chunks loaded each frame", max_chunks_loaded_each_frame);
-    zth::debug::input_int("Max chunks updated each frame", max_chunks_updated_each_frame);
+    zth::debug::slide_int("Integration budget (us)", integration_budget_us, 0, 16000);
+    zth::debug::text("Predicted load cost: {}us", _load_cost.predict(1.0).count());
+    zth::debug::text("Predicted upload cost (1000 vertices): {}us", _upload_cost.predict(1000.0).count());
+
+    zth::debug::input_int("Max pooled chunk entities", max_pooled_chunk_entities);
+    zth::debug::text("Chunk entities: {} in use, {} pooled", _chunk_map.size(), _chunk_entity_pool.size());
+    zth::debug::input_int("Max pooled far terrain entities", max_pooled_far_terrain_entities);
+    zth::debug::text("Far terrain entities: {} in use, {} pooled", _far_terrain_map.size(),
+                     _far_terrain_entity_pool.size());
 
     zth::debug::text("Unhandled unload chunk requests: {}", _unload_chunk_requests.size());
     zth::debug::text("Unhandled load chunk requests: {}", _load_chunk_requests.size());
+    zth::debug::text("Chunks waiting for being installed: {}", _load_chunk_results.size());
     zth::debug::text("Unhandled update chunk requests: {}", _update_chunk_requests.size());
+    zth::debug::text("Meshes waiting for upload: {}", _update_chunk_results.size());
+
+    zth::debug::checkbox("Prefetch enabled", prefetch_enabled);
+
+    if (prefetch_enabled)
+    {
+        zth::debug::drag_float("Prefetch lookahead (s)", prefetch_lookahead);
+        zth::debug::text("Player speed: {:.1f}", static_cast<double>(glm::length(_player_velocity)));
+    }
+
+    zth::debug::checkbox("LOD enabled", lod_enabled);
+
+    if (lod_enabled)
+    {
+        for (usize i = 0; i < lod_distances.size(); i++)
+            zth::debug::slide_int(zth::format("LOD {} distance", i + 1).c_str(), lod_distances[i], 0, 100);
+    }
+
+    zth::debug::checkbox("Far terrain enabled", far_terrain_enabled);
+
+    if (far_terrain_enabled)
+    {
+        zth::debug::slide_int("Far distance", far_distance, 0, 200);
+        zth::debug::slide_int("Far terrain LOD", far_terrain_lod, 0, 4);
+        zth::debug::input_int("Max far terrain tasks", max_far_terrain_tasks);
+        zth::debug::text("Unhandled far terrain requests: {}", _far_terrain_requests.size());
+    }
+
+    zth::debug::checkbox("Ticks enabled", ticks_enabled);
+
+    if (ticks_enabled)
+    {
+        zth::debug::slide_int("Ticks per second", ticks_per_second, 1, 100);
+        zth::debug::slide_int("Max ticks per frame", max_ticks_per_frame, 1, 16);
+        zth::debug::slide_int("Random ticks per chunk", _tick_scheduler.random_ticks_per_section, 0, 64);
+        zth::debug::text("Ticks: {}", _tick_scheduler.ticks());
+        zth::debug::text("Chunks with randomly ticked blocks: {}", _tick_scheduler.active_sections());
+        zth::debug::text("Scheduled block updates: {}", _tick_scheduler.scheduled_updates());
+
+        zth::debug::slide_int("Fluid step interval (ticks)", _fluid_simulation.step_interval, 1, 40);
+        zth::debug::slide_int("Lava slowdown", _fluid_simulation.lava_slowdown, 1, 10);
+        zth::debug::input_int("Max active fluid cells per step", _fluid_simulation.max_active_cells_per_step);
+        zth::debug::text("Active fluid cells: {}", _fluid_simulation.active_cells());
+        zth::debug::text("Flowing fluid cells: {}", _fluid_simulation.flowing_cells());
+    }
+
+    zth::debug::checkbox("Memory budget enabled", memory_budget_enabled);
+
+    if (memory_budget_enabled)
+    {
+        zth::debug::slide_int("Memory budget (MiB)", memory_budget_mb, 16, 16384);
+        zth::debug::text("Resident distance: {}", get_resident_distance());
+        zth::debug::text("Evicted chunks: {}", _evicted_chunks.size());
+    }
+
+    auto usage = memory_usage();
+    auto to_mib = [](usize bytes) { return static_cast<double>(bytes) / (1024.0 * 1024.0); };
+    zth::debug::text("Memory: {:.1f} MiB", to_mib(usage.total()));
+    zth::debug::text("Chunk data: {:.1f} MiB", to_mib(usage.chunk_data));
+    zth::debug::text("Chunk meshes: {:.1f} MiB", to_mib(usage.chunk_meshes));
+    zth::debug::text("Far terrain meshes: {:.1f} MiB", to_mib(usage.far_terrain_meshes));
+    zth::debug::text("Caches: {:.1f} MiB", to_mib(usage.caches));
+    zth::debug::text("Tasks: {:.1f} MiB", to_mib(usage.tasks));
+
+    zth::debug::checkbox("Frustum culling enabled", frustum_culling_enabled);
+    zth::debug::checkbox("Occlusion culling enabled", occlusion_culling_enabled);
+    zth::debug::text("Visible chunks: {} / {}", _visible_chunk_count, _culled_chunks.size());
+
+    if (player)
+    {
+        // Chunk entities are all named "Chunk", their positions are only formatted here while the UI is drawn.
+        auto show_chunk = [this](const char* label, glm::ivec3 chunk_position) {
+            auto entity = get_chunk(chunk_position);
+
+            if (!entity)
+            {
+                zth::debug::text("{}: not loaded", label);
+                return;
+            }
+
+            const auto& chunk = entity->get<const ChunkComponent>();
+            auto [x, y, z] = chunk.position;
+            zth::debug::text("{}: (x: {}, y: {}, z: {})", label, x, y, z);
+            zth::debug::text("    LOD: {}, visible: {}, mesh: {} B{}", chunk.lod, chunk.visible, chunk.mesh_size,
+                             chunk.mesh_evicted ? " (evicted)" : "");
+        };
+
+        const auto& transform = player.transform();
+        show_chunk("Player chunk", get_player_chunk());
+
+        Ray ray{ .origin = transform.translation(), .direction = transform.forward(), .max_distance = 64.0f };
+
+        if (auto hit = raycast(ray))
+        {
+            auto [x, y, z] = hit->block_position;
+            zth::debug::text("Looking at {} ({}, {}, {}), {:.1f} blocks away", block_properties(hit->block).name, x, y,
+                             z, static_cast<double>(hit->distance));
+            show_chunk("Looked at chunk", { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) });
+
+            zth::debug::slide_int("Placed block", _placed_block, 1, static_cast<i32>(block_registry.size()) - 1);
+            auto placed_block = static_cast<BlockType>(_placed_block);
+            zth::debug::text("    {}", block_properties(placed_block).name);
+
+            // Placed in front of the face the ray entered through. Fluids placed this way are sources.
+            if (zth::debug::button("Place block"))
+                set_block(hit->block_position + face_normal(hit->face), placed_block);
+
+            if (zth::debug::button("Remove block"))
+                set_block(hit->block_position, BlockType::Air);
+        }
+    }
+
+    if constexpr (profiling::enabled)
+    {
+        auto stats = profiling::stats();
+        auto to_us = [](std::chrono::nanoseconds duration) {
+            return std::chrono::duration<double, std::micro>{ duration }.count();
+        };
+
+        for (usize i = 0; i < stats.size(); i++)
+        {
+            const auto& stage = stats[i];
+
+            zth::debug::text("{}: {} | p50 {:.1f}us | p95 {:.1f}us | p99 {:.1f}us",
+                             profiling::stage_name(static_cast<profiling::Stage>(i)), stage.count, to_us(stage.p50),
+                             to_us(stage.p95), to_us(stage.p99));
+        }
+
+        if (zth::debug::button("Dump profile"))
+        {
+            if (!profiling::dump("craftmine_profile.txt"))
+                ZTH_ERROR("Failed to write the profile.");
+        }
+
+        if (zth::debug::button("Reset profile"))
+            profiling::reset();
+
+        if (!profiling::tracing())
+        {
+            if (zth::debug::button("Start trace"))
+                profiling::start_tracing();
+        }
+        else if (zth::debug::button("Stop trace"))
+        {
+            profiling::stop_tracing();
+
+            if (!profiling::export_trace("craftmine_trace.json"))
+                ZTH_ERROR("Failed to write the trace.");
+        }
+    }
 
     if (zth::debug::button("Clear world"))
         clear_world();
@@ -30,10 +193,24 @@ auto WorldManager::debug_edit() -> void
 
 auto WorldManager::on_update([[maybe_unused]] zth::EntityHandle actor) -> void
 {
+    CRAFTMINE_PROFILE_SCOPE(profiling::Stage::Frame);
+
     auto player_chunk = get_player_chunk();
 
-    request_to_load_chunks_around_player(player_chunk);
-    request_to_unload_chunks_too_far_away_from_player(player_chunk);
+    update_player_velocity();
+    auto predicted_player_chunk = get_predicted_player_chunk(player_chunk);
+
+    request_to_load_chunks_around_player(player_chunk, predicted_player_chunk);
+    request_to_unload_chunks_too_far_away_from_player(player_chunk, predicted_player_chunk);
+
+    if (player_chunk != _last_player_chunk)
+    {
+        request_to_update_chunks_with_changed_lod(player_chunk);
+        request_far_terrain_around_player(player_chunk);
+        _last_player_chunk = player_chunk;
+    }
+
+    unload_far_terrain_out_of_range(player_chunk);
 
     // Process unload chunk requests.
     while (!_unload_chunk_requests.empty())
@@ -43,48 +220,125 @@ auto WorldManager::on_update([[maybe_unused]] zth::EntityHandle actor) -> void
         _unload_chunk_requests.pop_front();
     }
 
-    // Process load chunk requests.
-    while (!_load_chunk_requests.empty() && _load_chunk_tasks.size() < max_load_chunk_tasks)
+    // Process load chunk requests. The requests are grouped by the region they lie in and every group is loaded by
+    // a single task. No tasks of any kind are launched while the memory budget is exceeded, the requests wait.
+    zth::Vector<LoadRegion> load_regions;
+    auto free_load_task_slots = max_load_chunk_tasks - std::min(_load_chunk_tasks.size(), max_load_chunk_tasks);
+
+    while (!_over_memory_budget && !_load_chunk_requests.empty())
     {
         auto chunk_position = _load_chunk_requests.front();
 
-        if (get_distance(player_chunk, chunk_position) <= distance && !_chunk_map.contains(chunk_position))
+        if (within_load_distance(player_chunk, predicted_player_chunk, chunk_position)
+            && !_chunk_map.contains(chunk_position))
         {
+            auto region_position = get_load_region(chunk_position);
+            auto region = std::ranges::find_if(load_regions, [&](const LoadRegion& r) {
+                return r.position == region_position && r.chunk_positions.size() < max_chunks_per_load_task;
+            });
+
+            if (region == load_regions.end())
+            {
+                if (load_regions.size() >= free_load_task_slots)
+                    break;
+
+                region = load_regions.insert(load_regions.end(), LoadRegion{ .position = region_position });
+            }
+
             auto [_, success] = _chunk_map.emplace(chunk_position, create_new_chunk_entity(chunk_position));
             ZTH_ASSERT(success);
-            launch_load_chunk_task(chunk_position);
+            region->chunk_positions.push_back(chunk_position);
         }
 
         _load_chunk_requests.pop_front();
     }
 
-    // Get results from load chunk tasks.
-    for (usize i = 0, chunks_loaded_already = 0;
-         chunks_loaded_already < max_chunks_loaded_each_frame && i < _load_chunk_tasks.size(); i++)
+    for (auto& region : load_regions)
+        launch_load_chunk_task(std::move(region.chunk_positions));
+
+    // Results of the tasks are integrated for as long as the budget allows. At least one result of every kind is
+    // integrated each frame, so that nothing stalls even if the budget is too small.
+    FrameBudget budget{ std::chrono::microseconds{ integration_budget_us } };
+
+    // Get results from load chunk tasks. Every task loads a whole region, so the chunks are taken out of the tasks
+    // first and wait for being installed in a bounded queue.
+    for (usize i = 0; i < _load_chunk_tasks.size()
+                      && _load_chunk_results.size() < max_load_chunk_tasks * max_chunks_per_load_task;)
     {
         auto& task = _load_chunk_tasks[i];
 
-        if (task.wait_for(0s) == std::future_status::ready)
+        if (task.wait_for(0s) != std::future_status::ready)
         {
-            auto [chunk_position, chunk_data] = task.get();
+            i++;
+            continue;
+        }
 
-            if (auto chunk_entity = get_chunk(chunk_position))
-            {
-                update_chunk_entity_with_data(*chunk_entity, std::move(chunk_data));
-                update_neighbor_arrays_on_chunk_loaded(*chunk_entity);
+        auto loaded_chunks = task.get();
+        _loading_chunk_count -= loaded_chunks.size();
+        std::ranges::move(loaded_chunks, std::back_inserter(_load_chunk_results));
+        _load_chunk_tasks.erase(std::next(_load_chunk_tasks.begin(), static_cast<zth::isize>(i)));
+    }
 
-                request_to_update_chunk(chunk_position);
-                request_to_update_neighbors(chunk_position);
-            }
+    for (usize chunks_loaded_already = 0; !_load_chunk_results.empty(); chunks_loaded_already++)
+    {
+        if (chunks_loaded_already > 0 && !budget.fits(_load_cost.predict(1.0)))
+            break;
+
+        auto started_at = budget.elapsed();
+        auto& [chunk_position, chunk_data, chunk_decoration] = _load_chunk_results.front();
+
+        if (auto chunk_entity = get_chunk(chunk_position))
+        {
+            CRAFTMINE_PROFILE_CHUNK_SCOPE(profiling::Stage::Load, chunk_position);
+
+            update_chunk_entity_with_data(*chunk_entity, std::move(chunk_data));
+            _light_propagator.stitch_chunk(chunk_position);
+            _tick_scheduler.add_chunk(chunk_position, *get_chunk_data(chunk_position));
+            _fluid_simulation.add_chunk(chunk_position);
+
+            request_to_update_chunk(chunk_position);
+            request_to_update_neighbors(chunk_position);
+            request_to_update_chunks_with_changed_light(chunk_position);
 
-            _load_chunk_tasks.erase(std::next(_load_chunk_tasks.begin(), static_cast<zth::isize>(i)));
-            i = std::min(0uLL, i - 1); // Go back in the loop because we erased one element.
-            chunks_loaded_already++;
+            // The blocks which were already placed by the task are skipped, as they no longer change anything.
+            zth::Vector<BlockWrite> decoration;
+            gather_decoration_writes(chunk_position, decoration);
+            std::ranges::copy(chunk_decoration, std::back_inserter(decoration));
+            place_decoration_writes(decoration);
+
+            if (!chunk_decoration.empty())
+                _decoration_writes.insert_or_assign(chunk_position, std::move(chunk_decoration));
+        }
+
+        _load_chunk_results.pop_front();
+        _load_cost.add(1.0, budget.elapsed() - started_at);
+    }
+
+    // Run the ticks which are due. The chunks they modify are all requested to be updated at once, ahead of the
+    // others, along with the ones modified by decoration.
+    if (ticks_enabled && ticks_per_second > 0)
+    {
+        CRAFTMINE_PROFILE_SCOPE(profiling::Stage::Tick);
+
+        auto tick_duration = 1.0f / static_cast<float>(ticks_per_second);
+        _time_since_tick += zth::Time::delta_time<float>();
+
+        for (i32 i = 0; i < max_ticks_per_frame && _time_since_tick >= tick_duration; i++)
+        {
+            _tick_scheduler.tick();
+            _fluid_simulation.tick(budget);
+            _time_since_tick -= tick_duration;
         }
+
+        // Dropping the ticks which didn't fit keeps a slow frame from making the following ones slower.
+        _time_since_tick = std::min(_time_since_tick, tick_duration);
     }
 
+    request_to_update_modified_chunks();
+
     // Process update chunk requests.
-    while (!_update_chunk_requests.empty() && _update_chunk_tasks.size() < max_update_chunk_tasks)
+    while (!_over_memory_budget && !_update_chunk_requests.empty()
+           && _update_chunk_tasks.size() < max_update_chunk_tasks)
     {
         auto chunk_position = _update_chunk_requests.front();
 
@@ -94,24 +348,165 @@ auto WorldManager::on_update([[maybe_unused]] zth::EntityHandle actor) -> void
         _update_chunk_requests.pop_front();
     }
 
-    // Get results from update chunk tasks.
-    for (usize i = 0, chunks_updated_already = 0;
-         chunks_updated_already < max_chunks_updated_each_frame && i < _update_chunk_tasks.size(); i++)
+    // Get results from update chunk tasks. The cost of uploading a mesh depends on its size, so the results are taken
+    // out of the tasks first and wait for the upload in a queue. The queue is bounded, so that the tasks stop being
+    // launched when uploading can't keep up.
+    for (usize i = 0; i < _update_chunk_tasks.size() && _update_chunk_results.size() < max_update_chunk_tasks;)
     {
         auto& task = _update_chunk_tasks[i];
 
-        if (task.wait_for(0s) == std::future_status::ready)
+        if (task.wait_for(0s) != std::future_status::ready)
+        {
+            i++;
+            continue;
+        }
+
+        _update_chunk_results.push_back(task.get());
+        _update_chunk_tasks.erase(std::next(_update_chunk_tasks.begin(), static_cast<zth::isize>(i)));
+    }
+
+    for (usize chunks_updated_already = 0; !_update_chunk_results.empty(); chunks_updated_already++)
+    {
+        auto& [chunk_entity, chunk_generation, chunk_mesh, chunk_mesh_bounds, chunk_visibility, chunk_lod] =
+            _update_chunk_results.front();
+        auto mesh_size = static_cast<double>(chunk_mesh.size());
+
+        if (chunks_updated_already > 0 && !budget.fits(_upload_cost.predict(mesh_size)))
+            break;
+
+        auto started_at = budget.elapsed();
+
+        // The chunk may have been unloaded in the meantime and its entity reused for another chunk.
+        if (chunk_entity.valid() && chunk_entity.get<const ChunkComponent>().generation == chunk_generation)
+            update_chunk_entity(chunk_entity, chunk_mesh, chunk_mesh_bounds, chunk_visibility, chunk_lod);
+
+        _update_chunk_results.pop_front();
+        _upload_cost.add(mesh_size, budget.elapsed() - started_at);
+    }
+
+    // Process far terrain requests. Loading the chunks around the player takes priority, so these only use the load
+    // chunk task slots which are left free.
+    while (!_over_memory_budget && !_far_terrain_requests.empty()
+           && _far_terrain_tasks.size() < max_far_terrain_tasks && _load_chunk_tasks.size() < max_load_chunk_tasks)
+    {
+        auto column_position = _far_terrain_requests.front();
+
+        if (within_far_distance(player_chunk, column_position) && !_far_terrain_map.contains(column_position))
+        {
+            auto column_entity = create_new_far_terrain_entity(column_position);
+            auto [_, success] = _far_terrain_map.emplace(column_position, column_entity);
+            ZTH_ASSERT(success);
+            launch_load_far_terrain_task(column_entity);
+        }
+
+        _far_terrain_requests.pop_front();
+    }
+
+    // Get results from far terrain tasks. The meshes of the columns are all roughly the same size, so they're
+    // predicted to cost the same.
+    for (usize i = 0, columns_loaded_already = 0; i < _far_terrain_tasks.size();)
+    {
+        auto& task = _far_terrain_tasks[i];
+
+        if (task.wait_for(0s) != std::future_status::ready)
         {
-            auto [chunk_entity, chunk_mesh] = task.get();
+            i++;
+            continue;
+        }
+
+        if (columns_loaded_already > 0 && !budget.fits(_far_terrain_upload_cost.predict(1.0)))
+            break;
+
+        auto started_at = budget.elapsed();
+        auto [column_entity, column_generation, column_mesh, column_mesh_bounds] = task.get();
+
+        // The column may have gone out of range in the meantime and its entity reused for another column.
+        if (column_entity.valid() && column_entity.get<const FarTerrainComponent>().generation == column_generation)
+            update_far_terrain_entity(column_entity, column_mesh, column_mesh_bounds);
+
+        _far_terrain_tasks.erase(std::next(_far_terrain_tasks.begin(), static_cast<zth::isize>(i)));
+        _far_terrain_upload_cost.add(1.0, budget.elapsed() - started_at);
+        columns_loaded_already++;
+    }
+
+    cull_chunks();
+    enforce_memory_budget(player_chunk);
+}
+
+auto WorldManager::idle() const -> bool
+{
+    return _unload_chunk_requests.empty() && _load_chunk_requests.empty() && _load_chunk_tasks.empty()
+           && _load_chunk_results.empty() && _update_chunk_requests.empty() && _update_chunk_tasks.empty()
+           && _update_chunk_results.empty() && _far_terrain_requests.empty() && _far_terrain_tasks.empty();
+}
+
+auto WorldManager::memory_usage() const -> MemoryUsage
+{
+    MemoryUsage result;
+    usize mesh_count = 0;
+
+    for (zth::ConstEntityHandle chunk_entity : _chunk_map | std::views::values)
+    {
+        const auto& chunk = chunk_entity.get<const ChunkComponent>();
 
-            if (chunk_entity.valid())
-                update_chunk_entity(chunk_entity, chunk_mesh);
+        if (chunk.data)
+            result.chunk_data += sizeof(ChunkData);
 
-            _update_chunk_tasks.erase(std::next(_update_chunk_tasks.begin(), static_cast<zth::isize>(i)));
-            i = std::min(0uLL, i - 1); // Go back in the loop because we erased one element.
-            chunks_updated_already++;
+        if (chunk.mesh)
+        {
+            result.chunk_meshes += chunk.mesh_size;
+            mesh_count++;
         }
     }
+
+    for (zth::ConstEntityHandle column_entity : _far_terrain_map | std::views::values)
+    {
+        const auto& column = column_entity.get<const FarTerrainComponent>();
+
+        if (column.mesh)
+            result.far_terrain_meshes += column.mesh_size;
+    }
+
+    for (const auto& writes : _decoration_writes | std::views::values)
+        result.caches += writes.size() * sizeof(BlockWrite);
+
+    for (const auto& loaded_chunk : _load_chunk_results)
+    {
+        if (loaded_chunk.data)
+            result.caches += sizeof(ChunkData);
+
+        result.caches += loaded_chunk.decoration.size() * sizeof(BlockWrite);
+    }
+
+    for (const auto& update_result : _update_chunk_results)
+        result.caches += update_result.mesh.size() * sizeof(BlockVertex);
+
+    // The meshes which the running tasks are going to return are guessed to be as large as the ones already uploaded.
+    auto usage_per_mesh = result.chunk_meshes / std::max<usize>(mesh_count, 1);
+    result.tasks += _update_chunk_tasks.size() * (sizeof(ChunkNeighborhood) + usage_per_mesh);
+    result.tasks += _loading_chunk_count * sizeof(ChunkData);
+    result.tasks += _far_terrain_tasks.size() * get_far_terrain_usage_per_column(result);
+
+    return result;
+}
+
+auto WorldManager::set_block(glm::ivec3 block_position, BlockType block) -> bool
+{
+    if (!modify_block(block_position, block))
+        return false;
+
+    request_to_update_modified_chunks();
+    return true;
+}
+
+auto WorldManager::raycast(const Ray& ray) const -> Optional<RaycastHit>
+{
+    return ::raycast(get_chunk_lookup(), ray);
+}
+
+auto WorldManager::raycast(std::span<const Ray> rays) const -> zth::Vector<Optional<RaycastHit>>
+{
+    return ::raycast(get_chunk_lookup(), rays);
 }
 
 auto WorldManager::on_attach([[maybe_unused]] zth::EntityHandle actor) -> void
@@ -125,8 +520,14 @@ auto WorldManager::on_attach([[maybe_unused]] zth::EntityHandle actor) -> void
                 blocks_texture_data, zth::gl::TextureParams{ .mag_filter = zth::gl::TextureMagFilter::nearest }))
             ->get();
 
+    // Chunk meshes carry their own light (see BlockVertex), which Zenith's standard shader doesn't know about.
+    zth::gl::ShaderSources block_shader_sources{ .vertex_source = block_vertex_shader_source,
+                                                 .fragment_source = block_fragment_shader_source };
+    _block_shader = zth::AssetManager::emplace<zth::gl::Shader>("block_shader"_hs, block_shader_sources)->get();
+
     _chunk_material =
-        zth::AssetManager::emplace<zth::Material>("chunk_material"_hs, zth::Material{ .diffuse_map = _blocks_texture })
+        zth::AssetManager::emplace<zth::Material>(
+            "chunk_material"_hs, zth::Material{ .shader = _block_shader, .diffuse_map = _blocks_texture })
             ->get();
 }
 
@@ -135,13 +536,15 @@ auto WorldManager::on_detach([[maybe_unused]] zth::EntityHandle actor) -> void
     clear_world();
 
     zth::AssetManager::remove<zth::gl::Texture2D>("blocks_texture"_hs);
+    zth::AssetManager::remove<zth::gl::Shader>("block_shader"_hs);
     zth::AssetManager::remove<zth::Material>("chunk_material"_hs);
 
     _blocks_texture.reset();
+    _block_shader.reset();
     _chunk_material.reset();
 }
 
-auto WorldManager::get_chunk(glm::ivec2 chunk_position) -> Optional<zth::EntityHandle>
+auto WorldManager::get_chunk(glm::ivec3 chunk_position) -> Optional<zth::EntityHandle>
 {
     if (auto kv = _chunk_map.find(chunk_position); kv != _chunk_map.end())
     {
@@ -152,7 +555,7 @@ auto WorldManager::get_chunk(glm::ivec2 chunk_position) -> Optional<zth::EntityH
     return nil;
 }
 
-auto WorldManager::get_chunk(glm::ivec2 chunk_position) const -> Optional<zth::ConstEntityHandle>
+auto WorldManager::get_chunk(glm::ivec3 chunk_position) const -> Optional<zth::ConstEntityHandle>
 {
     if (auto kv = _chunk_map.find(chunk_position); kv != _chunk_map.end())
     {
@@ -163,211 +566,1281 @@ auto WorldManager::get_chunk(glm::ivec2 chunk_position) const -> Optional<zth::C
     return nil;
 }
 
-auto WorldManager::request_to_load_chunks_around_player(glm::ivec2 player_chunk) -> void
+auto WorldManager::get_chunk_data(glm::ivec3 chunk_position) -> ChunkData*
 {
-    if (_load_chunk_requests.size() > 5000)
-        return;
-
-    // Load chunks in a spiral pattern starting with the chunks which are the furthest away from the player. Since we
-    // want to prioritize the chunks closest to the player, we want to push them onto the front of the queue last.
+    auto chunk_entity = get_chunk(chunk_position);
 
-    for (i32 i = distance; i >= 0; i--)
-    {
-        // Top Row.
-        for (i32 x = -i; x < i; x++)
-            request_to_load_chunk_with_priority(player_chunk + glm::ivec2{ x, i });
+    if (!chunk_entity)
+        return nullptr;
 
-        // Right Column.
-        for (i32 z = i; z > -i; z--)
-            request_to_load_chunk_with_priority(player_chunk + glm::ivec2{ i, z });
+    return chunk_entity->get<ChunkComponent>().data.get();
+}
 
-        // Bottom Row.
-        for (i32 x = i; x > -i; x--)
-            request_to_load_chunk_with_priority(player_chunk + glm::ivec2{ x, -i });
+auto WorldManager::request_to_update_chunks_with_changed_light(glm::ivec3 chunk_position) -> void
+{
+    // The chunk and its neighbors are already requested to be updated.
+    for (auto changed_chunk : _light_propagator.changed_chunks())
+    {
+        auto offset = changed_chunk - chunk_position;
 
-        // Left Column.
-        for (i32 z = -i; z < i; z++)
-            request_to_load_chunk_with_priority(player_chunk + glm::ivec2{ -i, z });
+        if (offset != glm::ivec3{ 0 } && !std::ranges::contains(neighbor_offsets, offset))
+            request_to_update_chunk(changed_chunk);
     }
 
-    // Loop above doesn't handle the player chunk.
-    if (distance >= 0)
-        request_to_load_chunk_with_priority(player_chunk);
+    _light_propagator.clear_changed_chunks();
 }
 
-auto WorldManager::request_to_unload_chunks_too_far_away_from_player(glm::ivec2 player_chunk) -> void
+auto WorldManager::modify_block(glm::ivec3 block_position, BlockType block) -> bool
 {
-    for (const auto& chunk_position : _chunk_map | std::views::keys)
+    auto [x, y, z] = block_position;
+    glm::ivec3 chunk_position{ world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+    auto chunk_data = get_chunk_data(chunk_position);
+
+    if (!chunk_data)
+        return false;
+
+    auto coordinates = block_position - glm::ivec3{ chunk_x_to_world_x(chunk_position.x),
+                                                    chunk_y_to_world_y(chunk_position.y),
+                                                    chunk_z_to_world_z(chunk_position.z) };
+
+    if (write_block(*chunk_data, chunk_position, coordinates, block))
     {
-        if (get_distance(player_chunk, chunk_position) > distance)
-            request_to_unload_chunk(chunk_position);
+        _light_propagator.update_block(block_position);
+        mark_relit_chunks();
     }
-}
 
-auto WorldManager::request_to_load_chunk(glm::ivec2 chunk_position) -> void
-{
-    _load_chunk_requests.push_back(chunk_position);
+    return true;
 }
 
-auto WorldManager::request_to_load_chunk_with_priority(glm::ivec2 chunk_position) -> void
+auto WorldManager::modify_blocks(glm::ivec3 chunk_position, std::span<const BlockWrite> writes) -> bool
 {
-    _load_chunk_requests.push_front(chunk_position);
-}
+    auto chunk_data = get_chunk_data(chunk_position);
 
-auto WorldManager::launch_load_chunk_task(glm::ivec2 chunk_position) -> void
-{
-    _load_chunk_tasks.push_back(
-        std::async(std::launch::async, [chunk_position] { return load_chunk(chunk_position); }));
-}
+    if (!chunk_data)
+        return false;
 
-auto WorldManager::load_chunk(glm::ivec2 chunk_position) -> std::pair<glm::ivec2, std::shared_ptr<ChunkData>>
-{
-    // @multithreaded
+    auto [x, y, z] = chunk_position;
+    glm::ivec3 origin{ chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+    _written_blocks.clear();
 
-    return { chunk_position, WorldGenerator::generate(chunk_position) };
-}
+    for (const auto& write : writes)
+    {
+        auto coordinates = write.position - origin;
+        ZTH_ASSERT(ChunkData::valid_coordinates(coordinates));
 
-auto WorldManager::create_new_chunk_entity(glm::ivec2 chunk_position) -> zth::EntityHandle
-{
-    auto [x, z] = chunk_position;
-    auto entity = _scene->create_entity(zth::format("Chunk (x: {}, z: {})", x, z));
-    entity.transform().set_translation({ chunk_x_to_world_x(x), 0.0f, chunk_z_to_world_z(z) });
-    entity.emplace<ChunkComponent>(nullptr, get_neighbors(chunk_position), chunk_position);
-    entity.emplace<zth::MaterialComponent>(_chunk_material);
-    return entity;
-}
+        if (!write.applies_to((*chunk_data)[coordinates]))
+            continue;
 
-auto WorldManager::update_chunk_entity_with_data(zth::EntityHandle chunk_entity,
-                                                 std::shared_ptr<ChunkData>&& chunk_data) -> void
-{
-    ZTH_ASSERT(chunk_entity.valid());
-    chunk_entity.patch<ChunkComponent>([&chunk_data](auto& component) { component.data = std::move(chunk_data); });
+        if (write_block(*chunk_data, chunk_position, coordinates, write.block))
+            _written_blocks.push_back(write.position);
+    }
+
+    // All the blocks are relit together, so the light which several of them share is only taken away and spread again
+    // once.
+    if (!_written_blocks.empty())
+    {
+        _light_propagator.update_blocks(_written_blocks);
+        mark_relit_chunks();
+    }
+
+    return true;
 }
 
-auto WorldManager::update_neighbor_arrays_on_chunk_loaded(zth::EntityHandle chunk_entity) -> void
+auto WorldManager::write_block(ChunkData& chunk_data, glm::ivec3 chunk_position, glm::ivec3 coordinates,
+                               BlockType block) -> bool
 {
-    // Update the neighbor arrays of neighboring chunks to hold a reference to the data of the newly loaded chunk.
+    auto& current_block = chunk_data[coordinates];
 
-    ZTH_ASSERT(chunk_entity.valid());
-    const auto& [chunk_data, _, chunk_position] = chunk_entity.get<const ChunkComponent>();
+    if (current_block == block)
+        return false;
 
-    for (usize i = 0; i < neighbor_count; i++)
+    // Writing straight into the chunk data is safe, as the update tasks mesh snapshots taken on the main thread. The
+    // chunks whose snapshots are now out of date are requested to be updated once the caller is done modifying blocks.
+    current_block = block;
+
+    auto [x, y, z] = chunk_position;
+    glm::ivec3 origin{ chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+    auto block_position = origin + coordinates;
+    _tick_scheduler.block_changed(block_position, block);
+    _fluid_simulation.block_changed(block_position);
+
+    // The neighbors' meshes only change if the block lies in their apron, i.e. on every border of the chunk which the
+    // neighbor lies across. The chunks which the block's light reaches are marked once it's relit.
+    mark_chunk_modified(chunk_position);
+
+    for (auto offset : apron_neighbor_offsets)
     {
-        if (auto neighbor = get_chunk(chunk_position + neighbor_offsets[i]))
+        auto across = coordinates + offset;
+        auto in_apron = true;
+
+        for (glm::length_t axis = 0; axis < 3; axis++)
         {
-            auto& neighbors_array = neighbor->get<ChunkComponent>().neighbors;
-            neighbors_array[opposite_neighbor_offset_idx[i]] = chunk_data;
+            if (offset[axis] != 0 && across[axis] >= 0 && across[axis] < chunk_size[axis])
+                in_apron = false;
         }
-    }
-}
 
-auto WorldManager::request_to_update_chunk(glm::ivec2 chunk_position) -> void
-{
-    _update_chunk_requests.push_back(chunk_position);
-}
+        if (in_apron)
+            mark_chunk_modified(chunk_position + offset);
+    }
 
-auto WorldManager::request_to_update_chunk_with_priority(glm::ivec2 chunk_position) -> void
-{
-    _update_chunk_requests.push_front(chunk_position);
+    return true;
 }
 
-auto WorldManager::request_to_update_neighbors(glm::ivec2 chunk_position) -> void
+auto WorldManager::mark_relit_chunks() -> void
 {
-    for (auto coord : neighbor_offsets)
-        request_to_update_chunk(chunk_position + coord);
-}
+    for (auto changed_chunk : _light_propagator.changed_chunks())
+        mark_chunk_modified(changed_chunk);
 
-auto WorldManager::request_to_update_neighbors_with_priority(glm::ivec2 chunk_position) -> void
-{
-    for (auto coord : neighbor_offsets)
-        request_to_update_chunk_with_priority(chunk_position + coord);
+    _light_propagator.clear_changed_chunks();
 }
 
-auto WorldManager::launch_update_chunk_task(zth::EntityHandle chunk_entity) -> void
+auto WorldManager::gather_decoration_writes(glm::ivec3 chunk_position, zth::Vector<BlockWrite>& writes) const -> void
 {
-    auto [chunk_data, chunk_neighbors, chunk_position] = chunk_entity.get<const ChunkComponent>();
+    // Features reach at most one chunk past the chunk they start in.
+    for (i32 x = -1; x <= 1; x++)
+    {
+        for (i32 y = -1; y <= 1; y++)
+        {
+            for (i32 z = -1; z <= 1; z++)
+            {
+                auto kv = _decoration_writes.find(chunk_position + glm::ivec3{ x, y, z });
 
-    if (!chunk_data)
-        return;
+                if (kv == _decoration_writes.end())
+                    continue;
 
-    _update_chunk_tasks.push_back(std::async(
-        std::launch::async, [chunk_entity, data = std::move(chunk_data), neighbors = std::move(chunk_neighbors)] {
-            return update_chunk(chunk_entity, *data, neighbors);
-        }));
+                std::ranges::copy_if(kv->second, std::back_inserter(writes), [&](const BlockWrite& write) {
+                    return WorldDecorator::target_chunk(write) == chunk_position;
+                });
+            }
+        }
+    }
 }
 
-auto WorldManager::update_chunk(zth::EntityHandle chunk_entity, const ChunkData& chunk_data,
-                                const NeighborsArray& neighbors)
-    -> std::pair<zth::EntityHandle, zth::Vector<zth::StandardVertex>>
+auto WorldManager::place_decoration_writes(zth::Vector<BlockWrite>& writes) -> void
 {
-    // @multithreaded
-
-    return { chunk_entity, chunk_data.generate_mesh(neighbors) };
-}
+    // The writes are grouped by their chunk, so that every chunk is written and relit at once.
+    std::ranges::sort(writes, {}, [](const BlockWrite& write) {
+        auto chunk_position = WorldDecorator::target_chunk(write);
+        return std::tuple{ chunk_position.x, chunk_position.y, chunk_position.z };
+    });
 
-auto WorldManager::update_chunk_entity(zth::EntityHandle chunk_entity,
-                                       const zth::Vector<zth::StandardVertex>& chunk_mesh) -> void
-{
-    ZTH_ASSERT(chunk_entity.valid());
-    chunk_entity.emplace_or_replace<zth::MeshRendererComponent>(std::make_shared<zth::QuadMesh<>>(chunk_mesh));
-}
+    for (auto first = writes.begin(); first != writes.end();)
+    {
+        auto chunk_position = WorldDecorator::target_chunk(*first);
+        auto last = std::find_if(first, writes.end(), [&](const BlockWrite& write) {
+            return WorldDecorator::target_chunk(write) != chunk_position;
+        });
 
-auto WorldManager::request_to_unload_chunk(glm::ivec2 chunk_position) -> void
-{
-    _unload_chunk_requests.push_back(chunk_position);
+        modify_blocks(chunk_position, { first, last });
+        first = last;
+    }
 }
 
-auto WorldManager::unload_chunk(glm::ivec2 chunk_position) -> void
+auto WorldManager::mark_chunk_modified(glm::ivec3 chunk_position) -> void
 {
-    if (auto chunk_entity = get_chunk(chunk_position))
-    {
-        chunk_entity->destroy();
-        _chunk_map.erase(chunk_position);
-    }
+    // Only a handful of chunks are modified at once, so a linear search is cheaper than hashing.
+    if (!std::ranges::contains(_modified_chunks, chunk_position))
+        _modified_chunks.push_back(chunk_position);
 }
 
-auto WorldManager::get_player_chunk() const -> glm::ivec2
+auto WorldManager::request_to_update_modified_chunks() -> void
 {
-    if (!player)
-        return { 0, 0 };
+    for (auto chunk_position : _modified_chunks)
+        request_to_update_chunk_with_priority(chunk_position);
 
-    auto player_position = glm::ivec3{ player.transform().translation() };
-    return { world_x_to_chunk_x(player_position.x), world_z_to_chunk_z(player_position.z) };
+    _modified_chunks.clear();
 }
 
-auto WorldManager::get_distance(glm::ivec2 chunk_a, glm::ivec2 chunk_b) -> i32
+auto WorldManager::get_chunk_lookup() const -> ChunkLookup
 {
-    auto [x, z] = chunk_b - chunk_a;
-    return std::max(std::abs(x), std::abs(z));
-}
+    return [this](glm::ivec3 chunk_position) -> const ChunkData* {
+        // @multithreaded
 
-auto WorldManager::get_neighbors(glm::ivec2 chunk_position) const -> NeighborsArray
-{
-    NeighborsArray neighbors{};
+        auto chunk_entity = get_chunk(chunk_position);
 
-    for (usize i = 0; i < neighbors.size(); i++)
-    {
-        auto neighbor = get_chunk(chunk_position + neighbor_offsets[i]);
-        neighbors[i] = neighbor ? neighbor->get<const ChunkComponent>().data : nullptr;
-    }
+        if (!chunk_entity)
+            return nullptr;
 
-    return neighbors;
+        return chunk_entity->get<const ChunkComponent>().data.get();
+    };
 }
 
-auto WorldManager::clear_world() -> void
+auto WorldManager::request_to_load_chunks_around_player(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk)
+    -> void
 {
-    for (auto& chunk_entity : _chunk_map | std::views::values)
-        chunk_entity.destroy();
+    // The chunks are ordered by how soon the player is going to need them. That only changes when the player moves to
+    // another chunk or starts heading or looking somewhere else, so the requests are only rebuilt then, or when chunks
+    // were unloaded and might have to be loaded again.
+
+    auto look_direction = get_player_look_direction();
+    auto load_origin = LoadOrigin{
+        .player_chunk = player_chunk,
+        .predicted_player_chunk = predicted_player_chunk,
+        .look_octant = glm::ivec3{ glm::round(look_direction) },
+        .distance = get_resident_distance(),
+        .vertical_distance = vertical_distance,
+        .surface_distance = surface_distance,
+    };
+
+    if (load_origin == _last_load_origin && !_chunks_unloaded)
+        return;
+
+    _last_load_origin = load_origin;
+    _chunks_unloaded = false;
+    _load_chunk_requests.clear();
+
+    auto motion = glm::vec3{ predicted_player_chunk - player_chunk };
+    auto lookahead = glm::length(motion);
+    auto motion_direction = lookahead > 0.0f ? motion / lookahead : glm::vec3{ 0.0f };
+
+    // The priority of a chunk is its distance from the path the player is going to take, so the chunks ahead of the
+    // player are loaded as early as the ones right around them. Chunks behind the player seem further away than they
+    // are, and so do the ones the player isn't looking at.
+    auto priority = [&](glm::ivec3 chunk_position) {
+        auto offset = glm::vec3{ chunk_position - player_chunk };
+        auto along = glm::dot(offset, motion_direction);
+        auto result = glm::length(offset - motion_direction * std::clamp(along, 0.0f, lookahead));
+
+        if (along < 0.0f)
+            result -= along * prefetch_behind_penalty;
+
+        if (auto offset_length = glm::length(offset); offset_length > 0.0f)
+            result -= glm::dot(offset / offset_length, look_direction) * prefetch_look_bias;
+
+        return result;
+    };
+
+    auto resident_distance = get_resident_distance();
+    auto extent = glm::ivec3{ resident_distance, vertical_distance, resident_distance };
+    auto min = glm::min(player_chunk, predicted_player_chunk) - extent;
+    auto max = glm::max(player_chunk, predicted_player_chunk) + extent;
+
+    cache_surface_chunks(player_chunk, predicted_player_chunk);
+    _load_candidates.clear();
+
+    for (auto x = min.x; x <= max.x; x++)
+    {
+        for (auto z = min.z; z <= max.z; z++)
+        {
+            // The column's surface may lie far above or below the player.
+            auto min_y = min.y;
+            auto max_y = max.y;
+
+            if (auto surface = _surface_chunks.find({ x, z }); surface != _surface_chunks.end())
+            {
+                min_y = std::min(min_y, surface->second.x - surface_distance);
+                max_y = std::max(max_y, surface->second.y + surface_distance);
+            }
+
+            for (auto y = min_y; y <= max_y; y++)
+            {
+                auto chunk_position = glm::ivec3{ x, y, z };
+
+                if (within_load_distance(player_chunk, predicted_player_chunk, chunk_position)
+                    && !_chunk_map.contains(chunk_position) && !_evicted_chunks.contains(chunk_position))
+                {
+                    _load_candidates.emplace_back(priority(chunk_position), chunk_position);
+                }
+            }
+        }
+    }
+
+    std::ranges::sort(_load_candidates, {}, &std::pair<float, glm::ivec3>::first);
+
+    for (auto chunk_position : _load_candidates | std::views::values)
+        request_to_load_chunk(chunk_position);
+}
+
+auto WorldManager::request_to_unload_chunks_too_far_away_from_player(glm::ivec3 player_chunk,
+                                                                     glm::ivec3 predicted_player_chunk) -> void
+{
+    for (const auto& chunk_position : _chunk_map | std::views::keys)
+    {
+        if (!within_load_distance(player_chunk, predicted_player_chunk, chunk_position))
+            request_to_unload_chunk(chunk_position);
+    }
+
+    std::erase_if(_evicted_chunks, [&](const auto& kv) {
+        return !within_load_distance(player_chunk, predicted_player_chunk, kv.first);
+    });
+
+    auto resident_distance = get_resident_distance();
+
+    std::erase_if(_surface_chunks, [&](const auto& kv) {
+        auto column = glm::ivec3{ kv.first.x, 0, kv.first.y };
+        return get_distance(player_chunk, column) > resident_distance
+               && get_distance(predicted_player_chunk, column) > resident_distance;
+    });
+}
+
+auto WorldManager::cache_surface_chunks(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk) -> void
+{
+    auto resident_distance = get_resident_distance();
+    auto min = glm::min(player_chunk, predicted_player_chunk) - resident_distance;
+    auto max = glm::max(player_chunk, predicted_player_chunk) + resident_distance;
+
+    for (auto x = min.x; x <= max.x; x++)
+    {
+        for (auto z = min.z; z <= max.z; z++)
+        {
+            auto column = glm::ivec3{ x, 0, z };
+
+            if (_surface_chunks.contains({ x, z })
+                || (get_distance(player_chunk, column) > resident_distance
+                    && get_distance(predicted_player_chunk, column) > resident_distance))
+            {
+                continue;
+            }
+
+            HeightMap heights{ { chunk_x_to_world_x(x), chunk_z_to_world_z(z) }, { chunk_size.x, chunk_size.z } };
+            auto min_height = std::numeric_limits<i32>::max();
+            auto max_height = std::numeric_limits<i32>::min();
+
+            for (auto world_x = heights.origin().x; world_x < heights.origin().x + chunk_size.x; world_x++)
+            {
+                for (auto world_z = heights.origin().y; world_z < heights.origin().y + chunk_size.z; world_z++)
+                {
+                    min_height = std::min(min_height, heights.at(world_x, world_z));
+                    max_height = std::max(max_height, heights.at(world_x, world_z));
+                }
+            }
+
+            // Overhangs rise up to the sky height, and the sea covers the columns which lie below its level.
+            auto top = WorldGenerator::sky_height(max_height);
+
+            if (min_height <= WorldGenerator::sea_level)
+                top = std::max(top, WorldGenerator::sea_level);
+
+            _surface_chunks.emplace(glm::ivec2{ x, z },
+                                    glm::ivec2{ world_y_to_chunk_y(min_height), world_y_to_chunk_y(top) });
+        }
+    }
+}
+
+auto WorldManager::update_player_velocity() -> void
+{
+    if (!player)
+        return;
+
+    auto position = glm::vec3{ player.transform().translation() };
+    auto delta_time = zth::Time::delta_time<float>();
+
+    if (_last_player_position && delta_time > 0.0f)
+    {
+        auto displacement = position - *_last_player_position;
+
+        // Moving this far in a single frame is a teleport rather than movement.
+        if (glm::length(displacement) > static_cast<float>(distance * chunk_size.x))
+            _player_velocity = glm::vec3{ 0.0f };
+        else
+            _player_velocity = glm::mix(_player_velocity, displacement / delta_time, velocity_smoothing);
+    }
+
+    _last_player_position = position;
+}
+
+auto WorldManager::request_to_load_chunk(glm::ivec3 chunk_position) -> void
+{
+    _load_chunk_requests.push_back(chunk_position);
+}
+
+auto WorldManager::request_to_load_chunk_with_priority(glm::ivec3 chunk_position) -> void
+{
+    _load_chunk_requests.push_front(chunk_position);
+}
+
+auto WorldManager::launch_load_chunk_task(zth::Vector<glm::ivec3>&& chunk_positions) -> void
+{
+    ZTH_ASSERT(!chunk_positions.empty());
+
+    zth::Vector<BlockWrite> decoration_writes;
+
+    for (auto chunk_position : chunk_positions)
+        gather_decoration_writes(chunk_position, decoration_writes);
+
+    _loading_chunk_count += chunk_positions.size();
+    _load_chunk_tasks.push_back(std::async(std::launch::async, [store = chunk_store,
+                                                                chunk_positions = std::move(chunk_positions),
+                                                                decoration_writes = std::move(decoration_writes),
+                                                                queued_at = profiling::now()] {
+        profiling::record_since(profiling::Stage::LoadQueueWait, queued_at, chunk_positions.front());
+        return load_chunks(store.get(), chunk_positions, decoration_writes);
+    }));
+}
+
+auto WorldManager::load_chunks(const ChunkStore* store, std::span<const glm::ivec3> chunk_positions,
+                               std::span<const BlockWrite> decoration_writes) -> zth::Vector<LoadedChunk>
+{
+    // @multithreaded
+
+    // Timed per task, so the generate stage measures whole regions.
+    CRAFTMINE_PROFILE_CHUNK_SCOPE(profiling::Stage::Generate, chunk_positions.front());
+    profiling::record_bytes(profiling::Stage::Generate, chunk_positions.size() * sizeof(ChunkData));
+
+    zth::Vector<LoadedChunk> result;
+    result.reserve(chunk_positions.size());
+
+    zth::Vector<glm::ivec3> missing_positions;
+
+    // The heights are needed to light the chunks even if they're all read from the store.
+    auto heights = HeightMap::covering(chunk_positions);
+
+    if (store)
+    {
+        // The store keeps the recently read regions, so the other tasks loading the same region don't read it again.
+        zth::Vector<glm::ivec2> store_regions;
+
+        for (auto chunk_position : chunk_positions)
+        {
+            auto region = ChunkStore::region_of(chunk_position);
+
+            if (!std::ranges::contains(store_regions, region))
+                store_regions.push_back(region);
+        }
+
+        for (auto region : store_regions)
+        {
+            for (auto& [position, data] : store->read_chunks(region, WorldGenerator::seed, chunk_positions))
+                result.push_back(LoadedChunk{ .position = position, .data = std::move(data) });
+        }
+
+        for (auto chunk_position : chunk_positions)
+        {
+            if (!std::ranges::contains(result, chunk_position, &LoadedChunk::position))
+                missing_positions.push_back(chunk_position);
+        }
+    }
+    else
+    {
+        missing_positions.assign(chunk_positions.begin(), chunk_positions.end());
+    }
+
+    auto chunks = WorldGenerator::generate_region(missing_positions, heights);
+
+    for (usize i = 0; i < missing_positions.size(); i++)
+        result.push_back(LoadedChunk{ .position = missing_positions[i], .data = std::move(chunks[i]) });
+
+    // The store holds the chunks as they were generated, so they're decorated as well. The features which reach into
+    // the other chunks of the task are completed right away, the rest is left to the world manager.
+    for (auto& [chunk_position, chunk_data, chunk_decoration] : result)
+    {
+        chunk_decoration = WorldDecorator::decorate(*chunk_data, chunk_position, heights);
+        WorldDecorator::place(*chunk_data, chunk_position, decoration_writes);
+    }
+
+    for (const auto& source : result)
+    {
+        for (auto& target : result)
+        {
+            if (&target != &source)
+                WorldDecorator::place(*target.data, target.position, source.decoration);
+        }
+    }
+
+    for (auto& [chunk_position, chunk_data, _] : result)
+        light_chunk(*chunk_data, chunk_position, heights);
+
+    return result;
+}
+
+auto WorldManager::get_load_region(glm::ivec3 chunk_position) const -> glm::ivec2
+{
+    auto region_size = static_cast<float>(std::max(load_region_size, 1));
+    return glm::ivec2{ glm::floor(glm::vec2{ chunk_position.x, chunk_position.z } / region_size) };
+}
+
+auto WorldManager::create_new_chunk_entity(glm::ivec3 chunk_position) -> zth::EntityHandle
+{
+    auto [x, y, z] = chunk_position;
+    glm::vec3 translation{ chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+
+    // Pooled entities already have all the components, only the chunk component has to be filled in.
+    if (!_chunk_entity_pool.empty())
+    {
+        auto entity = _chunk_entity_pool.back();
+        _chunk_entity_pool.pop_back();
+
+        auto& chunk = entity.get<ChunkComponent>();
+        chunk = ChunkComponent{ .position = chunk_position, .generation = chunk.generation };
+        entity.transform().set_translation(translation);
+        return entity;
+    }
+
+    auto entity = _scene->create_entity("Chunk");
+    entity.transform().set_translation(translation);
+    entity.emplace<ChunkComponent>(nullptr, chunk_position);
+    entity.emplace<zth::MaterialComponent>(_chunk_material);
+    return entity;
+}
+
+auto WorldManager::release_chunk_entity(zth::EntityHandle chunk_entity) -> void
+{
+    if (_chunk_entity_pool.size() >= max_pooled_chunk_entities)
+    {
+        chunk_entity.destroy();
+        return;
+    }
+
+    set_mesh_visible<ChunkComponent>(chunk_entity, false);
+
+    // Drops the chunk's data and mesh. The results of the chunk's running tasks no longer match the generation.
+    auto& chunk = chunk_entity.get<ChunkComponent>();
+    chunk = ChunkComponent{ .generation = chunk.generation + 1 };
+
+    _chunk_entity_pool.push_back(chunk_entity);
+}
+
+auto WorldManager::update_chunk_entity_with_data(zth::EntityHandle chunk_entity,
+                                                 std::shared_ptr<ChunkData>&& chunk_data) -> void
+{
+    ZTH_ASSERT(chunk_entity.valid());
+    chunk_entity.patch<ChunkComponent>([&chunk_data](auto& component) { component.data = std::move(chunk_data); });
+}
+
+auto WorldManager::request_to_update_chunk(glm::ivec3 chunk_position) -> void
+{
+    _update_chunk_requests.push_back(chunk_position);
+}
+
+auto WorldManager::request_to_update_chunk_with_priority(glm::ivec3 chunk_position) -> void
+{
+    _update_chunk_requests.push_front(chunk_position);
+}
+
+auto WorldManager::request_to_update_neighbors(glm::ivec3 chunk_position) -> void
+{
+    for (auto coord : neighbor_offsets)
+        request_to_update_chunk(chunk_position + coord);
+}
+
+auto WorldManager::launch_update_chunk_task(zth::EntityHandle chunk_entity) -> void
+{
+    const auto& chunk = chunk_entity.get<const ChunkComponent>();
+    const auto& chunk_data = chunk.data;
+    auto chunk_position = chunk.position;
+
+    if (!chunk_data)
+        return;
+
+    // Edits, light and loading neighbors keep requesting updates for chunks whose mesh was evicted. Those are skipped,
+    // culling clears the flag and requests the chunk again once it might be visible.
+    if (chunk.mesh_evicted)
+        return;
+
+    if (chunk_data->empty())
+    {
+        update_chunk_entity(chunk_entity, {}, {}, ChunkVisibility::all(), 0);
+        return;
+    }
+
+    auto player_chunk = get_player_chunk();
+    auto lod = get_lod(player_chunk, chunk_position);
+
+    NeighborLodsArray neighbor_lods{};
+
+    for (usize i = 0; i < neighbor_count; i++)
+        neighbor_lods[i] = get_lod(player_chunk, chunk_position + neighbor_offsets[i]);
+
+    // The blocks and light of loaded chunks are written on the main thread (block edits, ticks, fluids, decoration and
+    // light propagation), so the task gets a snapshot of them instead of reading the chunks while they change.
+    auto neighborhood = std::make_unique_for_overwrite<ChunkNeighborhood>();
+    neighborhood->copy_chunk(*chunk_data);
+    neighborhood->copy_borders(get_neighbors(chunk_position));
+
+    _update_chunk_tasks.push_back(std::async(
+        std::launch::async, [chunk_entity, chunk_generation = chunk.generation, chunk_position,
+                             neighborhood = std::move(neighborhood), lod, neighbor_lods, queued_at = profiling::now()] {
+            profiling::record_since(profiling::Stage::UpdateQueueWait, queued_at, chunk_position);
+            CRAFTMINE_PROFILE_CHUNK_SCOPE(profiling::Stage::Mesh, chunk_position);
+            return update_chunk(chunk_entity, chunk_generation, *neighborhood, lod, neighbor_lods);
+        }));
+}
+
+auto WorldManager::update_chunk(zth::EntityHandle chunk_entity, u32 chunk_generation, ChunkNeighborhood& neighborhood,
+                                usize lod, const NeighborLodsArray& neighbor_lods) -> UpdateChunkResult
+{
+    // @multithreaded
+
+    neighborhood.expose_lod_borders(lod, neighbor_lods);
+    auto mesh = neighborhood.generate_lod_mesh(lod);
+    auto bounds = bounds_of(mesh);
+    auto visibility = ChunkVisibility::compute(neighborhood);
+
+    return {
+        .chunk_entity = chunk_entity,
+        .chunk_generation = chunk_generation,
+        .mesh = std::move(mesh),
+        .bounds = bounds,
+        .visibility = visibility,
+        .lod = lod,
+    };
+}
+
+auto WorldManager::update_chunk_entity(zth::EntityHandle chunk_entity,
+                                       const zth::Vector<BlockVertex>& chunk_mesh,
+                                       const Aabb& chunk_mesh_bounds, ChunkVisibility chunk_visibility, usize lod)
+    -> void
+{
+    ZTH_ASSERT(chunk_entity.valid());
+
+    auto& chunk = chunk_entity.get<ChunkComponent>();
+
+    CRAFTMINE_PROFILE_CHUNK_SCOPE(profiling::Stage::Upload, chunk.position);
+    profiling::record_bytes(profiling::Stage::Upload, chunk_mesh.size() * sizeof(BlockVertex));
+
+    chunk.visibility = chunk_visibility;
+    chunk.lod = lod;
+    chunk.mesh_size = chunk_mesh.size() * sizeof(BlockVertex);
+    chunk.mesh_evicted = false;
+
+    if (!chunk.meshed)
+    {
+        chunk.meshed = true;
+        profiling::record_since(profiling::Stage::PopIn, chunk.created_at, chunk.position);
+    }
+
+    if (chunk_mesh.empty())
+    {
+        set_mesh_visible<ChunkComponent>(chunk_entity, false);
+        chunk.mesh = nullptr;
+        return;
+    }
+
+    auto chunk_origin = glm::vec3{ chunk_entity.transform().translation() };
+
+    chunk.mesh = std::make_shared<BlockMesh>(chunk_mesh);
+    chunk.bounds = Aabb{ .min = chunk_mesh_bounds.min + chunk_origin, .max = chunk_mesh_bounds.max + chunk_origin };
+
+    if (chunk.visible)
+        chunk_entity.emplace_or_replace<zth::MeshRendererComponent>(chunk.mesh);
+}
+
+auto WorldManager::request_to_update_chunks_with_changed_lod(glm::ivec3 player_chunk) -> void
+{
+    for (const auto& [chunk_position, chunk_entity] : _chunk_map)
+    {
+        const auto& chunk = chunk_entity.get<const ChunkComponent>();
+
+        // Chunks without a mesh either haven't been meshed yet or don't need a mesh at all. The neighbors cover the
+        // gaps towards the chunk's level of detail, so they are remeshed as well.
+        if (chunk.mesh && chunk.lod != get_lod(player_chunk, chunk_position))
+        {
+            request_to_update_chunk(chunk_position);
+            request_to_update_neighbors(chunk_position);
+        }
+    }
+}
+
+auto WorldManager::request_far_terrain_around_player(glm::ivec3 player_chunk) -> void
+{
+    _far_terrain_requests.clear();
+
+    if (!far_terrain_enabled)
+        return;
+
+    // Push the rings of columns around the player starting with the closest one.
+
+    glm::ivec2 player_column{ player_chunk.x, player_chunk.z };
+
+    for (i32 i = std::max(get_resident_distance() + 1, 1); i <= far_distance; i++)
+    {
+        // Top Row.
+        for (i32 x = -i; x < i; x++)
+            _far_terrain_requests.push_back(player_column + glm::ivec2{ x, i });
+
+        // Right Column.
+        for (i32 z = i; z > -i; z--)
+            _far_terrain_requests.push_back(player_column + glm::ivec2{ i, z });
+
+        // Bottom Row.
+        for (i32 x = i; x > -i; x--)
+            _far_terrain_requests.push_back(player_column + glm::ivec2{ x, -i });
+
+        // Left Column.
+        for (i32 z = -i; z < i; z++)
+            _far_terrain_requests.push_back(player_column + glm::ivec2{ -i, z });
+    }
+}
+
+auto WorldManager::unload_far_terrain_out_of_range(glm::ivec3 player_chunk) -> void
+{
+    std::erase_if(_far_terrain_map, [&](auto& kv) {
+        auto& [column_position, column_entity] = kv;
+
+        if (within_far_distance(player_chunk, column_position))
+            return false;
+
+        release_far_terrain_entity(column_entity);
+        return true;
+    });
+}
+
+auto WorldManager::launch_load_far_terrain_task(zth::EntityHandle column_entity) -> void
+{
+    const auto& column = column_entity.get<const FarTerrainComponent>();
+    auto column_position = column.position;
+    auto column_generation = column.generation;
+    auto cell_size = 1 << std::clamp(far_terrain_lod, 0, 4);
+
+    _far_terrain_tasks.push_back(
+        std::async(std::launch::async, [column_entity, column_generation, column_position, cell_size] {
+            return load_far_terrain(column_entity, column_generation, column_position, cell_size);
+        }));
+}
+
+auto WorldManager::load_far_terrain(zth::EntityHandle column_entity, u32 column_generation,
+                                    glm::ivec2 column_position, i32 cell_size) -> FarTerrainResult
+{
+    // @multithreaded
+
+    CRAFTMINE_PROFILE_SCOPE(profiling::Stage::FarTerrain);
+
+    auto mesh = generate_far_terrain_mesh(column_position, cell_size);
+    auto bounds = bounds_of(mesh);
+
+    return { .column_entity = column_entity,
+             .column_generation = column_generation,
+             .mesh = std::move(mesh),
+             .bounds = bounds };
+}
+
+auto WorldManager::create_new_far_terrain_entity(glm::ivec2 column_position) -> zth::EntityHandle
+{
+    auto [x, z] = column_position;
+    glm::vec3 translation{ chunk_x_to_world_x(x), 0.0f, chunk_z_to_world_z(z) };
+
+    // Pooled entities already have all the components, only the far terrain component has to be filled in.
+    if (!_far_terrain_entity_pool.empty())
+    {
+        auto entity = _far_terrain_entity_pool.back();
+        _far_terrain_entity_pool.pop_back();
+
+        auto& column = entity.get<FarTerrainComponent>();
+        column = FarTerrainComponent{ .position = column_position, .generation = column.generation };
+        entity.transform().set_translation(translation);
+        return entity;
+    }
+
+    auto entity = _scene->create_entity("Far Terrain");
+    entity.transform().set_translation(translation);
+    entity.emplace<FarTerrainComponent>(column_position);
+    entity.emplace<zth::MaterialComponent>(_chunk_material);
+    return entity;
+}
+
+auto WorldManager::release_far_terrain_entity(zth::EntityHandle column_entity) -> void
+{
+    if (_far_terrain_entity_pool.size() >= max_pooled_far_terrain_entities)
+    {
+        column_entity.destroy();
+        return;
+    }
+
+    set_mesh_visible<FarTerrainComponent>(column_entity, false);
+
+    // Drops the column's mesh. The result of the column's running task no longer matches the generation.
+    auto& column = column_entity.get<FarTerrainComponent>();
+    column = FarTerrainComponent{ .generation = column.generation + 1 };
+
+    _far_terrain_entity_pool.push_back(column_entity);
+}
+
+auto WorldManager::update_far_terrain_entity(zth::EntityHandle column_entity,
+                                             const zth::Vector<BlockVertex>& column_mesh,
+                                             const Aabb& column_mesh_bounds) -> void
+{
+    ZTH_ASSERT(column_entity.valid());
+
+    if (column_mesh.empty())
+        return;
+
+    auto& column = column_entity.get<FarTerrainComponent>();
+    auto column_origin = glm::vec3{ column_entity.transform().translation() };
+
+    column.mesh = std::make_shared<BlockMesh>(column_mesh);
+    column.mesh_size = column_mesh.size() * sizeof(BlockVertex);
+    column.bounds =
+        Aabb{ .min = column_mesh_bounds.min + column_origin, .max = column_mesh_bounds.max + column_origin };
+
+    if (column.visible)
+        column_entity.emplace_or_replace<zth::MeshRendererComponent>(column.mesh);
+}
+
+auto WorldManager::cull_chunks() -> void
+{
+    _culled_chunks.clear();
+    _culled_chunk_bounds.clear();
+    _frame++;
+
+    // The bounds of an evicted mesh are still there to tell whether the chunk might be visible.
+    for (auto& chunk_entity : _chunk_map | std::views::values)
+    {
+        const auto& chunk = chunk_entity.get<const ChunkComponent>();
+
+        if (!chunk.mesh && !chunk.mesh_evicted)
+            continue;
+
+        _culled_chunks.push_back(chunk_entity);
+        _culled_chunk_bounds.push_back(chunk.bounds);
+    }
+
+    _culled_chunk_visibility.resize(_culled_chunks.size());
+    std::ranges::fill(_culled_chunk_visibility, true);
+
+    auto player_chunk = get_player_chunk();
+    auto frustum = frustum_culling_enabled ? get_player_frustum() : nil;
+
+    if (frustum)
+        frustum->cull(_culled_chunk_bounds, _culled_chunk_visibility);
+
+    if (occlusion_culling_enabled)
+    {
+        const auto& potentially_visible_chunks = _occlusion_culler.find_visible_chunks(
+            player_chunk,
+            [this, player_chunk](glm::ivec3 chunk_position) {
+                return get_chunk_visibility(player_chunk, chunk_position);
+            },
+            frustum ? &*frustum : nullptr);
+
+        for (usize i = 0; i < _culled_chunks.size(); i++)
+        {
+            const auto& chunk = _culled_chunks[i].get<const ChunkComponent>();
+
+            if (!potentially_visible_chunks.contains(chunk.position))
+                _culled_chunk_visibility[i] = false;
+        }
+    }
+
+    _visible_chunk_count = 0;
+
+    for (usize i = 0; i < _culled_chunks.size(); i++)
+    {
+        auto chunk_entity = _culled_chunks[i];
+        auto& chunk = chunk_entity.get<ChunkComponent>();
+        auto visible = static_cast<bool>(_culled_chunk_visibility[i]);
+
+        if (visible)
+        {
+            chunk.last_visible_frame = _frame;
+            _visible_chunk_count++;
+        }
+
+        if (chunk.mesh_evicted)
+        {
+            if (visible)
+            {
+                chunk.mesh_evicted = false;
+                request_to_update_chunk(chunk.position);
+            }
+
+            continue;
+        }
+
+        set_mesh_visible<ChunkComponent>(chunk_entity, visible);
+    }
+
+    // Chunks whose data was evicted are let back in once the bounds of their last mesh pass both tests. The ones which
+    // had no mesh can't be seen, they're only let back in once the player comes next to them.
+    auto readmitted = std::erase_if(_evicted_chunks, [&](const auto& kv) {
+        const auto& [chunk_position, bounds] = kv;
+
+        if (next_to(player_chunk, chunk_position))
+            return true;
+
+        return bounds && (!frustum || frustum->intersects(*bounds))
+               && (!occlusion_culling_enabled || _occlusion_culler.visible_chunks().contains(chunk_position));
+    });
+
+    if (readmitted > 0)
+        _chunks_unloaded = true;
+
+    // Far terrain lies beyond the chunks which the occlusion culler walks through, so it's only frustum culled.
+    for (auto& column_entity : _far_terrain_map | std::views::values)
+    {
+        const auto& column = column_entity.get<const FarTerrainComponent>();
+
+        if (!column.mesh)
+            continue;
+
+        set_mesh_visible<FarTerrainComponent>(column_entity, !frustum || frustum->intersects(column.bounds));
+    }
+}
+
+auto WorldManager::enforce_memory_budget(glm::ivec3 player_chunk) -> void
+{
+    if (!memory_budget_enabled)
+    {
+        set_memory_limited_distance(std::numeric_limits<i32>::max());
+        _over_memory_budget = false;
+
+        if (!_evicted_chunks.empty())
+        {
+            _evicted_chunks.clear();
+            _chunks_unloaded = true;
+        }
+
+        return;
+    }
+
+    auto budget = static_cast<usize>(std::max(memory_budget_mb, 0)) * 1024 * 1024;
+    auto usage = memory_usage();
+
+    if (usage.total() <= budget)
+    {
+        _over_memory_budget = false;
+
+        // The next ring of chunks is only let in once everything else is loaded and the ring is predicted to fit, so
+        // that a ring which doesn't fit isn't loaded and evicted over and over.
+        auto resident_distance = get_resident_distance();
+
+        if (resident_distance >= distance || !idle())
+            return;
+
+        // The ring's far terrain columns are unloaded once its chunks are in.
+        auto ring_column_count = static_cast<usize>(8 * (resident_distance + 1));
+        // The columns hold different numbers of chunks depending on how far the surface lies from the player, so the
+        // ones which are loaded are the best guess for the ring.
+        auto usage_per_column = (usage.chunk_data + usage.chunk_meshes) / std::max<usize>(_surface_chunks.size(), 1);
+        auto freed_far_terrain = resident_distance < far_distance
+                                     ? std::min(usage.far_terrain_meshes,
+                                                get_far_terrain_usage_per_column(usage) * ring_column_count)
+                                     : 0;
+
+        if (usage.total() + usage_per_column * ring_column_count <= budget + freed_far_terrain)
+            set_memory_limited_distance(resident_distance + 1);
+
+        return;
+    }
+
+    // Meshes of the chunks which aren't visible go first, the ones which haven't been visible for the longest time and
+    // the furthest ones among them before the others.
+    auto evict_first = [](const EvictionCandidate& a, const EvictionCandidate& b) {
+        return std::tie(a.last_visible_frame, b.distance) < std::tie(b.last_visible_frame, a.distance);
+    };
+
+    _eviction_candidates.clear();
+
+    for (const auto& [chunk_position, chunk_entity] : _chunk_map)
+    {
+        const auto& chunk = chunk_entity.get<const ChunkComponent>();
+
+        if (chunk.mesh && !chunk.visible)
+        {
+            _eviction_candidates.push_back(EvictionCandidate{
+                .last_visible_frame = chunk.last_visible_frame,
+                .distance = get_distance(player_chunk, chunk_position),
+                .chunk_entity = chunk_entity,
+            });
+        }
+    }
+
+    std::ranges::sort(_eviction_candidates, evict_first);
+
+    for (auto& candidate : _eviction_candidates)
+    {
+        if (usage.total() <= budget)
+            break;
+
+        auto& chunk = candidate.chunk_entity.get<ChunkComponent>();
+        usage.chunk_meshes -= chunk.mesh_size;
+
+        chunk.mesh = nullptr;
+        chunk.mesh_size = 0;
+        chunk.mesh_evicted = true;
+    }
+
+    // Then the data of whole chunks in the same order, visible ones included. The chunks next to the player and the
+    // ones which haven't been meshed yet are kept, the tasks the latter wait for are already counted.
+    _eviction_candidates.clear();
+
+    for (const auto& [chunk_position, chunk_entity] : _chunk_map)
+    {
+        const auto& chunk = chunk_entity.get<const ChunkComponent>();
+
+        if (chunk.data && chunk.meshed && !next_to(player_chunk, chunk_position))
+        {
+            _eviction_candidates.push_back(EvictionCandidate{
+                .last_visible_frame = chunk.last_visible_frame,
+                .distance = get_distance(player_chunk, chunk_position),
+                .chunk_entity = chunk_entity,
+            });
+        }
+    }
+
+    std::ranges::sort(_eviction_candidates, evict_first);
+
+    auto view_evicted = false;
+
+    for (auto& candidate : _eviction_candidates)
+    {
+        if (usage.total() <= budget)
+            break;
+
+        const auto& chunk = candidate.chunk_entity.get<const ChunkComponent>();
+        auto chunk_position = chunk.position;
+        auto bounds = chunk.mesh || chunk.mesh_evicted ? Optional<Aabb>{ chunk.bounds } : nil;
+
+        usage.chunk_data -= sizeof(ChunkData);
+        usage.chunk_meshes -= chunk.mesh ? chunk.mesh_size : 0;
+
+        if (auto writes = _decoration_writes.find(chunk_position); writes != _decoration_writes.end())
+            usage.caches -= writes->second.size() * sizeof(BlockWrite);
+
+        view_evicted = view_evicted || candidate.last_visible_frame == _frame;
+
+        // The chunk is unloaded right away, so the usage which is left is exact.
+        unload_chunk(chunk_position);
+        _evicted_chunks.insert_or_assign(chunk_position, bounds);
+    }
+
+    _over_memory_budget = usage.total() > budget;
+
+    // A view which doesn't fit would keep evicting the chunks it needs and loading them again, so fewer chunks are
+    // loaded from now on. Far terrain fills the ring which was given up.
+    if (view_evicted)
+        set_memory_limited_distance(std::max(get_resident_distance() - 1, 0));
+}
+
+auto WorldManager::get_far_terrain_usage_per_column(const MemoryUsage& usage) const -> usize
+{
+    // The columns which are loaded are the best guess for the size of the ones which aren't.
+    return usage.far_terrain_meshes / std::max<usize>(_far_terrain_map.size(), 1);
+}
+
+auto WorldManager::set_memory_limited_distance(i32 limited_distance) -> void
+{
+    if (limited_distance == _memory_limited_distance)
+        return;
+
+    _memory_limited_distance = limited_distance;
+
+    // Far terrain and the levels of detail are only updated when the player moves to another chunk otherwise. The load
+    // requests notice the change on their own.
+    _last_player_chunk = nil;
+}
+
+template<typename Component> auto WorldManager::set_mesh_visible(zth::EntityHandle entity, bool visible) -> void
+{
+    auto& component = entity.get<Component>();
+
+    if (component.visible == visible)
+        return;
+
+    component.visible = visible;
+
+    // Hidden entities have no mesh renderer component at all, so the renderer only ever goes through the visible ones.
+    // Adding or removing the component only swaps the entity with the last one of the component's storage, and it's
+    // only done when the entity enters or leaves the view.
+    if (visible)
+        entity.emplace_or_replace<zth::MeshRendererComponent>(component.mesh);
+    else
+        entity.remove<zth::MeshRendererComponent>();
+}
+
+auto WorldManager::get_chunk_visibility(glm::ivec3 player_chunk, glm::ivec3 chunk_position) const
+    -> Optional<ChunkVisibility>
+{
+    if (auto chunk_entity = get_chunk(chunk_position))
+        return chunk_entity->get<const ChunkComponent>().visibility;
+
+    // Chunks which haven't been loaded yet can't hide anything.
+    if (within_distance(player_chunk, chunk_position))
+        return ChunkVisibility::all();
+
+    return nil;
+}
+
+auto WorldManager::request_to_unload_chunk(glm::ivec3 chunk_position) -> void
+{
+    _unload_chunk_requests.push_back(chunk_position);
+}
+
+auto WorldManager::unload_chunk(glm::ivec3 chunk_position) -> void
+{
+    CRAFTMINE_PROFILE_CHUNK_SCOPE(profiling::Stage::Unload, chunk_position);
+
+    if (auto chunk_entity = get_chunk(chunk_position))
+    {
+        release_chunk_entity(*chunk_entity);
+        _chunk_map.erase(chunk_position);
+        _chunks_unloaded = true;
+        _decoration_writes.erase(chunk_position);
+        _tick_scheduler.remove_chunk(chunk_position);
+        _fluid_simulation.remove_chunk(chunk_position);
+    }
+}
+
+auto WorldManager::get_player_chunk() const -> glm::ivec3
+{
+    if (!player)
+        return { 0, 0, 0 };
+
+    auto player_position = glm::ivec3{ glm::floor(player.transform().translation()) };
+    return { world_x_to_chunk_x(player_position.x), world_y_to_chunk_y(player_position.y),
+             world_z_to_chunk_z(player_position.z) };
+}
+
+auto WorldManager::get_predicted_player_chunk(glm::ivec3 player_chunk) const -> glm::ivec3
+{
+    if (!prefetch_enabled || !player)
+        return player_chunk;
+
+    // Never look further ahead than the load distance, so the prefetched chunks stay next to the loaded ones.
+    auto max_lookahead = static_cast<float>(distance * chunk_size.x);
+    auto lookahead = _player_velocity * prefetch_lookahead;
+
+    if (auto length = glm::length(lookahead); length > max_lookahead)
+        lookahead *= max_lookahead / length;
+
+    auto predicted_position = glm::ivec3{ glm::floor(glm::vec3{ player.transform().translation() } + lookahead) };
+    return { world_x_to_chunk_x(predicted_position.x), world_y_to_chunk_y(predicted_position.y),
+             world_z_to_chunk_z(predicted_position.z) };
+}
+
+auto WorldManager::get_player_look_direction() const -> glm::vec3
+{
+    if (!player)
+        return zth::math::world_forward;
+
+    return player.transform().forward();
+}
+
+auto WorldManager::get_player_frustum() const -> Optional<Frustum>
+{
+    if (!player || !player.any_of<zth::CameraComponent>())
+        return nil;
+
+    const auto& camera = player.get<const zth::CameraComponent>();
+    const auto& transform = player.transform();
+    return Frustum::from_camera(camera, transform.translation(), transform.forward());
+}
+
+auto WorldManager::get_distance(glm::ivec3 chunk_a, glm::ivec3 chunk_b) -> i32
+{
+    auto [x, _, z] = chunk_b - chunk_a;
+    return std::max(std::abs(x), std::abs(z));
+}
+
+auto WorldManager::get_vertical_distance(glm::ivec3 chunk_a, glm::ivec3 chunk_b) -> i32
+{
+    return std::abs(chunk_b.y - chunk_a.y);
+}
+
+auto WorldManager::next_to(glm::ivec3 chunk_a, glm::ivec3 chunk_b) -> bool
+{
+    return get_distance(chunk_a, chunk_b) <= 1 && get_vertical_distance(chunk_a, chunk_b) <= 1;
+}
+
+auto WorldManager::get_resident_distance() const -> i32
+{
+    return std::min(distance, _memory_limited_distance);
+}
+
+auto WorldManager::within_surface_distance(glm::ivec3 chunk_position) const -> bool
+{
+    auto surface = _surface_chunks.find({ chunk_position.x, chunk_position.z });
+
+    if (surface == _surface_chunks.end())
+        return false;
+
+    return chunk_position.y >= surface->second.x - surface_distance
+           && chunk_position.y <= surface->second.y + surface_distance;
+}
+
+auto WorldManager::within_distance(glm::ivec3 player_chunk, glm::ivec3 chunk_position) const -> bool
+{
+    return get_distance(player_chunk, chunk_position) <= get_resident_distance()
+           && (get_vertical_distance(player_chunk, chunk_position) <= vertical_distance
+               || within_surface_distance(chunk_position));
+}
+
+auto WorldManager::within_load_distance(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk,
+                                        glm::ivec3 chunk_position) const -> bool
+{
+    return within_distance(player_chunk, chunk_position) || within_distance(predicted_player_chunk, chunk_position);
+}
+
+auto WorldManager::within_far_distance(glm::ivec3 player_chunk, glm::ivec2 column_position) const -> bool
+{
+    if (!far_terrain_enabled)
+        return false;
+
+    auto column_distance =
+        get_distance(player_chunk, glm::ivec3{ column_position.x, player_chunk.y, column_position.y });
+    return column_distance > get_resident_distance() && column_distance <= far_distance;
+}
+
+auto WorldManager::get_lod(glm::ivec3 player_chunk, glm::ivec3 chunk_position) const -> usize
+{
+    if (!lod_enabled)
+        return 0;
+
+    auto chunk_distance = get_distance(player_chunk, chunk_position);
+    usize lod = 0;
+
+    while (lod < lod_distances.size() && chunk_distance > lod_distances[lod])
+        lod++;
+
+    return lod;
+}
+
+auto WorldManager::get_neighbors(glm::ivec3 chunk_position) const -> NeighborsArray
+{
+    NeighborsArray neighbors{};
+
+    for (usize i = 0; i < neighbors.size(); i++)
+    {
+        auto neighbor = get_chunk(chunk_position + apron_neighbor_offsets[i]);
+        neighbors[i] = neighbor ? neighbor->get<const ChunkComponent>().data.get() : nullptr;
+    }
+
+    return neighbors;
+}
+
+auto WorldManager::clear_world() -> void
+{
+    for (auto& chunk_entity : _chunk_map | std::views::values)
+        chunk_entity.destroy();
+
+    for (auto& chunk_entity : _chunk_entity_pool)
+        chunk_entity.destroy();
 
     _chunk_map.clear();
+    _chunk_entity_pool.clear();
+    _decoration_writes.clear();
+
+    _tick_scheduler.clear();
+    _fluid_simulation.clear();
+    _time_since_tick = 0.0f;
+    _modified_chunks.clear();
 
     _unload_chunk_requests.clear();
 
     _load_chunk_requests.clear();
     _load_chunk_tasks.clear();
+    _loading_chunk_count = 0;
+    _load_chunk_results.clear();
 
     _update_chunk_requests.clear();
     _update_chunk_tasks.clear();
+    _update_chunk_results.clear();
+
+    _evicted_chunks.clear();
+    _over_memory_budget = false;
+
+    for (auto& column_entity : _far_terrain_map | std::views::values)
+        column_entity.destroy();
+
+    for (auto& column_entity : _far_terrain_entity_pool)
+        column_entity.destroy();
+
+    _far_terrain_map.clear();
+    _far_terrain_entity_pool.clear();
+    _far_terrain_requests.clear();
+    _far_terrain_tasks.clear();
+    _surface_chunks.clear();
+    _last_player_chunk = nil;
+    _last_load_origin = nil;
 }
 
 } // namespace scripts
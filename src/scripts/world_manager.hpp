@@ -3,57 +3,141 @@
 #include <future>
 #include <thread>
 
+#include "frame_budget.hpp"
 #include "hash.hpp"
 #include "world/chunk.hpp"
+#include "world/chunk_store.hpp"
+#include "world/decoration.hpp"
+#include "world/far_terrain.hpp"
+#include "world/fluids.hpp"
+#include "world/lighting.hpp"
+#include "world/occlusion.hpp"
+#include "world/raycast.hpp"
+#include "world/ticks.hpp"
 
 namespace scripts {
 
 // Chunk management process.
 //
-// Chunk component consists of a shared pointer to the chunk's data and an array of shared pointers to the neighboring
-// chunks. When a new chunk entity is created, the pointer to the chunk's data is not set, but the pointers to the
-// neighboring chunks are set if these chunks already exist. Whenever world manager finishes loading the chunk's data,
-// it updates the chunk's data pointer and also the neighbor arrays of neighboring chunks. It also pushes onto the
-// update queue the coordinates of the loaded chunk and the neighboring chunks.
+// Chunk component consists of a shared pointer to the chunk's data and the chunk's position. When a new chunk entity is
+// created, the pointer to the chunk's data is not set. Whenever world manager finishes loading the chunk's data, it
+// updates the chunk's data pointer and pushes onto the update queue the coordinates of the loaded chunk and the
+// neighboring chunks.
 //
 // World manager holds a map which associates a chunk's coordinates with its entity handle. It also keeps separate
 // queues of the coordinates of chunks to unload, load and update (updating a chunk means generating a mesh for it).
-// There's no locking mechanism as all the update operations which run on a separate thread only handle generating a
-// mesh for the chunk, so they only need read access to the data and the data getting updated at the same time as the
-// mesh is being generated isn't an issue since modifying the data means that the chunk is going to be updated again
-// later anyway.
+// Neighboring chunks are always looked up through the map. Before an update task is launched, the chunk and the blocks
+// bordering it are copied out of the chunk data into a chunk neighborhood on the main thread, so the task never touches
+// the chunk data itself. There's no locking mechanism as the chunk data is only ever written on the main thread (block
+// edits, ticks, fluids, decoration and light propagation) and the tasks only read their own snapshot. A chunk modified
+// after its snapshot was taken is requested to be updated again.
 //
 // World manager performs these steps on every update in order:
 //
 // 1. --- Determine which chunks need to be loaded and which ones need to be unloaded ---
-//     - Iterate over all the chunk coordinates which are within a specified distance from the player and push them onto
-//     the load chunk queue. The chunks closest to the player should be pushed onto the front of the queue.
+//     - Whenever the player moves to another chunk, starts heading somewhere else or turns around, rebuild the load
+//     chunk queue out of all the chunk coordinates which are within a specified distance from the player or from the
+//     position the player is predicted to reach (based on the player's smoothed velocity). The horizontal and the
+//     vertical distance are specified separately. Within the horizontal distance, the chunks within a separate distance
+//     of the terrain's surface are added as well, so the surface is loaded wherever the player is. The lowest and
+//     highest chunk the surface passes through are evaluated once for every column from the generator's height noise
+//     and cached while the column is within the distance. The chunks are ordered by their distance from the player's
+//     predicted path, with chunks behind the player and outside of the player's view pushed further back.
+//     - Chunks which are out of that range are pushed onto the unload chunk queue. While the memory budget is exceeded
+//     the range is smaller than the specified distance, see step 10.
 //
 // 2. --- Unload chunks ---
-//     - Go through unload chunk requests and remove the entity handles from the map along with destroying these
-//     entities.
+//     - Go through unload chunk requests and remove the entity handles from the map. The entities are reset and kept in
+//     a pool for the chunks which get loaded next, up to a limit, and only the ones which don't fit are destroyed.
 //
 // 3. --- Load chunks ---
-//     - Go through load chunk requests and process them if the number of running load chunk tasks is less than N and if
-//     the requested chunk's position is within the specified distance from the player. Insert a chunk entity entry into
-//     the map. If an entry for that coordinate already exists, skip this request.
-//     - Emplace a chunk component onto the entity without the chunk data, but update the neighbor array to hold
-//     pointers to the data of the chunks which already exist.
-//     - Create and run a load chunk task on a separate thread.
+//     - Go through load chunk requests and process them if the requested chunk's position is within the specified
+//     distance from the player. Insert a chunk entity entry into the map. If an entry for that coordinate already
+//     exists, skip this request.
+//     - Take the entity out of the pool or create a new one, and emplace a chunk component onto it without the chunk
+//     data. Chunk entities aren't named after their position, the debug UI formats the positions it shows on its own.
+//     - Group the processed requests by the region of columns they lie in. Stop once there would be more groups than
+//     free load chunk task slots (out of N).
+//     - Create and run a load chunk task for every group on a separate thread. The task reads the group's chunks out
+//     of the chunk store if there's one, then evaluates the terrain's heights once for the rest of the group and
+//     generates them in parallel. Every chunk is then decorated with the features which start within it, and the
+//     blocks of the features which reach into the other chunks of the group or were handed over from the loaded chunks
+//     are placed. Finally, every chunk is lit on its own, with sky light shining down the columns which are open to the
+//     sky.
 //
 // 4. --- Get load chunk results ---
-//     - Go through first N load chunk tasks and if the result is ready, update the corresponding chunk's data pointer,
-//     and update the neighbor arrays of neighboring chunks to hold a reference to the data of the chunk that was just
-//     loaded. Add the chunk and neighboring chunks to the update queue.
+//     - Go through load chunk tasks and move the chunks of the ready ones into a queue of chunks waiting for being
+//     installed, up to a bound. Then go through the queue and update the corresponding chunk's data pointer. Spread
+//     the light across the borders between the chunk and its loaded neighbors. Add the chunk, neighboring chunks and
+//     any other chunks whose light changed to the update queue. Hand the chunk over to the tick scheduler.
+//     - Place the blocks of the chunk's features which fall into its loaded neighbors, and the blocks of the neighbors'
+//     features which fall into the chunk and weren't placed by its task. Keep the former for the neighbors which aren't
+//     loaded yet. The chunks modified this way are requested to be updated together with the ones modified by step 5.
+//     - Steps 4, 5 (the fluid simulation), 7 and 8 share a time budget. Before a result is integrated, its cost is
+//     predicted from the measured costs of the previous results of the same kind, and the step stops once the result
+//     wouldn't fit into what's left of the budget. At least one result of every kind is integrated each frame.
 //
-// 5. --- Update chunk ---
+// 5. --- Tick blocks ---
+//     - Run as many ticks of the tick scheduler as the time since the last tick covers, up to N. The ticks update the
+//     blocks which were scheduled to be updated and a few random blocks of every chunk which has blocks that react to
+//     random ticks (see ticks.hpp). Every few ticks, the fluid simulation moves the fluids which are still flowing
+//     (see fluids.hpp).
+//     - Every change made by the ticks is relit right away, and the changes made by the fluid simulation are relit one
+//     chunk at a time. The fluid simulation stops writing its changes once the shared time budget runs out, and
+//     evaluates the rest again on its next step. The chunks which need to be remeshed are only collected and pushed
+//     onto the front of the update queue together once all the ticks are over.
+//
+// 6. --- Update chunk ---
 //     - Go through update chunk requests and process them if the number of running update chunk tasks is less than N.
-//     If an entity with the provided coordinates is not found in the map, skip this request.
-//     - Create and run an update chunk task on a separate thread.
+//     If an entity with the provided coordinates is not found in the map, skip this request. Chunks which consist only
+//     of air get an empty mesh right away.
+//     - Copy the chunk and the borders of the neighboring chunks into a chunk neighborhood and create and run an update
+//     chunk task on a separate thread. Chunks further away from the player are meshed at a lower level of detail, and
+//     the faces on the borders between two levels are emitted on both sides. Whenever the player moves to another
+//     chunk, chunks whose level of detail changed are pushed onto the update queue together with their neighbors.
+//
+// 7. --- Get update chunk results ---
+//     - Go through update chunk tasks and move the ready results into a queue of meshes waiting for the upload, up to N
+//     of them. Then go through the queue and update the corresponding chunk's mesh and bounds (This always has to be
+//     done on the main thread). The predicted cost of the upload depends on the size of the mesh.
+//
+// 8. --- Far terrain ---
+//     - Whenever the player moves to another chunk, push the positions of the columns of chunks which lie beyond the
+//     full detail distance but within the far distance onto the far terrain queue, the closest ones first. Far terrain
+//     columns which are out of that range are released like unloaded chunks: their entities are reset and pooled, up to
+//     a limit, and only the ones which don't fit are destroyed.
+//     - Go through far terrain requests and process them if the number of running far terrain tasks is less than N and
+//     if not all load chunk task slots are in use, as loading the chunks around the player takes priority. Take an
+//     entity for the column out of the pool or create a new one (named like chunk entities, not after its position),
+//     and run a task which generates the column's surface mesh straight from the world
+//     generator's height noise, without ever generating any chunk data.
+//     - Go through far terrain tasks and if the result is ready, update the corresponding column's mesh.
+//
+// 9. --- Cull chunks ---
+//     - Test the bounds of every chunk and far terrain column which has a mesh against the player camera's frustum.
+//     - Walk through the chunks starting with the player's chunk to find the ones which are potentially visible, using
+//     the visibility of each chunk (which pairs of its faces are connected through air, computed along with its mesh).
+//     Chunks hidden underground or behind hills are never reached.
+//     - Only the chunks which pass both tests (and far terrain columns which pass the first one) get a mesh renderer
+//     component, so the renderer never sees the other ones.
+//     - Chunks whose mesh was evicted (see step 10) and which pass both tests are pushed onto the update queue. Chunks
+//     whose data was evicted are loaded again once the bounds of their last mesh pass both tests, or once the player
+//     comes next to them.
 //
-// 6. --- Get update chunk results ---
-//     - Go through first N update chunk tasks and if the result is ready, update the corresponding chunk's mesh
-//     renderer component with the generated mesh (This always has to be done on the main thread).
+// 10. --- Enforce memory budget ---
+//     - The memory used by chunk data, meshes, caches and running tasks is a hard ceiling. The tasks are counted by
+//     what they hold: the snapshot of an update task's neighborhood and the mesh it's going to return, the data of the
+//     chunks a load task generates and the mesh of a far terrain column.
+//     - If it's exceeded, drop the meshes of the chunks which aren't visible, starting with the ones which haven't been
+//     visible for the longest time and the furthest ones among them. Their data is kept.
+//     - If that's not enough, drop the data of whole chunks in the same order, unloading them right away. Only the
+//     chunks next to the player, which the player collides with and edits, and the chunks which haven't been meshed
+//     yet are kept. The evicted chunks aren't requested again until culling lets them back in (see step 9).
+//     - No load, update or far terrain tasks are launched while the budget is still exceeded.
+//     - If chunks which were visible had to be evicted, the view doesn't fit: lower the distance the chunks are loaded
+//     at by one ring of columns. Far terrain fills the ring which was given up.
+//     - Once everything is loaded and there's room for another ring of chunks within the budget, raise the distance by
+//     one ring again, up to the requested distance.
 
 class WorldManager : public zth::Script
 {
@@ -61,12 +145,78 @@ public:
     // @todo: Add player to debug menu.
     zth::ConstEntityHandle player;
     i32 distance = 4;
+    i32 vertical_distance = 4;
+    // Chunks which are at most this many chunks above or below the terrain's surface are loaded within distance of the
+    // player as well, however high above or deep below it the player is.
+    i32 surface_distance = 1;
 
     usize max_load_chunk_tasks = std::max(std::thread::hardware_concurrency() * 2u, 4u);
     usize max_update_chunk_tasks = max_load_chunk_tasks;
 
-    usize max_chunks_loaded_each_frame = max_load_chunk_tasks;
-    usize max_chunks_updated_each_frame = max_update_chunk_tasks;
+    // Chunks in the same region of load_region_size by load_region_size columns which are requested at the same time
+    // are loaded by a single task, which evaluates the terrain's heights only once for all of them.
+    i32 load_region_size = 4;
+    usize max_chunks_per_load_task = 64;
+
+    // If set, chunks are read from this store of pre-generated chunks (see src/tools/pregen.cpp) and only the chunks
+    // which aren't there are generated.
+    std::shared_ptr<const ChunkStore> chunk_store = nullptr;
+
+    // Chunks are prefetched along the player's motion: the chunks around the position the player is going to reach in
+    // prefetch_lookahead seconds are loaded as well, and the chunks ahead of the player are loaded first.
+    bool prefetch_enabled = true;
+    float prefetch_lookahead = 1.5f;
+
+    // Results of the tasks are integrated on the main thread (installing chunk data, uploading meshes) for at most this
+    // many microseconds each frame. The cost of every result is predicted from the costs of the previous ones.
+    i32 integration_budget_us = 2000;
+
+    // Chunks which are further away than lod_distances[i] are meshed at level of detail i + 1.
+    bool lod_enabled = true;
+    std::array<i32, max_lod> lod_distances = { 2, 3, 4 };
+
+    // Columns of chunks which are further away than distance, but not further than far_distance, are rendered only as
+    // the surface of the terrain, made out of cells of 2^far_terrain_lod blocks.
+    bool far_terrain_enabled = true;
+    i32 far_distance = 24;
+    i32 far_terrain_lod = 2;
+
+    usize max_far_terrain_tasks = std::max(std::thread::hardware_concurrency() / 2u, 1u);
+
+    bool frustum_culling_enabled = true;
+    bool occlusion_culling_enabled = true;
+
+    // Gameplay block updates (see ticks.hpp) run at a fixed rate. At most max_ticks_per_frame ticks are run in a single
+    // frame, the ones which don't fit are dropped.
+    bool ticks_enabled = true;
+    i32 ticks_per_second = 20;
+    i32 max_ticks_per_frame = 4;
+
+    // Unloaded chunk entities are kept for reuse, so that moving around doesn't keep creating and destroying entities.
+    usize max_pooled_chunk_entities = 512;
+    usize max_pooled_far_terrain_entities = 256;
+
+    // Hard limit on the memory used by the chunks instead of just their distance, see step 10 above. The default
+    // distances need far less than that, so the budget only steps in when they're raised.
+    bool memory_budget_enabled = true;
+    i32 memory_budget_mb = 1024;
+
+    // In bytes.
+    struct MemoryUsage
+    {
+        usize chunk_data = 0;
+        usize chunk_meshes = 0;
+        usize far_terrain_meshes = 0;
+        // Decoration waiting for the neighbors to load and results waiting for being integrated.
+        usize caches = 0;
+        // Estimated, see step 10 above.
+        usize tasks = 0;
+
+        [[nodiscard]] auto total() const -> usize
+        {
+            return chunk_data + chunk_meshes + far_terrain_meshes + caches + tasks;
+        }
+    };
 
 public:
     explicit WorldManager() = default;
@@ -76,63 +226,282 @@ public:
 
     auto on_update(zth::EntityHandle actor) -> void override;
 
+    // Returns true if there are no pending requests and no running tasks, so everything around the player is loaded.
+    [[nodiscard]] auto idle() const -> bool;
+    [[nodiscard]] auto memory_usage() const -> MemoryUsage;
+
+    // Changes a block of a loaded chunk, relights its surroundings and remeshes the chunks whose look changed, ahead of
+    // any other chunks. Returns false if the block's chunk isn't loaded.
+    auto set_block(glm::ivec3 block_position, BlockType block) -> bool;
+
+    // Casts rays through the loaded chunks, see raycast.hpp. Chunks which aren't loaded yet are treated as air.
+    [[nodiscard]] auto raycast(const Ray& ray) const -> Optional<RaycastHit>;
+    [[nodiscard]] auto raycast(std::span<const Ray> rays) const -> zth::Vector<Optional<RaycastHit>>;
+
+    // Looks the chunks up in the world manager's map. Calling the lookup is safe from several threads at once, but only
+    // while no chunks are being loaded or unloaded, i.e. not concurrently with the world manager's update.
+    [[nodiscard]] auto get_chunk_lookup() const -> ChunkLookup;
+
+    auto clear_world() -> void;
+
 private:
     zth::Scene* _scene = nullptr;
-    zth::UnorderedMap<glm::ivec2, zth::EntityHandle> _chunk_map;
+    zth::UnorderedMap<glm::ivec3, zth::EntityHandle> _chunk_map;
+    zth::Vector<zth::EntityHandle> _chunk_entity_pool; // Reset, without a mesh renderer component.
+
+    Optional<glm::ivec3> _last_player_chunk = nil;
+
+    // How much further away chunks behind the player seem when prioritizing the load requests, per chunk of distance.
+    static constexpr float prefetch_behind_penalty = 1.0f;
+    // How much closer (in chunks) chunks right in front of the camera seem.
+    static constexpr float prefetch_look_bias = 1.5f;
+    // Weight of the newest measurement in the smoothed velocity.
+    static constexpr float velocity_smoothing = 0.2f;
+
+    Optional<glm::vec3> _last_player_position = nil;
+    glm::vec3 _player_velocity{ 0.0f }; // In blocks per second.
+
+    // Everything the order of the load requests depends on.
+    struct LoadOrigin
+    {
+        glm::ivec3 player_chunk;
+        glm::ivec3 predicted_player_chunk;
+        glm::ivec3 look_octant;
+        i32 distance;
+        i32 vertical_distance;
+        i32 surface_distance;
 
-    zth::Deque<glm::ivec2> _unload_chunk_requests;
+        auto operator==(const LoadOrigin&) const -> bool = default;
+    };
 
-    zth::Deque<glm::ivec2> _load_chunk_requests;
-    zth::Deque<std::future<std::pair<glm::ivec2, std::shared_ptr<ChunkData>>>> _load_chunk_tasks;
+    Optional<LoadOrigin> _last_load_origin = nil;
+    // Set whenever a chunk is unloaded or an evicted chunk is let back in. The chunk may be within the load distance
+    // (when the memory budget drops its data, for example), so the load requests have to be rebuilt even if the origin
+    // stays the same.
+    bool _chunks_unloaded = false;
+    zth::Vector<std::pair<float, glm::ivec3>> _load_candidates; // Reused whenever the load requests are rebuilt.
 
-    zth::Deque<glm::ivec2> _update_chunk_requests;
-    zth::Deque<std::future<std::pair<zth::EntityHandle, zth::Vector<zth::StandardVertex>>>> _update_chunk_tasks;
+    // The lowest (x) and highest (y) chunk which the terrain's surface passes through, by the column of chunks. Filled
+    // whenever the load requests are rebuilt and dropped once the column is out of the load distance.
+    zth::UnorderedMap<glm::ivec2, glm::ivec2> _surface_chunks;
+
+    zth::Deque<glm::ivec3> _unload_chunk_requests;
+
+    zth::Deque<glm::ivec3> _load_chunk_requests;
+
+    struct LoadedChunk
+    {
+        glm::ivec3 position;
+        std::shared_ptr<ChunkData> data;
+        zth::Vector<BlockWrite> decoration; // Blocks of the chunk's features which fall into its neighbors.
+    };
+
+    zth::Deque<std::future<zth::Vector<LoadedChunk>>> _load_chunk_tasks;
+    usize _loading_chunk_count = 0; // Chunks loaded by the running tasks.
+    zth::Deque<LoadedChunk> _load_chunk_results; // Waiting for being installed.
+
+    // Blocks of the loaded chunks' features which fall into their neighbors, by the chunk whose features they are.
+    // They're kept for as long as the chunk is loaded, so its features are completed whenever a neighbor gets loaded,
+    // even if the neighbor was unloaded in the meantime.
+    zth::UnorderedMap<glm::ivec3, zth::Vector<BlockWrite>> _decoration_writes;
+
+    struct LoadRegion
+    {
+        glm::ivec2 position;
+        zth::Vector<glm::ivec3> chunk_positions;
+    };
+
+    struct UpdateChunkResult
+    {
+        zth::EntityHandle chunk_entity;
+        u32 chunk_generation;
+        zth::Vector<BlockVertex> mesh;
+        Aabb bounds; // In chunk space.
+        ChunkVisibility visibility;
+        usize lod;
+    };
+
+    zth::Deque<glm::ivec3> _update_chunk_requests;
+    zth::Deque<std::future<UpdateChunkResult>> _update_chunk_tasks;
+    zth::Deque<UpdateChunkResult> _update_chunk_results; // Waiting for the upload.
+
+    struct FarTerrainResult
+    {
+        zth::EntityHandle column_entity;
+        u32 column_generation;
+        zth::Vector<BlockVertex> mesh;
+        Aabb bounds; // In column space.
+    };
+
+    zth::UnorderedMap<glm::ivec2, zth::EntityHandle> _far_terrain_map;
+    zth::Vector<zth::EntityHandle> _far_terrain_entity_pool; // Reset, without a mesh renderer component.
+    zth::Deque<glm::ivec2> _far_terrain_requests;
+    zth::Deque<std::future<FarTerrainResult>> _far_terrain_tasks;
+
+    // Lights the chunks as they get installed and whenever a block changes.
+    LightPropagator _light_propagator{ [this](glm::ivec3 chunk_position) { return get_chunk_data(chunk_position); } };
+
+    // Runs the gameplay block updates, which change the blocks through modify_block.
+    TickScheduler _tick_scheduler{ get_chunk_lookup(), [this](glm::ivec3 block_position, BlockType block) {
+        return modify_block(block_position, block);
+    } };
+    // Moves the fluids at every few ticks, through modify_blocks.
+    FluidSimulation _fluid_simulation{ get_chunk_lookup(),
+                                       [this](glm::ivec3 chunk_position, std::span<const BlockWrite> writes) {
+                                           return modify_blocks(chunk_position, writes);
+                                       } };
+    float _time_since_tick = 0.0f; // In seconds.
+
+    // Chunks whose blocks or light were changed since they were last requested to be updated. Collected so that a whole
+    // tick's worth of changes is requested at once, with every chunk requested only once.
+    zth::Vector<glm::ivec3> _modified_chunks;
+    // Reused by modify_blocks.
+    zth::Vector<glm::ivec3> _written_blocks;
+
+    // Measured costs of integrating the results. Meshes are measured by their number of vertices.
+    CostModel _load_cost{ std::chrono::microseconds{ 20 } };
+    CostModel _upload_cost{ std::chrono::microseconds{ 200 } };
+    CostModel _far_terrain_upload_cost{ std::chrono::microseconds{ 200 } };
+
+    // Reused every frame by the culling pass. Chunks which pass it are marked with the number of the frame.
+    zth::Vector<zth::EntityHandle> _culled_chunks;
+    zth::Vector<Aabb> _culled_chunk_bounds;
+    zth::Vector<u8> _culled_chunk_visibility;
+    usize _visible_chunk_count = 0;
+    OcclusionCuller _occlusion_culler;
+    u64 _frame = 0;
+
+    // Chunks further away than this aren't loaded, so that they fit into the memory budget.
+    i32 _memory_limited_distance = std::numeric_limits<i32>::max();
+
+    struct EvictionCandidate
+    {
+        u64 last_visible_frame;
+        i32 distance;
+        zth::EntityHandle chunk_entity;
+    };
+
+    zth::Vector<EvictionCandidate> _eviction_candidates; // Reused whenever meshes or data are evicted.
+
+    // Chunks whose data was evicted, with the bounds of their mesh if they had one. They aren't requested to be loaded
+    // while they're in here.
+    zth::UnorderedMap<glm::ivec3, Optional<Aabb>> _evicted_chunks;
+    // Set while the memory budget is exceeded even after evicting all it could, so that no tasks are launched.
+    bool _over_memory_budget = false;
+
+    // Block which the debug UI places in front of the block the player looks at.
+    i32 _placed_block = std::to_underlying(BlockType::Water);
 
     // @todo: Should world manager manage these resources?
     // @todo: Add these to debug menu.
     std::shared_ptr<zth::gl::Texture2D> _blocks_texture;
+    std::shared_ptr<zth::gl::Shader> _block_shader;
     std::shared_ptr<zth::Material> _chunk_material;
 
 private:
     auto on_attach(zth::EntityHandle actor) -> void override;
     auto on_detach(zth::EntityHandle actor) -> void override;
 
-    [[nodiscard]] auto get_chunk(glm::ivec2 chunk_position) -> Optional<zth::EntityHandle>;
-    [[nodiscard]] auto get_chunk(glm::ivec2 chunk_position) const -> Optional<zth::ConstEntityHandle>;
+    [[nodiscard]] auto get_chunk(glm::ivec3 chunk_position) -> Optional<zth::EntityHandle>;
+    [[nodiscard]] auto get_chunk(glm::ivec3 chunk_position) const -> Optional<zth::ConstEntityHandle>;
+    // Returns nullptr if the chunk isn't loaded or its data isn't installed yet.
+    [[nodiscard]] auto get_chunk_data(glm::ivec3 chunk_position) -> ChunkData*;
+    auto request_to_update_chunks_with_changed_light(glm::ivec3 chunk_position) -> void;
+    // Like set_block, but only marks the chunks which need to be updated as modified. Reports the change to the tick
+    // scheduler and the fluid simulation.
+    auto modify_block(glm::ivec3 block_position, BlockType block) -> bool;
+    // Like modify_block for several blocks of a single chunk, but only changes the blocks which the writes apply to
+    // (see BlockWrite). The changed blocks are relit together once they're all written.
+    auto modify_blocks(glm::ivec3 chunk_position, std::span<const BlockWrite> writes) -> bool;
+    // Writes the block without relighting it and returns whether it changed.
+    auto write_block(ChunkData& chunk_data, glm::ivec3 chunk_position, glm::ivec3 coordinates, BlockType block) -> bool;
+    // Marks the chunks whose light changed as modified.
+    auto mark_relit_chunks() -> void;
+    auto mark_chunk_modified(glm::ivec3 chunk_position) -> void;
+    auto request_to_update_modified_chunks() -> void;
 
-    auto request_to_load_chunks_around_player(glm::ivec2 player_chunk) -> void;
-    auto request_to_unload_chunks_too_far_away_from_player(glm::ivec2 player_chunk) -> void;
+    auto request_to_load_chunks_around_player(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk) -> void;
+    auto request_to_unload_chunks_too_far_away_from_player(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk)
+        -> void;
+    auto update_player_velocity() -> void;
+    // Caches the surface chunks of the columns within the load distance which aren't cached yet.
+    auto cache_surface_chunks(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk) -> void;
 
-    auto request_to_load_chunk(glm::ivec2 chunk_position) -> void;
-    auto request_to_load_chunk_with_priority(glm::ivec2 chunk_position) -> void;
-    auto launch_load_chunk_task(glm::ivec2 chunk_position) -> void;
-    [[nodiscard]] static auto load_chunk(glm::ivec2 chunk_position)
-        -> std::pair<glm::ivec2, std::shared_ptr<ChunkData>>;
-    [[nodiscard]] auto create_new_chunk_entity(glm::ivec2 chunk_position) -> zth::EntityHandle;
+    auto request_to_load_chunk(glm::ivec3 chunk_position) -> void;
+    auto request_to_load_chunk_with_priority(glm::ivec3 chunk_position) -> void;
+    auto launch_load_chunk_task(zth::Vector<glm::ivec3>&& chunk_positions) -> void;
+    [[nodiscard]] static auto load_chunks(const ChunkStore* store, std::span<const glm::ivec3> chunk_positions,
+                                          std::span<const BlockWrite> decoration_writes) -> zth::Vector<LoadedChunk>;
+    // Appends the blocks of the loaded chunks' features which fall into the chunk.
+    auto gather_decoration_writes(glm::ivec3 chunk_position, zth::Vector<BlockWrite>& writes) const -> void;
+    // Places the blocks which fall into loaded chunks through modify_blocks, one chunk at a time. Reorders the writes.
+    auto place_decoration_writes(zth::Vector<BlockWrite>& writes) -> void;
+    [[nodiscard]] auto get_load_region(glm::ivec3 chunk_position) const -> glm::ivec2;
+    // Takes an entity out of the pool if there's one.
+    [[nodiscard]] auto create_new_chunk_entity(glm::ivec3 chunk_position) -> zth::EntityHandle;
+    // Puts the entity into the pool, or destroys it if the pool is full.
+    auto release_chunk_entity(zth::EntityHandle chunk_entity) -> void;
     static auto update_chunk_entity_with_data(zth::EntityHandle chunk_entity, std::shared_ptr<ChunkData>&& chunk_data)
         -> void;
-    auto update_neighbor_arrays_on_chunk_loaded(zth::EntityHandle chunk_entity) -> void;
 
-    auto request_to_update_chunk(glm::ivec2 chunk_position) -> void;
-    auto request_to_update_chunk_with_priority(glm::ivec2 chunk_position) -> void;
-    auto request_to_update_neighbors(glm::ivec2 chunk_position) -> void;
-    auto request_to_update_neighbors_with_priority(glm::ivec2 chunk_position) -> void;
+    auto request_to_update_chunk(glm::ivec3 chunk_position) -> void;
+    auto request_to_update_chunk_with_priority(glm::ivec3 chunk_position) -> void;
+    auto request_to_update_neighbors(glm::ivec3 chunk_position) -> void;
     auto launch_update_chunk_task(zth::EntityHandle chunk_entity) -> void;
-    [[nodiscard]] static auto update_chunk(zth::EntityHandle chunk_entity, const ChunkData& chunk_data,
-                                           const NeighborsArray& neighbors)
-        -> std::pair<zth::EntityHandle, zth::Vector<zth::StandardVertex>>;
-    static auto update_chunk_entity(zth::EntityHandle chunk_entity, const zth::Vector<zth::StandardVertex>& chunk_mesh)
-        -> void;
+    [[nodiscard]] static auto update_chunk(zth::EntityHandle chunk_entity, u32 chunk_generation,
+                                           ChunkNeighborhood& neighborhood, usize lod,
+                                           const NeighborLodsArray& neighbor_lods) -> UpdateChunkResult;
+    auto update_chunk_entity(zth::EntityHandle chunk_entity, const zth::Vector<BlockVertex>& chunk_mesh,
+                             const Aabb& chunk_mesh_bounds, ChunkVisibility chunk_visibility, usize lod) -> void;
+    auto request_to_update_chunks_with_changed_lod(glm::ivec3 player_chunk) -> void;
 
-    auto request_to_unload_chunk(glm::ivec2 chunk_position) -> void;
-    auto unload_chunk(glm::ivec2 chunk_position) -> void;
+    auto request_far_terrain_around_player(glm::ivec3 player_chunk) -> void;
+    auto unload_far_terrain_out_of_range(glm::ivec3 player_chunk) -> void;
+    auto launch_load_far_terrain_task(zth::EntityHandle column_entity) -> void;
+    [[nodiscard]] static auto load_far_terrain(zth::EntityHandle column_entity, u32 column_generation,
+                                               glm::ivec2 column_position, i32 cell_size) -> FarTerrainResult;
+    // Takes an entity out of the pool if there's one.
+    [[nodiscard]] auto create_new_far_terrain_entity(glm::ivec2 column_position) -> zth::EntityHandle;
+    // Puts the entity into the pool, or destroys it if the pool is full.
+    auto release_far_terrain_entity(zth::EntityHandle column_entity) -> void;
+    static auto update_far_terrain_entity(zth::EntityHandle column_entity,
+                                          const zth::Vector<BlockVertex>& column_mesh,
+                                          const Aabb& column_mesh_bounds) -> void;
 
-    // Returns the coordinate of the chunk that the player is in.
-    [[nodiscard]] auto get_player_chunk() const -> glm::ivec2;
-    [[nodiscard]] static auto get_distance(glm::ivec2 chunk_a, glm::ivec2 chunk_b) -> i32;
-    [[nodiscard]] auto get_neighbors(glm::ivec2 chunk_position) const -> NeighborsArray;
+    auto cull_chunks() -> void;
+    auto enforce_memory_budget(glm::ivec3 player_chunk) -> void;
+    [[nodiscard]] auto get_far_terrain_usage_per_column(const MemoryUsage& usage) const -> usize;
+    auto set_memory_limited_distance(i32 limited_distance) -> void;
+    // Works with any component which has mesh and visible members.
+    template<typename Component> static auto set_mesh_visible(zth::EntityHandle entity, bool visible) -> void;
+    [[nodiscard]] auto get_chunk_visibility(glm::ivec3 player_chunk, glm::ivec3 chunk_position) const
+        -> Optional<ChunkVisibility>;
 
-    auto clear_world() -> void;
+    auto request_to_unload_chunk(glm::ivec3 chunk_position) -> void;
+    auto unload_chunk(glm::ivec3 chunk_position) -> void;
+
+    // Returns the coordinate of the chunk that the player is in.
+    [[nodiscard]] auto get_player_chunk() const -> glm::ivec3;
+    // Returns the coordinate of the chunk that the player is going to be in after prefetch_lookahead seconds.
+    [[nodiscard]] auto get_predicted_player_chunk(glm::ivec3 player_chunk) const -> glm::ivec3;
+    [[nodiscard]] auto get_player_look_direction() const -> glm::vec3;
+    [[nodiscard]] auto get_player_frustum() const -> Optional<Frustum>;
+    // Returns the horizontal distance between the chunks.
+    [[nodiscard]] static auto get_distance(glm::ivec3 chunk_a, glm::ivec3 chunk_b) -> i32;
+    [[nodiscard]] static auto get_vertical_distance(glm::ivec3 chunk_a, glm::ivec3 chunk_b) -> i32;
+    // Returns true if the chunks are the same or touch each other, even if only at a corner.
+    [[nodiscard]] static auto next_to(glm::ivec3 chunk_a, glm::ivec3 chunk_b) -> bool;
+    // Returns the distance the chunks are loaded at, which is lower than distance while the memory budget is exceeded.
+    [[nodiscard]] auto get_resident_distance() const -> i32;
+    // Returns false if the chunk's column isn't cached.
+    [[nodiscard]] auto within_surface_distance(glm::ivec3 chunk_position) const -> bool;
+    [[nodiscard]] auto within_distance(glm::ivec3 player_chunk, glm::ivec3 chunk_position) const -> bool;
+    // Chunks which are within distance of either the player or the position the player is heading to are loaded.
+    [[nodiscard]] auto within_load_distance(glm::ivec3 player_chunk, glm::ivec3 predicted_player_chunk,
+                                            glm::ivec3 chunk_position) const -> bool;
+    [[nodiscard]] auto within_far_distance(glm::ivec3 player_chunk, glm::ivec2 column_position) const -> bool;
+    [[nodiscard]] auto get_lod(glm::ivec3 player_chunk, glm::ivec3 chunk_position) const -> usize;
+    [[nodiscard]] auto get_neighbors(glm::ivec3 chunk_position) const -> NeighborsArray;
 };
 
 } // namespace scripts
@@ -0,0 +1,291 @@
+// Offline world pre-generation. Generates every chunk within a square around a center column and saves them into a
+// chunk store, so that the game can load them instead of generating them while the player flies around. Doubles as a
+// throughput benchmark of the generator (and of the mesher with --mesh), since it runs without a window or renderer.
+//
+// Usage: craftmine_pregen [--center X Z] [--radius R] [--min-y Y] [--max-y Y] [--seed S] [--threads N] [--out DIR]
+//                         [--mesh]
+// The center and the radius are in chunks.
+
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <future>
+#include <iostream>
+#include <thread>
+
+#include "world/chunk.hpp"
+#include "world/chunk_store.hpp"
+#include "world/generator.hpp"
+#include "world/lighting.hpp"
+
+namespace {
+
+struct Options
+{
+    glm::ivec2 center{ 0, 0 };
+    i32 radius = 32;
+    i32 min_y = 0;
+    i32 max_y = WorldGenerator::terrain_height / chunk_size.y - 1;
+    u32 seed = 0;
+    usize threads = std::max(std::thread::hardware_concurrency(), 1u);
+    std::filesystem::path out = "world";
+    bool mesh = false;
+};
+
+struct Counters
+{
+    std::atomic<usize> regions = 0;
+    std::atomic<usize> chunks = 0;
+    std::atomic<usize> bytes = 0;
+    std::atomic<usize> vertices = 0;
+    std::atomic<usize> failed_regions = 0;
+};
+
+template<typename T> [[nodiscard]] auto parse(std::string_view text) -> Optional<T>
+{
+    T value{};
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+
+    if (error != std::errc{} || end != text.data() + text.size())
+        return nil;
+
+    return value;
+}
+
+[[nodiscard]] auto parse_options(std::span<char*> arguments) -> Optional<Options>
+{
+    Options options;
+
+    for (usize i = 0; i < arguments.size(); i++)
+    {
+        std::string_view argument = arguments[i];
+
+        auto next = [&]() -> std::string_view {
+            if (i + 1 >= arguments.size())
+                return {};
+
+            return arguments[++i];
+        };
+
+        auto assign = [&]<typename T>(T& target) -> bool {
+            auto value = parse<T>(next());
+
+            if (!value)
+            {
+                std::cerr << std::format("Invalid value for {}.\n", argument);
+                return false;
+            }
+
+            target = *value;
+            return true;
+        };
+
+        auto ok = true;
+
+        if (argument == "--center")
+            ok = assign(options.center.x) && assign(options.center.y);
+        else if (argument == "--radius")
+            ok = assign(options.radius);
+        else if (argument == "--min-y")
+            ok = assign(options.min_y);
+        else if (argument == "--max-y")
+            ok = assign(options.max_y);
+        else if (argument == "--seed")
+            ok = assign(options.seed);
+        else if (argument == "--threads")
+            ok = assign(options.threads);
+        else if (argument == "--out")
+            options.out = next();
+        else if (argument == "--mesh")
+            options.mesh = true;
+        else
+        {
+            std::cerr << std::format("Unknown argument {}.\n", argument);
+            ok = false;
+        }
+
+        if (!ok)
+            return nil;
+    }
+
+    if (options.radius < 0 || options.min_y > options.max_y || options.threads == 0 || options.out.empty())
+    {
+        std::cerr << "Invalid options.\n";
+        return nil;
+    }
+
+    return options;
+}
+
+// Meshes the chunk with whatever neighbors were generated as part of the same region. Faces bordering chunks of other
+// regions are treated like faces bordering unloaded chunks.
+[[nodiscard]] auto mesh_chunk(std::span<const StoredChunk> region, usize index) -> usize
+{
+    auto find = [&](glm::ivec3 position) -> const ChunkData* {
+        auto it = std::ranges::find(region, position, &StoredChunk::position);
+        return it != region.end() ? it->data.get() : nullptr;
+    };
+
+    NeighborsArray neighbors{};
+
+    for (usize i = 0; i < apron_neighbor_count; i++)
+        neighbors[i] = find(region[index].position + apron_neighbor_offsets[i]);
+
+    auto neighborhood = std::make_unique_for_overwrite<ChunkNeighborhood>();
+    neighborhood->copy_borders(neighbors);
+    neighborhood->copy_chunk(*region[index].data);
+
+    return neighborhood->generate_mesh().size();
+}
+
+auto generate_region(const Options& options, const ChunkStore& store, glm::ivec2 region_position,
+                     Counters& counters) -> void
+{
+    // @multithreaded
+
+    auto first_column = region_position * ChunkStore::region_size;
+    auto min_column = glm::max(first_column, options.center - options.radius);
+    auto max_column = glm::min(first_column + ChunkStore::region_size - 1, options.center + options.radius);
+
+    auto columns = max_column - min_column + 1;
+    HeightMap heights{ { chunk_x_to_world_x(min_column.x), chunk_z_to_world_z(min_column.y) },
+                       columns * glm::ivec2{ chunk_size.x, chunk_size.z } };
+
+    zth::Vector<StoredChunk> chunks;
+    chunks.reserve(static_cast<usize>(columns.x * columns.y * (options.max_y - options.min_y + 1)));
+
+    for (auto x = min_column.x; x <= max_column.x; x++)
+    {
+        for (auto z = min_column.y; z <= max_column.y; z++)
+        {
+            for (auto y = options.min_y; y <= options.max_y; y++)
+            {
+                glm::ivec3 position{ x, y, z };
+                auto data = WorldGenerator::generate(position, heights);
+
+                if (options.mesh)
+                    light_chunk(*data, position, heights);
+
+                chunks.push_back(StoredChunk{ .position = position, .data = std::move(data) });
+            }
+        }
+    }
+
+    if (options.mesh)
+    {
+        usize vertices = 0;
+
+        for (usize i = 0; i < chunks.size(); i++)
+            vertices += mesh_chunk(chunks, i);
+
+        counters.vertices += vertices;
+    }
+
+    auto bytes = store.write_region(region_position, options.seed, chunks);
+
+    if (!bytes)
+    {
+        counters.failed_regions++;
+        return;
+    }
+
+    counters.bytes += *bytes;
+    counters.chunks += chunks.size();
+    counters.regions++;
+}
+
+[[nodiscard]] auto to_mib(usize bytes) -> double
+{
+    return static_cast<double>(bytes) / (1024.0 * 1024.0);
+}
+
+} // namespace
+
+auto main(int argc, char* argv[]) -> int
+{
+    auto options = parse_options(std::span{ argv, static_cast<usize>(argc) }.subspan(1));
+
+    if (!options)
+        return 1;
+
+    WorldGenerator::seed = options->seed;
+    ChunkStore store{ options->out };
+
+    // Every region which intersects the requested square.
+    auto min_region = ChunkStore::region_of(glm::ivec3{ options->center.x - options->radius, 0, //
+                                                         options->center.y - options->radius });
+    auto max_region = ChunkStore::region_of(glm::ivec3{ options->center.x + options->radius, 0, //
+                                                         options->center.y + options->radius });
+
+    zth::Vector<glm::ivec2> regions;
+
+    for (auto x = min_region.x; x <= max_region.x; x++)
+    {
+        for (auto z = min_region.y; z <= max_region.y; z++)
+            regions.emplace_back(x, z);
+    }
+
+    auto side = static_cast<usize>(options->radius) * 2 + 1;
+    auto total_chunks = side * side * static_cast<usize>(options->max_y - options->min_y + 1);
+
+    std::cout << std::format("Generating {} chunks in {} regions into {} using {} threads.\n", total_chunks,
+                             regions.size(), options->out.string(), options->threads);
+
+    Counters counters;
+    std::atomic<usize> next_region = 0;
+
+    // The regions are handed out one at a time, so the threads stay busy even if some regions take longer than others.
+    auto work = [&] {
+        for (auto i = next_region++; i < regions.size(); i = next_region++)
+            generate_region(*options, store, regions[i], counters);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    auto elapsed_seconds = [&] {
+        return std::chrono::duration<double>{ std::chrono::steady_clock::now() - start }.count();
+    };
+
+    zth::Vector<std::future<void>> workers;
+    workers.reserve(options->threads);
+
+    for (usize i = 0; i < options->threads; i++)
+        workers.push_back(std::async(std::launch::async, work));
+
+    for (auto& worker : workers)
+    {
+        while (worker.wait_for(std::chrono::seconds{ 1 }) != std::future_status::ready)
+        {
+            auto seconds = elapsed_seconds();
+            auto chunks = counters.chunks.load();
+            auto chunks_per_second = static_cast<double>(chunks) / seconds;
+            auto remaining = static_cast<double>(total_chunks - chunks) / std::max(chunks_per_second, 1.0);
+
+            std::cout << std::format("{}/{} regions, {}/{} chunks, {:.0f} chunks/s, {:.1f} MiB, ETA {:.0f} s\n",
+                                     counters.regions.load(), regions.size(), chunks, total_chunks, chunks_per_second,
+                                     to_mib(counters.bytes), remaining);
+        }
+
+        worker.get();
+    }
+
+    auto seconds = elapsed_seconds();
+    auto chunks = counters.chunks.load();
+
+    std::cout << std::format("Generated {} chunks in {:.2f} s ({:.0f} chunks/s, {:.2f} ms per chunk per thread).\n",
+                             chunks, seconds, static_cast<double>(chunks) / seconds,
+                             seconds * 1000.0 * static_cast<double>(options->threads)
+                                 / static_cast<double>(std::max<usize>(chunks, 1)));
+    std::cout << std::format("Wrote {:.2f} MiB ({:.0f} bytes per chunk).\n", to_mib(counters.bytes),
+                             static_cast<double>(counters.bytes) / static_cast<double>(std::max<usize>(chunks, 1)));
+
+    if (options->mesh)
+        std::cout << std::format("Meshed {} vertices.\n", counters.vertices.load());
+
+    if (counters.failed_regions > 0)
+    {
+        std::cerr << std::format("Failed to write {} regions.\n", counters.failed_regions.load());
+        return 1;
+    }
+
+    return 0;
+}
@@ -6,6 +6,13 @@ enum class BlockType : u8
     Grass,
     Dirt,
     Stone,
+    Water,
+    Lava,
+    Log,
+    Leaves,
+    CoalOre,
+    IronOre,
+    Sand,
 };
 
 // This is a bitmask type.
@@ -34,3 +41,146 @@ constexpr auto operator&=(BlockFacing& lhs, BlockFacing rhs) -> BlockFacing& { r
     constexpr auto side_faces = Facing_Backward | Facing_Forward | Facing_Left | Facing_Right;
     return facing & side_faces;
 }
+
+constexpr inline usize face_count = 6;
+
+// Direction a single face points in, zero for none.
+[[nodiscard]] constexpr auto face_normal(BlockFacing facing) -> glm::ivec3
+{
+    switch (facing)
+    {
+    case Facing_Backward:
+        return { 0, 0, 1 };
+    case Facing_Forward:
+        return { 0, 0, -1 };
+    case Facing_Left:
+        return { -1, 0, 0 };
+    case Facing_Right:
+        return { 1, 0, 0 };
+    case Facing_Down:
+        return { 0, -1, 0 };
+    case Facing_Up:
+        return { 0, 1, 0 };
+    default:
+        return { 0, 0, 0 };
+    }
+}
+
+// Index of a single face, in the order of the faces' bits.
+[[nodiscard]] constexpr auto face_index(BlockFacing facing) -> usize
+{
+    return static_cast<usize>(std::countr_zero(std::to_underlying(facing)));
+}
+
+struct BlockProperties
+{
+    std::string_view name;
+    // Tile of the blocks texture atlas on every face, indexed by face_index.
+    std::array<u8, face_count> tiles{};
+    // Opaque blocks hide the faces of the blocks next to them and stop light. Faces between two transparent blocks of
+    // the same type are hidden as well.
+    bool opaque = true;
+    // Solid blocks stop the player and rays. Fluids can be walked and seen through.
+    bool solid = true;
+    bool fluid = false;
+    // Gets random ticks, see ticks.hpp.
+    bool randomly_ticked = false;
+    // Falls down whenever there's air below it, see ticks.hpp.
+    bool falls = false;
+    // Level of block light which the block emits, see light.hpp.
+    u8 light_emission = 0;
+};
+
+[[nodiscard]] constexpr auto all_faces(u8 tile) -> std::array<u8, face_count>
+{
+    return { tile, tile, tile, tile, tile, tile };
+}
+
+[[nodiscard]] constexpr auto sides_and_ends(u8 side_tile, u8 end_tile) -> std::array<u8, face_count>
+{
+    return { side_tile, side_tile, side_tile, side_tile, end_tile, end_tile };
+}
+
+// Every block type's properties, indexed by the block type. The mesher's lookup tables are built out of this at compile
+// time, so a new block only needs an entry here and its tiles in the atlas.
+constexpr inline std::array block_registry = {
+    BlockProperties{ .name = "Air", .opaque = false, .solid = false },
+    BlockProperties{ .name = "Grass", .tiles = sides_and_ends(1, 2), .randomly_ticked = true },
+    BlockProperties{ .name = "Dirt", .tiles = all_faces(3) },
+    BlockProperties{ .name = "Stone", .tiles = all_faces(0) },
+    BlockProperties{ .name = "Water", .tiles = all_faces(4), .opaque = false, .solid = false, .fluid = true },
+    BlockProperties{ .name = "Lava", .tiles = all_faces(5), .solid = false, .fluid = true, .light_emission = 15 },
+    BlockProperties{ .name = "Log", .tiles = sides_and_ends(6, 7) },
+    BlockProperties{ .name = "Leaves", .tiles = all_faces(8), .opaque = false },
+    BlockProperties{ .name = "Coal ore", .tiles = all_faces(9) },
+    BlockProperties{ .name = "Iron ore", .tiles = all_faces(10) },
+    BlockProperties{ .name = "Sand", .tiles = all_faces(11), .falls = true },
+};
+
+static_assert(block_registry.size() == std::to_underlying(BlockType::Sand) + 1uz,
+              "Every block type needs an entry in the registry.");
+
+[[nodiscard]] constexpr auto block_properties(BlockType block) -> const BlockProperties&
+{
+    return block_registry[std::to_underlying(block)];
+}
+
+[[nodiscard]] constexpr auto is_opaque(BlockType block) -> bool
+{
+    return block_properties(block).opaque;
+}
+
+[[nodiscard]] constexpr auto is_solid(BlockType block) -> bool
+{
+    return block_properties(block).solid;
+}
+
+[[nodiscard]] constexpr auto is_fluid(BlockType block) -> bool
+{
+    return block_properties(block).fluid;
+}
+
+[[nodiscard]] constexpr auto falls(BlockType block) -> bool
+{
+    return block_properties(block).falls;
+}
+
+[[nodiscard]] constexpr auto light_emission(BlockType block) -> u8
+{
+    return block_properties(block).light_emission;
+}
+
+// Blocks which features place over other blocks, together with the block they're placed over. Where features overlap,
+// the block which comes later in the list wins.
+constexpr inline std::array<std::pair<BlockType, BlockType>, 4> feature_blocks = { {
+    { BlockType::Leaves, BlockType::Air },
+    { BlockType::Log, BlockType::Air },
+    { BlockType::CoalOre, BlockType::Stone },
+    { BlockType::IronOre, BlockType::Stone },
+} };
+
+// A block to place in world space. It's only placed over the block it replaces, so that features never cut into the
+// terrain and placing a feature again changes nothing, and so that a change which was worked out from an outdated
+// block isn't applied.
+struct BlockWrite
+{
+    glm::ivec3 position{ 0, 0, 0 };
+    BlockType block = BlockType::Air;
+    BlockType replaces = BlockType::Air;
+
+    // Returns true if the write changes the block. Features are placed in whatever order their chunks load, so where
+    // two of them overlap, a write also goes over the blocks placed by the other feature which rank lower in
+    // feature_blocks (and replaced the same block). The same blocks come out in every order.
+    [[nodiscard]] constexpr auto applies_to(BlockType current) const -> bool
+    {
+        if (current == block)
+            return false;
+
+        if (current == replaces)
+            return true;
+
+        auto current_rank = std::ranges::find(feature_blocks, std::pair{ current, replaces });
+        auto rank = std::ranges::find(feature_blocks, std::pair{ block, replaces });
+        return current_rank != feature_blocks.end() && rank != feature_blocks.end() && current_rank < rank;
+    }
+};
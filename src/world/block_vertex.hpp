@@ -0,0 +1,21 @@
+#pragma once
+
+// Vertex of the chunk and far terrain meshes. Zenith's standard vertex has no attribute for the light, so the meshes
+// use their own vertex type together with their own shader (see assets/shaders/block.vert and block.frag), which
+// multiplies the whole lighting of the vertex by its brightness. The normals stay unit length.
+struct BlockVertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 uv;
+    // Light level combined with ambient occlusion, from 0 (black) to 1 (full light).
+    float brightness;
+};
+
+using BlockMesh = zth::QuadMesh<BlockVertex>;
+
+template<> inline auto zth::gl::VertexLayout::derive_from_vertex<BlockVertex>() -> zth::gl::VertexLayout
+{
+    using enum zth::gl::VertexLayoutElement;
+    return zth::gl::VertexLayout{ Float3, Float3, Float2, Float1 };
+}
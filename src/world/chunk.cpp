@@ -76,408 +76,710 @@ constexpr Face up_face = {
 
 constexpr TextureAtlas blocks_texture_atlas{ 4, 4 };
 
-[[nodiscard]] auto get_block_texture_index(BlockType block, BlockFacing facing) -> usize
-{
-    switch (block)
-    {
-        using enum BlockType;
-    case Grass:
-        if (is_side_facing(facing))
-            return 1;
-        return 2;
-    case Dirt:
-        return 3;
-    case Stone:
-        return 0;
-    }
+static_assert(
+    [] {
+        for (const auto& properties : block_registry)
+        {
+            for (auto tile : properties.tiles)
+            {
+                if (tile >= blocks_texture_atlas.tile_count())
+                    return false;
+            }
+        }
 
-    ZTH_ASSERT(false);
-    std::unreachable();
-}
+        return true;
+    }(),
+    "Every tile of the block registry has to lie within the blocks texture atlas.");
 
-[[nodiscard]] auto get_face(BlockFacing facing) -> const Face&
-{
-    switch (facing)
+// Indexed with face_index.
+constexpr std::array faces = { backward_face, forward_face, left_face, right_face, down_face, up_face };
+
+// Indexed with the type of a block and then with face_index, so meshing a face is just a lookup.
+constexpr auto block_face_texture_coordinates = [] {
+    std::array<std::array<QuadTextureCoordinates, face_count>, block_registry.size()> result{};
+
+    for (usize block = 0; block < block_registry.size(); block++)
     {
-    case Facing_Backward:
-        return backward_face;
-    case Facing_Forward:
-        return forward_face;
-    case Facing_Left:
-        return left_face;
-    case Facing_Right:
-        return right_face;
-    case Facing_Down:
-        return down_face;
-    case Facing_Up:
-        return up_face;
+        for (usize face = 0; face < face_count; face++)
+            result[block][face] = blocks_texture_atlas[block_registry[block].tiles[face]];
     }
 
-    ZTH_ASSERT(false);
-    std::unreachable();
-}
+    return result;
+}();
 
-auto append_single_face_vertices(zth::Vector<zth::StandardVertex>& vertices, BlockType block, BlockFacing facing,
-                                 glm::ivec3 coordinates) -> void
-{
-    auto tex_coords = blocks_texture_atlas[get_block_texture_index(block, facing)];
-    auto& face = get_face(facing);
+// Indexed with the type of a block and then with the type of its neighbor, all bits are set if the neighbor leaves the
+// block's face exposed. Opaque neighbors hide the face and so do transparent neighbors of the same type, so that water
+// and leaves are only meshed along their surface. Faces bordering missing neighbors are treated as exposed.
+constexpr auto exposing_block_masks = [] {
+    std::array<std::array<u8, std::numeric_limits<u8>::max() + 1>, block_registry.size()> result{};
 
-    for (usize i = 0; i < zth::vertices_per_quad; i++)
+    for (usize block = 0; block < block_registry.size(); block++)
     {
-        vertices.push_back(zth::StandardVertex{
-            .position = face.vertices[i] + glm::vec3{ coordinates },
-            .normal = face.normal,
-            .uv = tex_coords[i],
-        });
-    }
-}
+        for (usize neighbor = 0; neighbor < block_registry.size(); neighbor++)
+        {
+            if (!block_registry[neighbor].opaque && neighbor != block)
+                result[block][neighbor] = std::numeric_limits<u8>::max();
+        }
 
-auto append_block_vertices(zth::Vector<zth::StandardVertex>& vertices, BlockType block, BlockFacing facing,
-                           glm::ivec3 coordinates) -> void
-{
-    if (block == BlockType::Air)
-        return;
+        result[block][std::to_underlying(missing_block)] = std::numeric_limits<u8>::max();
+    }
 
-    if (facing & Facing_Backward)
-        append_single_face_vertices(vertices, block, Facing_Backward, coordinates);
+    return result;
+}();
 
-    if (facing & Facing_Forward)
-        append_single_face_vertices(vertices, block, Facing_Forward, coordinates);
+// Indexed with the type of a block. Missing blocks aren't opaque.
+constexpr auto opaque_blocks = [] {
+    std::array<bool, std::numeric_limits<u8>::max() + 1> result{};
 
-    if (facing & Facing_Left)
-        append_single_face_vertices(vertices, block, Facing_Left, coordinates);
+    for (usize block = 0; block < block_registry.size(); block++)
+        result[block] = block_registry[block].opaque;
 
-    if (facing & Facing_Right)
-        append_single_face_vertices(vertices, block, Facing_Right, coordinates);
+    return result;
+}();
 
-    if (facing & Facing_Down)
-        append_single_face_vertices(vertices, block, Facing_Down, coordinates);
+// Distances between neighboring blocks in a chunk neighborhood's blocks array.
+constexpr auto padded_x_stride = static_cast<usize>(padded_chunk_size.y * padded_chunk_size.z);
+constexpr auto padded_y_stride = static_cast<usize>(padded_chunk_size.z);
 
-    if (facing & Facing_Up)
-        append_single_face_vertices(vertices, block, Facing_Up, coordinates);
-}
+// Blocks are laid out in x, y, z order in a padded volume, so the distance between neighbors along the z axis is always
+// 1.
+[[nodiscard]] auto visible_faces(const BlockType* blocks, usize index, usize x_stride, usize y_stride) -> BlockFacing
+{
+    constexpr usize z_stride = 1;
 
-} // namespace
+    const auto& exposing_block_mask = exposing_block_masks[std::to_underlying(blocks[index])];
 
-auto ChunkData::at(glm::ivec3 coordinates) -> Optional<Reference<BlockType>>
-{
-    if (!valid_coordinates(coordinates))
-        return nil;
+    auto exposed = [blocks, &exposing_block_mask](usize neighbor_index, BlockFacing facing) {
+        return exposing_block_mask[std::to_underlying(blocks[neighbor_index])] & facing;
+    };
 
-    return operator[](coordinates);
+    return static_cast<BlockFacing>(
+        exposed(index + z_stride, Facing_Backward) | exposed(index - z_stride, Facing_Forward)
+        | exposed(index - x_stride, Facing_Left) | exposed(index + x_stride, Facing_Right)
+        | exposed(index - y_stride, Facing_Down) | exposed(index + y_stride, Facing_Up));
 }
 
-auto ChunkData::at(glm::ivec3 coordinates) const -> Optional<Reference<const BlockType>>
+// Offsets within the padded volume of the blocks which shade the vertices of a face. They all lie in the layer of
+// blocks in front of the face: the block right in front of it, and for every vertex the two blocks beside the vertex
+// (along each edge of the face which ends in it), relative to the block in front.
+struct FaceShadingOffsets
 {
-    if (!valid_coordinates(coordinates))
-        return nil;
+    isize front;
+    std::array<std::array<isize, 2>, zth::vertices_per_quad> sides;
+};
 
-    return operator[](coordinates);
+[[nodiscard]] constexpr auto padded_offset(i32 x, i32 y, i32 z) -> isize
+{
+    return static_cast<isize>(x) * static_cast<isize>(padded_x_stride)
+           + static_cast<isize>(y) * static_cast<isize>(padded_y_stride) + static_cast<isize>(z);
 }
 
-auto ChunkData::at_exterior(glm::ivec3 coordinates, const NeighborsArray& neighbors) const
-    -> Optional<Reference<const BlockType>>
+[[nodiscard]] constexpr auto shading_offsets_of(const Face& face) -> FaceShadingOffsets
 {
-    auto [x, y, z] = coordinates;
+    auto normal = glm::ivec3{ static_cast<i32>(face.normal.x), static_cast<i32>(face.normal.y),
+                              static_cast<i32>(face.normal.z) };
 
-    if (x == -1)
+    FaceShadingOffsets result{};
+    result.front = padded_offset(normal.x, normal.y, normal.z);
+
+    for (usize i = 0; i < zth::vertices_per_quad; i++)
     {
-        if (!neighbors[minus_x_idx])
-            return nil;
+        auto vertex = face.vertices[i];
 
-        return neighbors[minus_x_idx]->operator[]({ chunk_size.x - 1, y, z });
-    }
+        // Every vertex lies on the far or the near side of the block along the two axes the face spans.
+        auto direction = [](float coordinate) { return coordinate > 0.5f ? 1 : -1; };
 
-    if (x == chunk_size.x)
-    {
-        if (!neighbors[plus_x_idx])
-            return nil;
+        auto side = 0uz;
 
-        return neighbors[plus_x_idx]->operator[]({ 0, y, z });
-    }
+        if (normal.x == 0)
+            result.sides[i][side++] = padded_offset(direction(vertex.x), 0, 0);
 
-    if (z == -1)
-    {
-        if (!neighbors[minus_z_idx])
-            return nil;
+        if (normal.y == 0)
+            result.sides[i][side++] = padded_offset(0, direction(vertex.y), 0);
 
-        return neighbors[minus_z_idx]->operator[]({ x, y, chunk_size.z - 1 });
+        if (normal.z == 0)
+            result.sides[i][side++] = padded_offset(0, 0, direction(vertex.z));
     }
 
-    if (z == chunk_size.z)
-    {
-        if (!neighbors[plus_z_idx])
-            return nil;
+    return result;
+}
 
-        return neighbors[plus_z_idx]->operator[]({ x, y, 0 });
-    }
+// Indexed with face_index.
+constexpr auto face_shading_offsets = [] {
+    std::array<FaceShadingOffsets, face_count> result{};
 
-    if (y == -1 || y == chunk_size.y)
-        return nil;
+    for (usize i = 0; i < face_count; i++)
+        result[i] = shading_offsets_of(faces[i]);
 
-    ZTH_ASSERT(valid_coordinates(coordinates));
-    return operator[](coordinates);
+    return result;
+}();
+
+// Distance within a padded volume's arrays from a block to the block in front of one of its faces.
+[[nodiscard]] auto front_offset(BlockFacing face, usize x_stride, usize y_stride) -> isize
+{
+    auto [x, y, z] = face_normal(face);
+    return static_cast<isize>(x) * static_cast<isize>(x_stride) + static_cast<isize>(y) * static_cast<isize>(y_stride)
+           + static_cast<isize>(z);
 }
 
-auto ChunkData::operator[](glm::ivec3 coordinates) -> BlockType&
+// Brightness of a vertex by how occluded it is, from fully (0) to not at all (3).
+constexpr std::array ambient_occlusion_brightness = { 0.5f, 0.65f, 0.8f, 1.0f };
+
+// A vertex is fully occluded if both blocks beside it are opaque, no matter the block in the corner between them.
+[[nodiscard]] constexpr auto ambient_occlusion(bool side_a, bool side_b, bool corner) -> usize
 {
-    ZTH_ASSERT(valid_coordinates(coordinates));
-    auto [x, y, z] = coordinates;
-    std::mdspan view{ _data.data(), chunk_size.x, chunk_size.y, chunk_size.z };
-    return view[x, y, z];
+    if (side_a && side_b)
+        return 0;
+
+    return 3uz - static_cast<usize>(side_a) - static_cast<usize>(side_b) - static_cast<usize>(corner);
 }
 
-auto ChunkData::operator[](glm::ivec3 coordinates) const -> const BlockType&
+// Every face is lit by the light of the block in front of it and every vertex of the face is darkened by the opaque
+// blocks around it in front of the face (ambient occlusion). Both only read the padded volume which the visible faces
+// were found in, the light is laid out like the blocks.
+auto append_lit_block_vertices(zth::Vector<BlockVertex>& vertices, BlockType block, BlockFacing facing,
+                               glm::ivec3 coordinates, const BlockType* blocks, const u8* light, usize index) -> void
 {
-    ZTH_ASSERT(valid_coordinates(coordinates));
-    auto [x, y, z] = coordinates;
-    std::mdspan view{ _data.data(), chunk_size.x, chunk_size.y, chunk_size.z };
-    return view[x, y, z];
+    auto position = glm::vec3{ coordinates };
+    auto size = glm::vec3{ 1.0f };
+
+    auto opaque = [blocks](isize block_index) { return opaque_blocks[std::to_underlying(blocks[block_index])]; };
+
+    auto append_face = [&](BlockFacing face) {
+        if (!(facing & face))
+            return;
+
+        const auto& offsets = face_shading_offsets[face_index(face)];
+        auto front = static_cast<isize>(index) + offsets.front;
+        auto face_brightness = light_brightness[light[front]];
+
+        std::array<float, zth::vertices_per_quad> brightness;
+
+        for (usize i = 0; i < zth::vertices_per_quad; i++)
+        {
+            auto [side_a, side_b] = offsets.sides[i];
+            auto occlusion = ambient_occlusion(opaque(front + side_a), opaque(front + side_b),
+                                               opaque(front + side_a + side_b));
+            brightness[i] = face_brightness * ambient_occlusion_brightness[occlusion];
+        }
+
+        append_box_face(vertices, block, face, position, size, brightness);
+    };
+
+    append_face(Facing_Backward);
+    append_face(Facing_Forward);
+    append_face(Facing_Left);
+    append_face(Facing_Right);
+    append_face(Facing_Down);
+    append_face(Facing_Up);
 }
 
-auto ChunkData::generate_mesh(const NeighborsArray& neighbors) const -> zth::Vector<zth::StandardVertex>
+// Used for the cells of downsampled chunks, which is why there's no ambient occlusion. Scale is the size of the cell.
+// Every face is lit by the light of the cell in front of it, the light is laid out like the cells.
+auto append_cell_vertices(zth::Vector<BlockVertex>& vertices, BlockType block, BlockFacing facing,
+                          glm::ivec3 coordinates, float scale, const u8* light, usize index, usize x_stride,
+                          usize y_stride) -> void
 {
-    // @multithreaded
+    auto position = glm::vec3{ coordinates } * scale;
+    auto size = glm::vec3{ scale };
+
+    auto append_face = [&](BlockFacing face) {
+        if (!(facing & face))
+            return;
+
+        auto front = static_cast<isize>(index) + front_offset(face, x_stride, y_stride);
+        append_box_face(vertices, block, face, position, size, light_brightness[light[front]]);
+    };
+
+    append_face(Facing_Backward);
+    append_face(Facing_Forward);
+    append_face(Facing_Left);
+    append_face(Facing_Right);
+    append_face(Facing_Down);
+    append_face(Facing_Up);
+}
 
-    zth::Vector<zth::StandardVertex> result;
-    // @speed: Check if reserving some space for the vertices here would be good.
+// Picks a single block to represent a cell of a downsampled chunk. The cell is solid if at least half of its blocks are
+// solid, and then it takes the type of its topmost solid block, so that the surface of the terrain keeps its look.
+[[nodiscard]] auto downsample_cell(const ChunkNeighborhood& neighborhood, glm::ivec3 cell_origin, i32 cell_size)
+    -> BlockType
+{
+    auto cell_volume = cell_size * cell_size * cell_size;
+    auto solid_count = 0;
+    auto top_block = BlockType::Air;
 
-    append_vertices_for_exterior_blocks(result, neighbors);
-    append_vertices_for_interior_blocks(result);
+    for (i32 y = cell_size - 1; y >= 0; y--)
+    {
+        for (i32 x = 0; x < cell_size; x++)
+        {
+            for (i32 z = 0; z < cell_size; z++)
+            {
+                auto block = neighborhood[cell_origin + glm::ivec3{ x, y, z }];
 
-    return result;
+                if (block == BlockType::Air)
+                    continue;
+
+                if (top_block == BlockType::Air)
+                    top_block = block;
+
+                solid_count++;
+            }
+        }
+    }
+
+    if (solid_count * 2 < cell_volume)
+        return BlockType::Air;
+
+    return top_block;
 }
 
-auto ChunkData::valid_coordinates(glm::ivec3 coordinates) -> bool
+// Division which rounds towards negative infinity, so that negative world coordinates map to negative chunk
+// coordinates.
+[[nodiscard]] auto floor_div(i32 dividend, i32 divisor) -> i32
 {
-    auto [x, y, z] = coordinates;
+    auto quotient = dividend / divisor;
 
-    auto valid_x = x >= 0 && x < chunk_size.x;
-    auto valid_y = y >= 0 && y < chunk_size.y;
-    auto valid_z = z >= 0 && z < chunk_size.z;
+    if (dividend % divisor != 0 && dividend < 0)
+        quotient--;
 
-    if (valid_x && valid_y && valid_z)
-        return true;
-
-    return false;
+    return quotient;
 }
 
-auto ChunkData::visible_faces_for_exterior_block(glm::ivec3 coordinates, const NeighborsArray& neighbors) const
-    -> BlockFacing
+// Returns the first and the last coordinate (inclusive) along one axis of the apron which borders the neighbor in the
+// given direction.
+[[nodiscard]] auto apron_range(i32 direction, i32 size) -> std::pair<i32, i32>
 {
-    ZTH_ASSERT(exterior_block_coordinates(coordinates));
-    auto [x, y, z] = coordinates;
-    auto facing = Facing_None;
+    if (direction > 0)
+        return { size, size };
 
-    auto backward = at_exterior({ x, y, z + 1 }, neighbors);
-    auto forward = at_exterior({ x, y, z - 1 }, neighbors);
-    auto left = at_exterior({ x - 1, y, z }, neighbors);
-    auto right = at_exterior({ x + 1, y, z }, neighbors);
-    auto down = at_exterior({ x, y - 1, z }, neighbors);
-    auto up = at_exterior({ x, y + 1, z }, neighbors);
+    if (direction < 0)
+        return { -1, -1 };
 
-    if (!backward || backward->get() == BlockType::Air)
-        facing |= Facing_Backward;
+    return { 0, size - 1 };
+}
 
-    if (!forward || forward->get() == BlockType::Air)
-        facing |= Facing_Forward;
+// Splits the apron which borders the neighbor in the given direction into squares of square_size by square_size
+// blocks, aligned to the chunk's grid, and calls the function with the first block and the size of every square.
+template<typename Function> auto for_each_apron_square(glm::ivec3 direction, i32 square_size, Function&& function)
+    -> void
+{
+    glm::ivec3 first{ 0 };
+    glm::ivec3 last = chunk_size - square_size;
+    glm::ivec3 size{ square_size };
 
-    if (!left || left->get() == BlockType::Air)
-        facing |= Facing_Left;
+    for (glm::length_t axis = 0; axis < 3; axis++)
+    {
+        if (direction[axis] == 0)
+            continue;
 
-    if (!right || right->get() == BlockType::Air)
-        facing |= Facing_Right;
+        first[axis] = direction[axis] > 0 ? chunk_size[axis] : -1;
+        last[axis] = first[axis];
+        size[axis] = 1;
+    }
 
-    if (!down || down->get() == BlockType::Air)
-        facing |= Facing_Down;
+    for (auto x = first.x; x <= last.x; x += size.x)
+    {
+        for (auto y = first.y; y <= last.y; y += size.y)
+        {
+            for (auto z = first.z; z <= last.z; z += size.z)
+                function(glm::ivec3{ x, y, z }, size);
+        }
+    }
+}
 
-    if (!up || up->get() == BlockType::Air)
-        facing |= Facing_Up;
+[[nodiscard]] auto opaque_region(const ChunkNeighborhood& neighborhood, glm::ivec3 first, glm::ivec3 size) -> bool
+{
+    for (auto x = first.x; x < first.x + size.x; x++)
+    {
+        for (auto y = first.y; y < first.y + size.y; y++)
+        {
+            for (auto z = first.z; z < first.z + size.z; z++)
+            {
+                if (!opaque_blocks[std::to_underlying(neighborhood[{ x, y, z }])])
+                    return false;
+            }
+        }
+    }
 
-    return facing;
+    return true;
 }
 
-auto ChunkData::visible_faces_for_interior_block(glm::ivec3 coordinates) const -> BlockFacing
+// Light of a region which is downsampled into a single cell: the strongest sky light and block light of any of its
+// blocks. Only transparent blocks hold light, so a cell takes the light of the open space within it.
+[[nodiscard]] auto region_light(const ChunkNeighborhood& neighborhood, glm::ivec3 first, glm::ivec3 size) -> u8
 {
-    ZTH_ASSERT(interior_block_coordinates(coordinates));
-    auto [x, y, z] = coordinates;
-    auto facing = Facing_None;
+    u8 sky = 0;
+    u8 block = 0;
 
-    auto backward = operator[]({ x, y, z + 1 });
-    auto forward = operator[]({ x, y, z - 1 });
-    auto left = operator[]({ x - 1, y, z });
-    auto right = operator[]({ x + 1, y, z });
-    auto down = operator[]({ x, y - 1, z });
-    auto up = operator[]({ x, y + 1, z });
+    for (auto x = first.x; x < first.x + size.x; x++)
+    {
+        for (auto y = first.y; y < first.y + size.y; y++)
+        {
+            for (auto z = first.z; z < first.z + size.z; z++)
+            {
+                auto light = neighborhood.light({ x, y, z });
+                sky = std::max(sky, sky_light(light));
+                block = std::max(block, block_light(light));
+            }
+        }
+    }
+
+    return pack_light(sky, block);
+}
 
-    if (backward == BlockType::Air)
-        facing |= Facing_Backward;
+} // namespace
+
+auto append_box_face(zth::Vector<BlockVertex>& vertices, BlockType block, BlockFacing facing,
+                     glm::vec3 position, glm::vec3 size, float brightness) -> void
+{
+    append_box_face(vertices, block, facing, position, size,
+                    std::array<float, zth::vertices_per_quad>{ brightness, brightness, brightness, brightness });
+}
 
-    if (forward == BlockType::Air)
-        facing |= Facing_Forward;
+auto append_box_face(zth::Vector<BlockVertex>& vertices, BlockType block, BlockFacing facing,
+                     glm::vec3 position, glm::vec3 size, const std::array<float, zth::vertices_per_quad>& brightness)
+    -> void
+{
+    ZTH_ASSERT(std::has_single_bit(std::to_underlying(facing)));
 
-    if (left == BlockType::Air)
-        facing |= Facing_Left;
+    const auto& tex_coords = block_face_texture_coordinates[std::to_underlying(block)][face_index(facing)];
+    const auto& face = faces[face_index(facing)];
 
-    if (right == BlockType::Air)
-        facing |= Facing_Right;
+    // Quads are split into triangles along the diagonal from their first to their third vertex. Starting the quad at
+    // the second vertex instead flips the diagonal, which is done whenever the other diagonal's ends are brighter, so
+    // that a dark corner shades only its own corner of the face instead of a stripe along the diagonal.
+    auto first = brightness[1] + brightness[3] > brightness[0] + brightness[2] ? 1uz : 0uz;
 
-    if (down == BlockType::Air)
-        facing |= Facing_Down;
+    for (usize i = 0; i < zth::vertices_per_quad; i++)
+    {
+        auto vertex = (first + i) % zth::vertices_per_quad;
 
-    if (up == BlockType::Air)
-        facing |= Facing_Up;
+        vertices.push_back(BlockVertex{
+            .position = face.vertices[vertex] * size + position,
+            .normal = face.normal,
+            .uv = tex_coords[vertex],
+            .brightness = brightness[vertex],
+        });
+    }
+}
 
-    return facing;
+auto ChunkNeighborhood::copy_borders(const NeighborsArray& neighbors) -> void
+{
+    // Every block of the apron lies in exactly one of the 26 directions around the chunk, so going through all of them
+    // writes the whole apron and nothing else. The edges and the corners are needed by the ambient occlusion of the
+    // blocks along the chunk's edges.
+    for (usize i = 0; i < apron_neighbor_count; i++)
+    {
+        auto direction = apron_neighbor_offsets[i];
+        auto neighbor = neighbors[i];
+
+        auto [first_x, last_x] = apron_range(direction.x, chunk_size.x);
+        auto [first_y, last_y] = apron_range(direction.y, chunk_size.y);
+        auto [first_z, last_z] = apron_range(direction.z, chunk_size.z);
+
+        auto xs = std::views::iota(first_x, last_x + 1);
+        auto ys = std::views::iota(first_y, last_y + 1);
+        auto zs = std::views::iota(first_z, last_z + 1);
+
+        for (const auto [x, y, z] : std::views::cartesian_product(xs, ys, zs))
+        {
+            glm::ivec3 coords{ x, y, z };
+
+            if (neighbor)
+            {
+                operator[](coords) = (*neighbor)[coords - direction * chunk_size];
+                light(coords) = neighbor->light(coords - direction * chunk_size);
+            }
+            else
+            {
+                operator[](coords) = missing_block;
+                light(coords) = full_light;
+            }
+        }
+    }
 }
 
-auto ChunkData::append_vertices_for_exterior_blocks(zth::Vector<zth::StandardVertex>& vertices,
-                                                    const NeighborsArray& neighbors) const -> void
+auto ChunkNeighborhood::copy_chunk(const ChunkData& chunk) -> void
 {
-    // Backward-facing wall (grasps parts of left, right, top and bottom walls as well).
-    // +z
+    // @multithreaded
+
+    // Rows along the z axis are contiguous in both arrays.
+    for (i32 x = 0; x < chunk_size.x; x++)
     {
-        constexpr auto xs = std::views::iota(0, chunk_size.x);
-        constexpr auto ys = std::views::iota(0, chunk_size.y);
-        constexpr auto zs = std::views::iota(chunk_size.z - 1, chunk_size.z);
-        constexpr auto wall = std::views::cartesian_product(xs, ys, zs);
-        append_vertices_for_wall(vertices, wall, neighbors);
+        for (i32 y = 0; y < chunk_size.y; y++)
+        {
+            std::ranges::copy_n(&chunk[{ x, y, 0 }], chunk_size.z, &operator[]({ x, y, 0 }));
+            std::ranges::copy_n(&chunk.light({ x, y, 0 }), chunk_size.z, &light({ x, y, 0 }));
+        }
     }
+}
 
-    // Forward-facing wall (grasps parts of left, right, top and bottom walls as well).
-    // -z
+auto ChunkNeighborhood::expose_lod_borders(usize lod, const NeighborLodsArray& neighbor_lods) -> void
+{
+    for (usize i = 0; i < neighbor_count; i++)
     {
-        constexpr auto xs = std::views::iota(0, chunk_size.x);
-        constexpr auto ys = std::views::iota(0, chunk_size.y);
-        constexpr auto zs = std::views::iota(0, 1);
-        constexpr auto wall = std::views::cartesian_product(xs, ys, zs);
-        append_vertices_for_wall(vertices, wall, neighbors);
+        // A square of the apron is only hidden behind the neighbor's mesh at both levels of detail if every block of
+        // it is opaque.
+        auto square_size = 1 << std::max(lod, neighbor_lods[i]);
+
+        if (square_size == 1)
+            continue;
+
+        for_each_apron_square(neighbor_offsets[i], square_size, [this](glm::ivec3 first, glm::ivec3 size) {
+            if (opaque_region(*this, first, size))
+                return;
+
+            // Lit like the square's cell in a downsampled mesh, so that the faces behind it match the neighbor's.
+            auto square_light = region_light(*this, first, size);
+
+            for (auto x = first.x; x < first.x + size.x; x++)
+            {
+                for (auto y = first.y; y < first.y + size.y; y++)
+                {
+                    for (auto z = first.z; z < first.z + size.z; z++)
+                    {
+                        operator[]({ x, y, z }) = missing_block;
+                        light({ x, y, z }) = square_light;
+                    }
+                }
+            }
+        });
     }
+}
+
+auto ChunkNeighborhood::operator[](glm::ivec3 coordinates) -> BlockType&
+{
+    return _data[index_of(coordinates)];
+}
+
+auto ChunkNeighborhood::operator[](glm::ivec3 coordinates) const -> const BlockType&
+{
+    return _data[index_of(coordinates)];
+}
+
+auto ChunkNeighborhood::light(glm::ivec3 coordinates) -> u8&
+{
+    return _light[index_of(coordinates)];
+}
 
-    // Left-facing wall (grasps parts of top and bottom walls as well).
-    // -x
+auto ChunkNeighborhood::light(glm::ivec3 coordinates) const -> const u8&
+{
+    return _light[index_of(coordinates)];
+}
+
+auto ChunkNeighborhood::generate_mesh() const -> zth::Vector<BlockVertex>
+{
+    // @multithreaded
+
+    zth::Vector<BlockVertex> result;
+    // @speed: Check if reserving some space for the vertices here would be good.
+
+    // The blocks on the chunk's borders don't need any special handling, their neighbors across the borders are in the
+    // apron.
+    for (i32 x = 0; x < chunk_size.x; x++)
     {
-        constexpr auto xs = std::views::iota(0, 1);
-        constexpr auto ys = std::views::iota(0, chunk_size.y);
-        constexpr auto zs = std::views::iota(1, chunk_size.z - 1);
-        constexpr auto wall = std::views::cartesian_product(xs, ys, zs);
-        append_vertices_for_wall(vertices, wall, neighbors);
+        for (i32 y = 0; y < chunk_size.y; y++)
+        {
+            auto row_index = index_of({ x, y, 0 });
+
+            for (i32 z = 0; z < chunk_size.z; z++)
+            {
+                auto index = row_index + static_cast<usize>(z);
+                auto block = _data[index];
+
+                if (block == BlockType::Air)
+                    continue;
+
+                auto facing = visible_faces(_data.data(), index, padded_x_stride, padded_y_stride);
+                append_lit_block_vertices(result, block, facing, { x, y, z }, _data.data(), _light.data(), index);
+            }
+        }
     }
 
-    // Right-facing wall (grasps parts of top and bottom walls as well).
-    // +x
+    return result;
+}
+
+auto ChunkNeighborhood::generate_lod_mesh(usize lod) const -> zth::Vector<BlockVertex>
+{
+    // @multithreaded
+
+    ZTH_ASSERT(lod <= max_lod);
+
+    if (lod == 0)
+        return generate_mesh();
+
+    // Every cell of the downsampled chunk is meshed as a single block of cell_size. The downsampled blocks are kept in
+    // a padded volume as well. A cell of the apron is opaque if every block of the apron which it covers is opaque, so
+    // the faces on the chunk's borders are emitted wherever the neighbor lets the chunk be seen. Together with
+    // expose_lod_borders, they act as skirts which cover the gaps between chunks with different levels of detail. The
+    // light of every cell is downsampled along with its block.
+
+    auto cell_size = 1 << lod;
+    auto cells = chunk_size / cell_size;
+    auto padded_cells = cells + 2;
+
+    auto x_stride = static_cast<usize>(padded_cells.y * padded_cells.z);
+    auto y_stride = static_cast<usize>(padded_cells.z);
+
+    auto cell_index = [&](glm::ivec3 cell) {
+        auto [x, y, z] = cell + 1;
+        return static_cast<usize>((x * padded_cells.y + y) * padded_cells.z + z);
+    };
+
+    auto padded_cell_count = static_cast<usize>(padded_cells.x * padded_cells.y * padded_cells.z);
+    zth::Vector<BlockType> cell_blocks(padded_cell_count, missing_block);
+    zth::Vector<u8> cell_light(padded_cell_count, full_light);
+
+    for (i32 x = 0; x < cells.x; x++)
     {
-        constexpr auto xs = std::views::iota(chunk_size.x - 1, chunk_size.x);
-        constexpr auto ys = std::views::iota(0, chunk_size.y);
-        constexpr auto zs = std::views::iota(1, chunk_size.z - 1);
-        constexpr auto wall = std::views::cartesian_product(xs, ys, zs);
-        append_vertices_for_wall(vertices, wall, neighbors);
+        for (i32 y = 0; y < cells.y; y++)
+        {
+            for (i32 z = 0; z < cells.z; z++)
+            {
+                glm::ivec3 cell{ x, y, z };
+                cell_blocks[cell_index(cell)] = downsample_cell(*this, cell * cell_size, cell_size);
+                cell_light[cell_index(cell)] = region_light(*this, cell * cell_size, glm::ivec3{ cell_size });
+            }
+        }
     }
 
-    // Bottom-facing wall.
-    // -y
+    // The cells of the apron along the edges and the corners are never looked at.
+    for (auto offset : neighbor_offsets)
     {
-        constexpr auto xs = std::views::iota(1, chunk_size.x - 1);
-        constexpr auto ys = std::views::iota(0, 1);
-        constexpr auto zs = std::views::iota(1, chunk_size.z - 1);
-        constexpr auto wall = std::views::cartesian_product(xs, ys, zs);
-        append_vertices_for_wall(vertices, wall, neighbors);
+        for_each_apron_square(offset, cell_size, [&](glm::ivec3 first, glm::ivec3 size) {
+            glm::ivec3 cell{ floor_div(first.x, cell_size), floor_div(first.y, cell_size),
+                             floor_div(first.z, cell_size) };
+            cell_blocks[cell_index(cell)] = opaque_region(*this, first, size) ? operator[](first) : missing_block;
+            cell_light[cell_index(cell)] = region_light(*this, first, size);
+        });
     }
 
-    // Top-facing wall.
-    // +y
+    zth::Vector<BlockVertex> result;
+
+    for (i32 x = 0; x < cells.x; x++)
     {
-        constexpr auto xs = std::views::iota(1, chunk_size.x - 1);
-        constexpr auto ys = std::views::iota(chunk_size.y - 1, chunk_size.y);
-        constexpr auto zs = std::views::iota(1, chunk_size.z - 1);
-        constexpr auto wall = std::views::cartesian_product(xs, ys, zs);
-        append_vertices_for_wall(vertices, wall, neighbors);
+        for (i32 y = 0; y < cells.y; y++)
+        {
+            for (i32 z = 0; z < cells.z; z++)
+            {
+                glm::ivec3 cell{ x, y, z };
+                auto index = cell_index(cell);
+                auto block = cell_blocks[index];
+
+                if (block == BlockType::Air)
+                    continue;
+
+                auto facing = visible_faces(cell_blocks.data(), index, x_stride, y_stride);
+                append_cell_vertices(result, block, facing, cell, static_cast<float>(cell_size), cell_light.data(),
+                                     index, x_stride, y_stride);
+            }
+        }
     }
+
+    return result;
 }
 
-auto ChunkData::append_vertices_for_interior_blocks(zth::Vector<zth::StandardVertex>& vertices) const -> void
+auto ChunkNeighborhood::valid_coordinates(glm::ivec3 coordinates) -> bool
 {
-    // We don't need to worry about whether the coordinates of neighboring blocks are correct as we're only handling the
-    // interior blocks.
+    auto [x, y, z] = coordinates;
 
-    // Skip the exterior blocks.
-    constexpr auto xs = std::views::iota(1, chunk_size.x - 1);
-    constexpr auto ys = std::views::iota(1, chunk_size.y - 1);
-    constexpr auto zs = std::views::iota(1, chunk_size.z - 1);
-    constexpr auto coords = std::views::cartesian_product(xs, ys, zs);
+    auto valid_x = x >= -1 && x <= chunk_size.x;
+    auto valid_y = y >= -1 && y <= chunk_size.y;
+    auto valid_z = z >= -1 && z <= chunk_size.z;
 
-    for (const auto [x, y, z] : coords)
-    {
-        glm::ivec3 block_coords{ x, y, z };
-        auto block = operator[](block_coords);
-        auto facing = visible_faces_for_interior_block(block_coords);
-        append_block_vertices(vertices, block, facing, block_coords);
-    }
+    if (valid_x && valid_y && valid_z)
+        return true;
+
+    return false;
 }
 
-auto ChunkData::append_vertices_for_wall(zth::Vector<zth::StandardVertex>& vertices, const WallCoordinates& wall,
-                                         const NeighborsArray& neighbors) const -> void
+auto ChunkNeighborhood::index_of(glm::ivec3 coordinates) -> usize
 {
-    for (const auto [x, y, z] : wall)
-    {
-        glm::ivec3 block_coords{ x, y, z };
-        auto block = operator[](block_coords);
-        auto facing = visible_faces_for_exterior_block(block_coords, neighbors);
-        append_block_vertices(vertices, block, facing, block_coords);
-    }
+    ZTH_ASSERT(valid_coordinates(coordinates));
+    auto [x, y, z] = coordinates + 1;
+    return static_cast<usize>((x * padded_chunk_size.y + y) * padded_chunk_size.z + z);
 }
 
-auto ChunkData::exterior_block_coordinates(glm::ivec3 coordinates) -> bool
+auto ChunkData::at(glm::ivec3 coordinates) -> Optional<Reference<BlockType>>
 {
-    auto [x, y, z] = coordinates;
-    return exterior_x(x) || exterior_y(y) || exterior_z(z);
+    if (!valid_coordinates(coordinates))
+        return nil;
+
+    return operator[](coordinates);
 }
 
-auto ChunkData::exterior_x(i32 x) -> bool
+auto ChunkData::at(glm::ivec3 coordinates) const -> Optional<Reference<const BlockType>>
 {
-    return x == 0 || x == chunk_size.x - 1;
+    if (!valid_coordinates(coordinates))
+        return nil;
+
+    return operator[](coordinates);
 }
 
-auto ChunkData::exterior_y(i32 y) -> bool
+auto ChunkData::operator[](glm::ivec3 coordinates) -> BlockType&
 {
-    return y == 0 || y == chunk_size.y - 1;
+    ZTH_ASSERT(valid_coordinates(coordinates));
+    auto [x, y, z] = coordinates;
+    std::mdspan view{ _data.data(), chunk_size.x, chunk_size.y, chunk_size.z };
+    return view[x, y, z];
 }
 
-auto ChunkData::exterior_z(i32 z) -> bool
+auto ChunkData::operator[](glm::ivec3 coordinates) const -> const BlockType&
 {
-    return z == 0 || z == chunk_size.z - 1;
+    ZTH_ASSERT(valid_coordinates(coordinates));
+    auto [x, y, z] = coordinates;
+    std::mdspan view{ _data.data(), chunk_size.x, chunk_size.y, chunk_size.z };
+    return view[x, y, z];
 }
 
-auto ChunkData::interior_block_coordinates(glm::ivec3 coordinates) -> bool
+auto ChunkData::light(glm::ivec3 coordinates) -> u8&
 {
+    ZTH_ASSERT(valid_coordinates(coordinates));
     auto [x, y, z] = coordinates;
-    return interior_x(x) && interior_y(y) && interior_z(z);
+    std::mdspan view{ _light.data(), chunk_size.x, chunk_size.y, chunk_size.z };
+    return view[x, y, z];
 }
 
-auto ChunkData::interior_x(i32 x) -> bool
+auto ChunkData::light(glm::ivec3 coordinates) const -> const u8&
 {
-    return x > 0 && x < chunk_size.x - 1;
+    ZTH_ASSERT(valid_coordinates(coordinates));
+    auto [x, y, z] = coordinates;
+    std::mdspan view{ _light.data(), chunk_size.x, chunk_size.y, chunk_size.z };
+    return view[x, y, z];
 }
 
-auto ChunkData::interior_y(i32 y) -> bool
+auto ChunkData::empty() const -> bool
 {
-    return y > 0 && y < chunk_size.y - 1;
+    return std::ranges::all_of(_data, [](auto block) { return block == BlockType::Air; });
 }
 
-auto ChunkData::interior_z(i32 z) -> bool
+auto ChunkData::valid_coordinates(glm::ivec3 coordinates) -> bool
 {
-    return z > 0 && z < chunk_size.z - 1;
+    auto [x, y, z] = coordinates;
+
+    auto valid_x = x >= 0 && x < chunk_size.x;
+    auto valid_y = y >= 0 && y < chunk_size.y;
+    auto valid_z = z >= 0 && z < chunk_size.z;
+
+    if (valid_x && valid_y && valid_z)
+        return true;
+
+    return false;
 }
 
 auto world_x_to_chunk_x(i32 x) -> i32
 {
-    return x / chunk_size.x;
+    return floor_div(x, chunk_size.x);
+}
+
+auto world_y_to_chunk_y(i32 y) -> i32
+{
+    return floor_div(y, chunk_size.y);
 }
 
 auto world_z_to_chunk_z(i32 z) -> i32
 {
-    return z / chunk_size.z;
+    return floor_div(z, chunk_size.z);
 }
 
 auto chunk_x_to_world_x(i32 x) -> i32
@@ -485,6 +787,11 @@ auto chunk_x_to_world_x(i32 x) -> i32
     return x * chunk_size.x;
 }
 
+auto chunk_y_to_world_y(i32 y) -> i32
+{
+    return y * chunk_size.y;
+}
+
 auto chunk_z_to_world_z(i32 z) -> i32
 {
     return z * chunk_size.z;
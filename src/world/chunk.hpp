@@ -2,24 +2,45 @@
 
 #include "fwd.hpp"
 
+#include "frustum.hpp"
+#include "profiling.hpp"
 #include "world/block.hpp"
+#include "world/block_vertex.hpp"
+#include "world/light.hpp"
+#include "world/visibility.hpp"
 
-constexpr inline glm::ivec3 chunk_size{ 16, 256, 16 };
+// Chunks are cubes stacked on top of each other into columns, so the height of the world isn't bounded by the size of a
+// chunk.
+constexpr inline glm::ivec3 chunk_size{ 16, 16, 16 };
 constexpr inline i32 blocks_in_chunk = chunk_size.x * chunk_size.y * chunk_size.z;
 
-// These are used to access the chunk component's neighbors array.
+// Size of a chunk with a one block wide apron on every side.
+constexpr inline glm::ivec3 padded_chunk_size{ chunk_size.x + 2, chunk_size.y + 2, chunk_size.z + 2 };
+constexpr inline i32 blocks_in_padded_chunk = padded_chunk_size.x * padded_chunk_size.y * padded_chunk_size.z;
+
+// Chunks further away from the player are meshed at lower levels of detail, where each level halves the resolution.
+constexpr inline usize max_lod = 3;
+
+// Marks the blocks of a chunk neighborhood which belong to a neighbor that isn't loaded or lie outside of the world.
+constexpr inline auto missing_block = static_cast<BlockType>(std::numeric_limits<u8>::max());
+
+// These are used to access a neighbors array.
 constexpr inline usize plus_x_idx = 0;
 constexpr inline usize minus_x_idx = 1;
 constexpr inline usize plus_z_idx = 2;
 constexpr inline usize minus_z_idx = 3;
+constexpr inline usize plus_y_idx = 4;
+constexpr inline usize minus_y_idx = 5;
 
-constexpr inline usize neighbor_count = 4;
+constexpr inline usize neighbor_count = 6;
 
 constexpr inline std::array neighbor_offsets = {
-    glm::ivec2{ 1, 0 },  // Plus X.
-    glm::ivec2{ -1, 0 }, // Minus X.
-    glm::ivec2{ 0, 1 },  // Plus Z.
-    glm::ivec2{ 0, -1 }, // Minus Z.
+    glm::ivec3{ 1, 0, 0 },  // Plus X.
+    glm::ivec3{ -1, 0, 0 }, // Minus X.
+    glm::ivec3{ 0, 0, 1 },  // Plus Z.
+    glm::ivec3{ 0, 0, -1 }, // Minus Z.
+    glm::ivec3{ 0, 1, 0 },  // Plus Y.
+    glm::ivec3{ 0, -1, 0 }, // Minus Y.
 };
 
 constexpr inline std::array opposite_neighbor_offset_idx = {
@@ -27,14 +48,95 @@ constexpr inline std::array opposite_neighbor_offset_idx = {
     0,
     3,
     2,
+    5,
+    4,
 };
 
-using NeighborsArray = std::array<std::shared_ptr<const ChunkData>, neighbor_count>;
+// Every chunk around a chunk, including the ones it only shares an edge or a corner with. The ones it shares a face
+// with come first, in the same order as in neighbor_offsets.
+constexpr inline usize apron_neighbor_count = 26;
+
+constexpr inline auto apron_neighbor_offsets = [] {
+    std::array<glm::ivec3, apron_neighbor_count> result{};
+    std::ranges::copy(neighbor_offsets, result.begin());
+    auto i = neighbor_count;
+
+    for (i32 x = -1; x <= 1; x++)
+    {
+        for (i32 y = -1; y <= 1; y++)
+        {
+            for (i32 z = -1; z <= 1; z++)
+            {
+                if (std::abs(x) + std::abs(y) + std::abs(z) >= 2)
+                    result[i++] = glm::ivec3{ x, y, z };
+            }
+        }
+    }
+
+    return result;
+}();
+
+// Indexed like apron_neighbor_offsets. Non-owning, only valid for as long as the neighboring chunks stay loaded.
+using NeighborsArray = std::array<const ChunkData*, apron_neighbor_count>;
+// Levels of detail which the neighbors are meshed at.
+using NeighborLodsArray = std::array<usize, neighbor_count>;
+
+// Padded copy of a chunk which mesh generation works on. It holds the chunk's blocks together with a one block wide
+// apron copied out of the 26 neighboring chunks, indexed with the chunk's own coordinates (from -1 to chunk_size
+// inclusive), so every block of the chunk can be meshed with the same branch-free lookups no matter whether its
+// neighbors lie inside the chunk or across one of its borders. Blocks of the apron which aren't covered by a neighbor
+// are set to missing_block and full_light. The light is copied along with the blocks, every face is lit by the light of
+// the block in front of it.
+//
+// The neighborhood is copied on the main thread, so that the update task doesn't have to keep the chunk and its
+// neighbors alive, and so that it never reads them while the main thread writes blocks or light into them.
+class ChunkNeighborhood
+{
+public:
+    using BlocksArray = std::array<BlockType, blocks_in_padded_chunk>;
+    using LightArray = std::array<u8, blocks_in_padded_chunk>;
+
+    explicit ChunkNeighborhood() = default;
+
+    ZTH_NO_COPY(ChunkNeighborhood)
+    ZTH_DEFAULT_MOVE(ChunkNeighborhood)
+
+    ~ChunkNeighborhood() = default;
+
+    // Only writes the apron.
+    auto copy_borders(const NeighborsArray& neighbors) -> void;
+    // Only writes the interior.
+    auto copy_chunk(const ChunkData& chunk) -> void;
+    // Where a neighbor is meshed at another level of detail than the chunk, the two meshes don't meet, so the faces on
+    // the border have to be emitted on both sides to cover the gap. Marks the squares of the apron (as big as a cell of
+    // the coarser level) which aren't entirely opaque as missing, so that every face behind them is emitted.
+    auto expose_lod_borders(usize lod, const NeighborLodsArray& neighbor_lods) -> void;
+
+    [[nodiscard]] auto operator[](glm::ivec3 coordinates) -> BlockType&;
+    [[nodiscard]] auto operator[](glm::ivec3 coordinates) const -> const BlockType&;
+    [[nodiscard]] auto light(glm::ivec3 coordinates) -> u8&;
+    [[nodiscard]] auto light(glm::ivec3 coordinates) const -> const u8&;
+
+    [[nodiscard]] auto generate_mesh() const -> zth::Vector<BlockVertex>;
+    // Generates a mesh from the chunk downsampled by a factor of 2^lod. Each cell holds the strongest light of its
+    // blocks, and every face is lit by the cell in front of it.
+    [[nodiscard]] auto generate_lod_mesh(usize lod) const -> zth::Vector<BlockVertex>;
+
+    [[nodiscard]] static auto valid_coordinates(glm::ivec3 coordinates) -> bool;
+
+private:
+    BlocksArray _data; // Purposefully left uninitialized.
+    LightArray _light; // Purposefully left uninitialized.
+
+private:
+    [[nodiscard]] static auto index_of(glm::ivec3 coordinates) -> usize;
+};
 
 class ChunkData
 {
 public:
     using BlocksArray = std::array<BlockType, blocks_in_chunk>;
+    using LightArray = std::array<u8, blocks_in_chunk>;
 
     explicit ChunkData() = default;
 
@@ -45,55 +147,71 @@ public:
 
     [[nodiscard]] auto at(glm::ivec3 coordinates) -> Optional<Reference<BlockType>>;
     [[nodiscard]] auto at(glm::ivec3 coordinates) const -> Optional<Reference<const BlockType>>;
-    [[nodiscard]] auto at_exterior(glm::ivec3 coordinates, const NeighborsArray& neighbors) const
-        -> Optional<Reference<const BlockType>>;
     [[nodiscard]] auto operator[](glm::ivec3 coordinates) -> BlockType&;
     [[nodiscard]] auto operator[](glm::ivec3 coordinates) const -> const BlockType&;
 
-    [[nodiscard]] auto generate_mesh(const NeighborsArray& neighbors) const -> zth::Vector<zth::StandardVertex>;
+    // Returns true if the chunk consists only of air.
+    [[nodiscard]] auto empty() const -> bool;
+
+    // Blocks laid out with x changing the slowest and z changing the fastest.
+    [[nodiscard]] auto blocks() -> BlocksArray& { return _data; }
+    [[nodiscard]] auto blocks() const -> const BlocksArray& { return _data; }
+
+    // Packed light levels, see light.hpp. Laid out like the blocks.
+    [[nodiscard]] auto light(glm::ivec3 coordinates) -> u8&;
+    [[nodiscard]] auto light(glm::ivec3 coordinates) const -> const u8&;
+    [[nodiscard]] auto lights() -> LightArray& { return _light; }
+    [[nodiscard]] auto lights() const -> const LightArray& { return _light; }
 
     [[nodiscard]] static auto valid_coordinates(glm::ivec3 coordinates) -> bool;
 
 private:
     BlocksArray _data; // Purposefully left uninitialized.
-
-private:
-    using WallCoordinates =
-        std::ranges::cartesian_product_view<std::ranges::iota_view<int, int>, std::ranges::iota_view<int, int>,
-                                            std::ranges::iota_view<int, int>>;
-
-    [[nodiscard]] auto visible_faces_for_exterior_block(glm::ivec3 coordinates, const NeighborsArray& neighbors) const
-        -> BlockFacing;
-    [[nodiscard]] auto visible_faces_for_interior_block(glm::ivec3 coordinates) const -> BlockFacing;
-
-    // Mesh generation.
-    auto append_vertices_for_exterior_blocks(zth::Vector<zth::StandardVertex>& vertices,
-                                             const NeighborsArray& neighbors) const -> void;
-    auto append_vertices_for_interior_blocks(zth::Vector<zth::StandardVertex>& vertices) const -> void;
-
-    auto append_vertices_for_wall(zth::Vector<zth::StandardVertex>& vertices, const WallCoordinates& wall,
-                                  const NeighborsArray& neighbors) const -> void;
-
-    [[nodiscard]] static auto exterior_block_coordinates(glm::ivec3 coordinates) -> bool;
-    [[nodiscard]] static auto exterior_x(i32 x) -> bool;
-    [[nodiscard]] static auto exterior_y(i32 y) -> bool;
-    [[nodiscard]] static auto exterior_z(i32 z) -> bool;
-
-    [[nodiscard]] static auto interior_block_coordinates(glm::ivec3 coordinates) -> bool;
-    [[nodiscard]] static auto interior_x(i32 x) -> bool;
-    [[nodiscard]] static auto interior_y(i32 y) -> bool;
-    [[nodiscard]] static auto interior_z(i32 z) -> bool;
+    LightArray _light; // Purposefully left uninitialized.
 };
 
+// Appends a single face of an axis-aligned box, textured like the given block and lit with the given brightness (see
+// light_brightness). Used for meshes whose faces don't map one to one onto blocks.
+auto append_box_face(zth::Vector<BlockVertex>& vertices, BlockType block, BlockFacing facing,
+                     glm::vec3 position, glm::vec3 size, float brightness) -> void;
+// Shades every vertex of the face separately, in the order of the face's vertices.
+auto append_box_face(zth::Vector<BlockVertex>& vertices, BlockType block, BlockFacing facing,
+                     glm::vec3 position, glm::vec3 size, const std::array<float, zth::vertices_per_quad>& brightness)
+    -> void;
+
 [[nodiscard]] auto world_x_to_chunk_x(i32 x) -> i32;
+[[nodiscard]] auto world_y_to_chunk_y(i32 y) -> i32;
 [[nodiscard]] auto world_z_to_chunk_z(i32 z) -> i32;
 
 [[nodiscard]] auto chunk_x_to_world_x(i32 x) -> i32;
+[[nodiscard]] auto chunk_y_to_world_y(i32 y) -> i32;
 [[nodiscard]] auto chunk_z_to_world_z(i32 z) -> i32;
 
 struct ChunkComponent
 {
     std::shared_ptr<ChunkData> data = nullptr;
-    NeighborsArray neighbors{};
-    glm::ivec2 position{ 0, 0 };
+    glm::ivec3 position{ 0, 0, 0 };
+
+    // The mesh is only handed over to the renderer (through a mesh renderer component) while the chunk is visible.
+    std::shared_ptr<BlockMesh> mesh = nullptr;
+    Aabb bounds{}; // Bounds of the mesh in world space.
+    usize mesh_size = 0; // In bytes.
+    usize lod = 0;       // Level of detail of the mesh.
+    bool visible = false;
+
+    // Used by the world manager's memory budget. A chunk whose mesh was evicted keeps its data and gets remeshed once
+    // it might be visible again.
+    u64 last_visible_frame = 0;
+    bool mesh_evicted = false;
+
+    // Used to measure how long it takes for the chunk to appear after it was requested.
+    profiling::Timestamp created_at = profiling::now();
+    bool meshed = false;
+
+    // Computed together with the mesh.
+    ChunkVisibility visibility = ChunkVisibility::all();
+
+    // Chunk entities are reused for other chunks once they're unloaded. The generation changes whenever that happens,
+    // so that the results of the tasks which were launched for the previous chunk can be told apart.
+    u32 generation = 0;
 };
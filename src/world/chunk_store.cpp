@@ -0,0 +1,307 @@
+#include "world/chunk_store.hpp"
+
+#include <fstream>
+
+#include "world/chunk.hpp"
+#include "world/generator.hpp"
+
+namespace {
+
+constexpr u32 magic = 0x53434d43; // "CMCS"
+constexpr u32 format_version = 2;
+
+// Values are always stored in little endian.
+template<std::integral T> [[nodiscard]] auto to_little_endian(T value) -> T
+{
+    if constexpr (std::endian::native == std::endian::big)
+        return std::byteswap(value);
+    else
+        return value;
+}
+
+template<std::integral T> auto write_value(std::ostream& stream, T value) -> void
+{
+    value = to_little_endian(value);
+    stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<std::integral T> [[nodiscard]] auto read_value(std::istream& stream) -> Optional<T>
+{
+    T value;
+
+    if (!stream.read(reinterpret_cast<char*>(&value), sizeof(T)))
+        return nil;
+
+    // Swapping the bytes is its own inverse.
+    return to_little_endian(value);
+}
+
+struct Run
+{
+    BlockType block;
+    u16 length;
+};
+
+auto encode(const ChunkData& chunk, zth::Vector<Run>& runs) -> void
+{
+    runs.clear();
+
+    for (auto block : chunk.blocks())
+    {
+        if (!runs.empty() && runs.back().block == block && runs.back().length < std::numeric_limits<u16>::max())
+            runs.back().length++;
+        else
+            runs.push_back(Run{ .block = block, .length = 1 });
+    }
+}
+
+} // namespace
+
+struct ChunkStore::Region
+{
+    struct Chunk
+    {
+        glm::ivec3 position;
+        usize first_run;
+        usize run_count;
+    };
+
+    u32 seed;
+    zth::Vector<Chunk> chunks;
+    zth::Vector<Run> runs; // Runs of all the chunks, one chunk after another.
+
+    [[nodiscard]] auto decode(const Chunk& chunk) const -> std::shared_ptr<ChunkData>
+    {
+        auto data = std::make_shared_for_overwrite<ChunkData>();
+        auto output = data->blocks().begin();
+
+        for (auto [block, length] : std::span{ runs }.subspan(chunk.first_run, chunk.run_count))
+            output = std::fill_n(output, length, block);
+
+        return data;
+    }
+};
+
+ChunkStore::ChunkStore(std::filesystem::path directory) : _directory(std::move(directory)) {}
+
+auto ChunkStore::write_region(glm::ivec2 region_position, u32 seed, std::span<const StoredChunk> chunks) const
+    -> Optional<usize>
+{
+    // @multithreaded
+
+    std::error_code error;
+    std::filesystem::create_directories(_directory, error);
+
+    if (error)
+        return nil;
+
+    // The region is written into a temporary file first, so that a reader never sees a partially written region.
+    auto path = region_path(region_position);
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+
+    {
+        std::ofstream file{ temporary_path, std::ios::binary };
+
+        if (!file)
+            return nil;
+
+        write_value(file, magic);
+        write_value(file, format_version);
+        write_value(file, WorldGenerator::version);
+        write_value(file, seed);
+        write_value(file, static_cast<u32>(chunks.size()));
+
+        zth::Vector<Run> runs;
+
+        for (const auto& [position, data] : chunks)
+        {
+            ZTH_ASSERT(data != nullptr);
+            encode(*data, runs);
+
+            write_value(file, position.x);
+            write_value(file, position.y);
+            write_value(file, position.z);
+            write_value(file, static_cast<u32>(runs.size()));
+
+            for (auto [block, length] : runs)
+            {
+                write_value(file, std::to_underlying(block));
+                write_value(file, length);
+            }
+        }
+
+        if (!file)
+            return nil;
+    }
+
+    auto size = std::filesystem::file_size(temporary_path, error);
+
+    if (error)
+        return nil;
+
+    std::filesystem::rename(temporary_path, path, error);
+
+    if (error)
+        return nil;
+
+    forget_region(region_position);
+
+    return static_cast<usize>(size);
+}
+
+auto ChunkStore::read_region(glm::ivec2 region_position, u32 seed) const -> zth::Vector<StoredChunk>
+{
+    // @multithreaded
+
+    auto region = get_region(region_position, seed);
+
+    if (!region)
+        return {};
+
+    zth::Vector<StoredChunk> result;
+    result.reserve(region->chunks.size());
+
+    for (const auto& chunk : region->chunks)
+        result.push_back(StoredChunk{ .position = chunk.position, .data = region->decode(chunk) });
+
+    return result;
+}
+
+auto ChunkStore::read_chunks(glm::ivec2 region_position, u32 seed, std::span<const glm::ivec3> chunk_positions) const
+    -> zth::Vector<StoredChunk>
+{
+    // @multithreaded
+
+    auto region = get_region(region_position, seed);
+
+    if (!region)
+        return {};
+
+    zth::Vector<StoredChunk> result;
+
+    for (const auto& chunk : region->chunks)
+    {
+        if (std::ranges::contains(chunk_positions, chunk.position))
+            result.push_back(StoredChunk{ .position = chunk.position, .data = region->decode(chunk) });
+    }
+
+    return result;
+}
+
+auto ChunkStore::region_of(glm::ivec3 chunk_position) -> glm::ivec2
+{
+    auto position = glm::vec2{ chunk_position.x, chunk_position.z } / static_cast<float>(region_size);
+    return glm::ivec2{ glm::floor(position) };
+}
+
+auto ChunkStore::region_path(glm::ivec2 region_position) const -> std::filesystem::path
+{
+    return _directory / std::format("r.{}.{}.chunks", region_position.x, region_position.y);
+}
+
+auto ChunkStore::get_region(glm::ivec2 region_position, u32 seed) const -> std::shared_ptr<const Region>
+{
+    // @multithreaded
+
+    {
+        std::scoped_lock lock{ _cache_mutex };
+
+        auto cached = std::ranges::find(_cache, region_position, &decltype(_cache)::value_type::first);
+
+        if (cached != _cache.end() && cached->second->seed == seed)
+        {
+            // Moves the region to the back, it's the most recently used one now.
+            std::ranges::rotate(cached, std::next(cached), _cache.end());
+            return _cache.back().second;
+        }
+    }
+
+    // The file is parsed without holding the lock. Two tasks may end up parsing the same region, which is harmless.
+    auto region = parse_region(region_position, seed);
+
+    if (!region)
+        return nullptr;
+
+    std::scoped_lock lock{ _cache_mutex };
+
+    std::erase_if(_cache, [region_position](const auto& entry) { return entry.first == region_position; });
+
+    if (_cache.size() >= max_cached_regions)
+        _cache.erase(_cache.begin());
+
+    _cache.emplace_back(region_position, region);
+
+    return region;
+}
+
+auto ChunkStore::parse_region(glm::ivec2 region_position, u32 seed) const -> std::shared_ptr<const Region>
+{
+    // @multithreaded
+
+    std::ifstream file{ region_path(region_position), std::ios::binary };
+
+    if (!file)
+        return nullptr;
+
+    if (read_value<u32>(file) != magic || read_value<u32>(file) != format_version
+        || read_value<u32>(file) != WorldGenerator::version || read_value<u32>(file) != seed)
+    {
+        return nullptr;
+    }
+
+    auto chunk_count = read_value<u32>(file);
+
+    if (!chunk_count)
+        return nullptr;
+
+    auto region = std::make_shared<Region>();
+    region->seed = seed;
+    region->chunks.reserve(*chunk_count);
+
+    for (u32 i = 0; i < *chunk_count; i++)
+    {
+        auto x = read_value<i32>(file);
+        auto y = read_value<i32>(file);
+        auto z = read_value<i32>(file);
+        auto run_count = read_value<u32>(file);
+
+        if (!x || !y || !z || !run_count)
+            return nullptr;
+
+        auto first_run = region->runs.size();
+        usize filled = 0;
+
+        for (u32 run = 0; run < *run_count; run++)
+        {
+            auto block = read_value<std::underlying_type_t<BlockType>>(file);
+            auto length = read_value<u16>(file);
+
+            if (!block || !length || filled + *length > static_cast<usize>(blocks_in_chunk))
+                return nullptr;
+
+            region->runs.push_back(Run{ .block = static_cast<BlockType>(*block), .length = *length });
+            filled += *length;
+        }
+
+        // Decoding relies on the runs covering the whole chunk.
+        if (filled != static_cast<usize>(blocks_in_chunk))
+            return nullptr;
+
+        region->chunks.push_back(Region::Chunk{
+            .position = { *x, *y, *z },
+            .first_run = first_run,
+            .run_count = *run_count,
+        });
+    }
+
+    return region;
+}
+
+auto ChunkStore::forget_region(glm::ivec2 region_position) const -> void
+{
+    // @multithreaded
+
+    std::scoped_lock lock{ _cache_mutex };
+    std::erase_if(_cache, [region_position](const auto& entry) { return entry.first == region_position; });
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <mutex>
+
+#include "fwd.hpp"
+
+struct StoredChunk
+{
+    glm::ivec3 position{ 0, 0, 0 };
+    std::shared_ptr<ChunkData> data = nullptr;
+};
+
+// Chunks saved on disk. The chunks are grouped into one file per region of region_size by region_size columns, and
+// a region file is always written as a whole, so different threads can write different regions at the same time.
+// Every file remembers the version and the seed of the world generator which generated its chunks, and reading it with
+// another version or seed yields no chunks.
+//
+// The last few regions which were read are kept in memory, still run-length encoded, since the chunks of a region are
+// usually loaded by several tasks, each of which only needs a part of the region.
+//
+// File format (little endian, whatever the byte order of the machine):
+//     u32 magic, u32 format version, u32 generator version, u32 seed, u32 chunk count
+//     For every chunk: i32 x, i32 y, i32 z, u32 run count, and the chunk's blocks in memory order, run-length encoded
+//     as (u8 block type, u16 run length) pairs.
+class ChunkStore
+{
+public:
+    static constexpr i32 region_size = 8;
+    static constexpr usize max_cached_regions = 16;
+
+public:
+    explicit ChunkStore(std::filesystem::path directory);
+
+    ZTH_NO_COPY_NO_MOVE(ChunkStore)
+
+    ~ChunkStore() = default;
+
+    // Returns the number of bytes written, or nil if the file couldn't be written.
+    [[nodiscard]] auto write_region(glm::ivec2 region_position, u32 seed, std::span<const StoredChunk> chunks) const
+        -> Optional<usize>;
+    // Returns no chunks if the region's file doesn't exist, is invalid or was generated with another seed.
+    [[nodiscard]] auto read_region(glm::ivec2 region_position, u32 seed) const -> zth::Vector<StoredChunk>;
+    // Like read_region, but only decodes the chunks of the region whose positions are among the given ones.
+    [[nodiscard]] auto read_chunks(glm::ivec2 region_position, u32 seed,
+                                   std::span<const glm::ivec3> chunk_positions) const -> zth::Vector<StoredChunk>;
+
+    [[nodiscard]] auto directory() const -> const std::filesystem::path& { return _directory; }
+
+    [[nodiscard]] static auto region_of(glm::ivec3 chunk_position) -> glm::ivec2;
+
+private:
+    struct Region;
+
+    std::filesystem::path _directory;
+
+    // Ordered from the least to the most recently used.
+    mutable std::mutex _cache_mutex;
+    mutable zth::Vector<std::pair<glm::ivec2, std::shared_ptr<const Region>>> _cache;
+
+private:
+    [[nodiscard]] auto region_path(glm::ivec2 region_position) const -> std::filesystem::path;
+    // Returns nullptr if the region's file doesn't exist, is invalid or was generated with another seed.
+    [[nodiscard]] auto get_region(glm::ivec2 region_position, u32 seed) const -> std::shared_ptr<const Region>;
+    [[nodiscard]] auto parse_region(glm::ivec2 region_position, u32 seed) const -> std::shared_ptr<const Region>;
+    auto forget_region(glm::ivec2 region_position) const -> void;
+};
@@ -0,0 +1,152 @@
+#include "world/collision.hpp"
+
+#include "world/chunk.hpp"
+
+namespace {
+
+// Boxes touching a block boundary don't count as overlapping the blocks on the other side of it.
+constexpr float skin = 1e-4f;
+
+// Answers whether blocks are solid, caching the chunk which was looked up last.
+class BlockReader
+{
+public:
+    explicit BlockReader(const ChunkLookup& lookup) : _lookup(lookup) {}
+
+    [[nodiscard]] auto solid(glm::ivec3 block_position) -> bool
+    {
+        auto [x, y, z] = block_position;
+        glm::ivec3 chunk_position{ world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+
+        if (!_cached || chunk_position != _chunk_position)
+        {
+            _chunk = _lookup(chunk_position);
+            _chunk_position = chunk_position;
+            _cached = true;
+        }
+
+        if (!_chunk)
+            return true;
+
+        auto chunk_origin = glm::ivec3{ chunk_x_to_world_x(chunk_position.x), chunk_y_to_world_y(chunk_position.y),
+                                        chunk_z_to_world_z(chunk_position.z) };
+        return is_solid((*_chunk)[block_position - chunk_origin]);
+    }
+
+private:
+    const ChunkLookup& _lookup;
+    glm::ivec3 _chunk_position{ 0, 0, 0 };
+    const ChunkData* _chunk = nullptr;
+    bool _cached = false;
+};
+
+[[nodiscard]] auto first_block(float min) -> i32
+{
+    return static_cast<i32>(std::floor(min + skin));
+}
+
+[[nodiscard]] auto last_block(float max) -> i32
+{
+    return static_cast<i32>(std::floor(max - skin));
+}
+
+// Returns how far the box can move along the axis, up to the distance.
+[[nodiscard]] auto sweep_axis(BlockReader& blocks, const Aabb& box, glm::length_t axis, float distance) -> float
+{
+    if (distance == 0.0f)
+        return 0.0f;
+
+    // The other two axes, whose blocks make up the layers of blocks the box sweeps through.
+    auto u = (axis + 1) % 3;
+    auto v = (axis + 2) % 3;
+
+    auto first_u = first_block(box.min[u]);
+    auto last_u = last_block(box.max[u]);
+    auto first_v = first_block(box.min[v]);
+    auto last_v = last_block(box.max[v]);
+
+    auto layer_solid = [&](i32 layer) {
+        glm::ivec3 block{ 0, 0, 0 };
+        block[axis] = layer;
+
+        for (auto i = first_u; i <= last_u; i++)
+        {
+            block[u] = i;
+
+            for (auto j = first_v; j <= last_v; j++)
+            {
+                block[v] = j;
+
+                if (blocks.solid(block))
+                    return true;
+            }
+        }
+
+        return false;
+    };
+
+    if (distance > 0.0f)
+    {
+        auto first_layer = last_block(box.max[axis]) + 1;
+        auto last_layer = last_block(box.max[axis] + distance);
+
+        for (auto layer = first_layer; layer <= last_layer; layer++)
+        {
+            if (layer_solid(layer))
+                return std::max(static_cast<float>(layer) - box.max[axis], 0.0f);
+        }
+    }
+    else
+    {
+        auto first_layer = first_block(box.min[axis]) - 1;
+        auto last_layer = first_block(box.min[axis] + distance);
+
+        for (auto layer = first_layer; layer >= last_layer; layer--)
+        {
+            if (layer_solid(layer))
+                return std::min(static_cast<float>(layer + 1) - box.min[axis], 0.0f);
+        }
+    }
+
+    return distance;
+}
+
+[[nodiscard]] auto resolve_move(BlockReader& blocks, Aabb box, glm::vec3 displacement) -> MoveResult
+{
+    MoveResult result;
+
+    for (glm::length_t axis : { 1, 0, 2 })
+    {
+        auto moved = sweep_axis(blocks, box, axis, displacement[axis]);
+
+        box.min[axis] += moved;
+        box.max[axis] += moved;
+        result.displacement[axis] = moved;
+        result.collided[axis] = moved != displacement[axis];
+    }
+
+    // Standing on a block means that a block stops the box from moving down. The box can still move a tiny bit, as its
+    // position is rounded to slightly above the block once it's rebuilt from the player's position.
+    result.grounded = sweep_axis(blocks, box, 1, -2.0f * skin) > -2.0f * skin;
+
+    return result;
+}
+
+} // namespace
+
+auto move_box(const ChunkLookup& lookup, const Aabb& box, glm::vec3 displacement) -> MoveResult
+{
+    BlockReader blocks{ lookup };
+    return resolve_move(blocks, box, displacement);
+}
+
+auto move_boxes(const ChunkLookup& lookup, std::span<const Aabb> boxes, std::span<const glm::vec3> displacements,
+                std::span<MoveResult> results) -> void
+{
+    ZTH_ASSERT(boxes.size() == displacements.size() && boxes.size() == results.size());
+
+    BlockReader blocks{ lookup };
+
+    for (usize i = 0; i < boxes.size(); i++)
+        results[i] = resolve_move(blocks, boxes[i], displacements[i]);
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "world/raycast.hpp"
+
+struct MoveResult
+{
+    glm::vec3 displacement{ 0.0f }; // How far the box actually moved.
+    glm::bvec3 collided{ false };   // Whether the movement along each axis was stopped by a block.
+    bool grounded = false;          // Whether the box stands on a block after the movement.
+};
+
+// Moves the box through the world by the displacement, stopping it at the first solid block on each axis. The movement
+// is resolved one axis at a time (vertical first), so a box sliding along a wall or the ground keeps moving along the
+// other axes. Only the blocks which the box sweeps over are visited, however long the displacement, and nothing is
+// allocated.
+//
+// Chunks which aren't loaded are solid, so nothing falls through the world while it's loading. Blocks which the box
+// already overlaps don't stop it, so a box stuck inside the terrain can always move out of it.
+[[nodiscard]] auto move_box(const ChunkLookup& lookup, const Aabb& box, glm::vec3 displacement) -> MoveResult;
+
+// Moves many boxes at once, e.g. every mob of a tick. The chunk lookups are shared between the boxes, so boxes which
+// are close to each other mostly find their chunks already looked up. All the spans have to be of the same size.
+auto move_boxes(const ChunkLookup& lookup, std::span<const Aabb> boxes, std::span<const glm::vec3> displacements,
+                std::span<MoveResult> results) -> void;
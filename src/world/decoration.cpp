@@ -0,0 +1,171 @@
+#include "world/decoration.hpp"
+
+#include "world/chunk.hpp"
+#include "world/generator.hpp"
+
+namespace {
+
+// Every kind of feature gets its own stream of random numbers, so changing one doesn't move the others around.
+constexpr u64 tree_stream = 0x200;
+constexpr u64 ore_stream = 0x201;
+
+// SplitMix64, seeded from the world's seed, the chunk's position and the stream.
+class ChunkRandom
+{
+public:
+    explicit ChunkRandom(glm::ivec3 chunk_position, u64 stream)
+    {
+        _state = (static_cast<u64>(WorldGenerator::seed) << 32) ^ stream;
+
+        for (auto component : { chunk_position.x, chunk_position.y, chunk_position.z })
+            _state = next() ^ static_cast<u32>(component);
+    }
+
+    [[nodiscard]] auto next() -> u64
+    {
+        auto hash = _state += 0x9e3779b97f4a7c15ull;
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+        return hash ^ (hash >> 31);
+    }
+
+    // Returns a number from 0 to bound - 1.
+    [[nodiscard]] auto below(i32 bound) -> i32
+    {
+        ZTH_ASSERT(bound > 0);
+        return static_cast<i32>(next() % static_cast<u64>(bound));
+    }
+
+private:
+    u64 _state = 0;
+};
+
+[[nodiscard]] auto chunk_origin(glm::ivec3 chunk_position) -> glm::ivec3
+{
+    auto [x, y, z] = chunk_position;
+    return { chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+}
+
+auto place_trees(const ChunkData& chunk, glm::ivec3 chunk_position, const HeightMap& heights,
+                 zth::Vector<BlockWrite>& writes) -> void
+{
+    ChunkRandom random{ chunk_position, tree_stream };
+    auto origin = chunk_origin(chunk_position);
+
+    for (i32 attempt = 0; attempt < WorldDecorator::tree_attempts; attempt++)
+    {
+        // The random numbers are drawn even for the attempts which fail, so that every attempt always lands on the
+        // same column.
+        glm::ivec3 ground{ random.below(chunk_size.x), 0, random.below(chunk_size.z) };
+        auto trunk_height =
+            WorldDecorator::min_trunk_height
+            + random.below(std::max(WorldDecorator::max_trunk_height - WorldDecorator::min_trunk_height + 1, 1));
+
+        ground.y = heights.at(origin.x + ground.x, origin.z + ground.z) - origin.y;
+
+        // Trees grow only out of grass, which overhangs and caves may have taken away.
+        if (!ChunkData::valid_coordinates(ground) || chunk[ground] != BlockType::Grass)
+            continue;
+
+        auto base = origin + ground;
+        writes.push_back({ .position = base, .block = BlockType::Dirt, .replaces = BlockType::Grass });
+
+        for (i32 y = 1; y <= trunk_height; y++)
+            writes.push_back({ .position = base + glm::ivec3{ 0, y, 0 }, .block = BlockType::Log });
+
+        // The canopy is two wide layers around the top of the trunk and two narrow ones on top of them. The corners
+        // of the wide layers are left out at random and the corners of the topmost one always.
+        auto top = base + glm::ivec3{ 0, trunk_height, 0 };
+
+        for (i32 dy = -1; dy <= 2; dy++)
+        {
+            auto radius = dy <= 0 ? 2 : 1;
+
+            for (auto dx = -radius; dx <= radius; dx++)
+            {
+                for (auto dz = -radius; dz <= radius; dz++)
+                {
+                    auto corner = std::abs(dx) == radius && std::abs(dz) == radius;
+
+                    if (corner && (dy == 2 || random.below(2) == 0))
+                        continue;
+
+                    writes.push_back({ .position = top + glm::ivec3{ dx, dy, dz }, .block = BlockType::Leaves });
+                }
+            }
+        }
+    }
+}
+
+auto place_ore_veins(glm::ivec3 chunk_position, BlockType ore, i32 veins, i32 vein_size, i32 max_height,
+                     zth::Vector<BlockWrite>& writes) -> void
+{
+    ChunkRandom random{ chunk_position, ore_stream + std::to_underlying(ore) };
+    auto origin = chunk_origin(chunk_position);
+
+    for (i32 vein = 0; vein < veins; vein++)
+    {
+        auto position = origin + glm::ivec3{ random.below(chunk_size.x), random.below(chunk_size.y),
+                                             random.below(chunk_size.z) };
+
+        if (position.y >= max_height)
+            continue;
+
+        // The vein wanders off one block at a time, so it never gets further than vein_size blocks from its start.
+        for (i32 i = 0; i < vein_size; i++)
+        {
+            writes.push_back({ .position = position, .block = ore, .replaces = BlockType::Stone });
+            position[random.below(3)] += random.below(2) * 2 - 1;
+        }
+    }
+}
+
+} // namespace
+
+auto WorldDecorator::decorate(ChunkData& chunk, glm::ivec3 chunk_position, const HeightMap& heights)
+    -> zth::Vector<BlockWrite>
+{
+    // @multithreaded
+
+    zth::Vector<BlockWrite> writes;
+
+    if (chunk.empty())
+        return writes;
+
+    if (trees_enabled)
+        place_trees(chunk, chunk_position, heights, writes);
+
+    if (ores_enabled)
+    {
+        place_ore_veins(chunk_position, BlockType::CoalOre, coal_veins, coal_vein_size,
+                        std::numeric_limits<i32>::max(), writes);
+        place_ore_veins(chunk_position, BlockType::IronOre, iron_veins, iron_vein_size, iron_max_height, writes);
+    }
+
+    place(chunk, chunk_position, writes);
+    std::erase_if(writes, [&](const BlockWrite& write) { return target_chunk(write) == chunk_position; });
+
+    return writes;
+}
+
+auto WorldDecorator::place(ChunkData& chunk, glm::ivec3 chunk_position, std::span<const BlockWrite> writes) -> void
+{
+    // @multithreaded
+
+    auto origin = chunk_origin(chunk_position);
+
+    for (const auto& write : writes)
+    {
+        if (target_chunk(write) != chunk_position)
+            continue;
+
+        if (auto& block = chunk[write.position - origin]; write.applies_to(block))
+            block = write.block;
+    }
+}
+
+auto WorldDecorator::target_chunk(const BlockWrite& write) -> glm::ivec3
+{
+    auto [x, y, z] = write.position;
+    return { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+}
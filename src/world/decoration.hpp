@@ -0,0 +1,46 @@
+#pragma once
+
+#include "fwd.hpp"
+
+#include "world/block.hpp"
+
+class HeightMap;
+
+// Decoration is the stage of generation which follows the strata (see generator.hpp). It places features like trees and
+// ore veins, which unlike the terrain don't fit into a single column, let alone a single chunk.
+//
+// Every chunk decides which features start within it from the seed and its own position. A feature reaches at most one
+// chunk past the chunk it starts in, so decorating a chunk never needs any other chunk: the blocks which fall into the
+// chunk are placed right away and the ones which fall into its neighbors are handed back, to be placed into whichever
+// of them is loaded or once they get generated. Chunks can therefore be decorated on any number of threads in any
+// order, like the rest of generation.
+class WorldDecorator
+{
+public:
+    static inline bool trees_enabled = true;
+    static inline i32 tree_attempts = 3; // Per chunk. Only the attempts which hit grass grow a tree.
+    static inline i32 min_trunk_height = 4;
+    static inline i32 max_trunk_height = 6;
+
+    static inline bool ores_enabled = true;
+    static inline i32 coal_veins = 6; // Per chunk.
+    static inline i32 coal_vein_size = 10;
+    static inline i32 iron_veins = 3;
+    static inline i32 iron_vein_size = 6;
+    static inline i32 iron_max_height = 64; // Iron veins only start below this height.
+
+public:
+    WorldDecorator() = delete;
+
+    // Places the features which start within the chunk. Returns the blocks which fall into the chunk's neighbors. The
+    // height map has to cover all the columns of the chunk.
+    [[nodiscard]] static auto decorate(ChunkData& chunk, glm::ivec3 chunk_position, const HeightMap& heights)
+        -> zth::Vector<BlockWrite>;
+
+    // Places the blocks which fall into the chunk and skips the rest. Overlapping features come out the same whichever
+    // order they're placed in, see BlockWrite.
+    static auto place(ChunkData& chunk, glm::ivec3 chunk_position, std::span<const BlockWrite> writes) -> void;
+
+    // Returns the position of the chunk which the block falls into.
+    [[nodiscard]] static auto target_chunk(const BlockWrite& write) -> glm::ivec3;
+};
@@ -0,0 +1,88 @@
+#include "world/far_terrain.hpp"
+
+#include "world/chunk.hpp"
+#include "world/generator.hpp"
+
+auto generate_far_terrain_mesh(glm::ivec2 column_position, i32 cell_size) -> zth::Vector<BlockVertex>
+{
+    // @multithreaded
+
+    ZTH_ASSERT(cell_size > 0 && chunk_size.x % cell_size == 0 && chunk_size.z % cell_size == 0);
+
+    auto cells_x = chunk_size.x / cell_size;
+    auto cells_z = chunk_size.z / cell_size;
+
+    auto origin_x = chunk_x_to_world_x(column_position.x);
+    auto origin_z = chunk_z_to_world_z(column_position.y);
+
+    // Heights of the cells with a one cell wide apron, so that the sides on the column's borders match the neighboring
+    // columns. Each cell is sampled at its center.
+    zth::Vector<i32> heights(static_cast<usize>((cells_x + 2) * (cells_z + 2)));
+    std::mdspan heights_view{ heights.data(), cells_x + 2, cells_z + 2 };
+
+    for (i32 x = -1; x <= cells_x; x++)
+    {
+        for (i32 z = -1; z <= cells_z; z++)
+        {
+            auto sample_x = origin_x + x * cell_size + cell_size / 2;
+            auto sample_z = origin_z + z * cell_size + cell_size / 2;
+            heights_view[x + 1, z + 1] = WorldGenerator::noise(sample_x, sample_z);
+        }
+    }
+
+    struct Side
+    {
+        glm::ivec2 offset;
+        BlockFacing facing;
+    };
+
+    constexpr std::array sides = {
+        Side{ .offset = { 0, 1 }, .facing = Facing_Backward },
+        Side{ .offset = { 0, -1 }, .facing = Facing_Forward },
+        Side{ .offset = { -1, 0 }, .facing = Facing_Left },
+        Side{ .offset = { 1, 0 }, .facing = Facing_Right },
+    };
+
+    zth::Vector<BlockVertex> result;
+
+    auto size = static_cast<float>(cell_size);
+
+    // Everything the far terrain meshes lies right under the open sky, where the chunks' meshes hold full sky light.
+    // Lighting it the same way keeps it from standing out where it meets them.
+    constexpr auto brightness = light_brightness[full_light];
+
+    for (i32 x = 0; x < cells_x; x++)
+    {
+        for (i32 z = 0; z < cells_z; z++)
+        {
+            // Cells below the sea level are covered by the sea's surface.
+            auto ground_height = heights_view[x + 1, z + 1];
+            auto height = std::max(ground_height, WorldGenerator::sea_level);
+            auto block = ground_height < WorldGenerator::sea_level ? BlockType::Water
+                                                                    : WorldGenerator::surface_block(ground_height);
+
+            auto cell_x = static_cast<float>(x * cell_size);
+            auto cell_z = static_cast<float>(z * cell_size);
+
+            append_box_face(result, block, Facing_Up, { cell_x, static_cast<float>(height), cell_z },
+                            { size, 1.0f, size }, brightness);
+
+            for (const auto& side : sides)
+            {
+                auto neighbor_height =
+                    std::max(heights_view[x + 1 + side.offset.x, z + 1 + side.offset.y], WorldGenerator::sea_level);
+
+                if (neighbor_height >= height)
+                    continue;
+
+                // Covers the blocks from right above the neighbor's surface up to our surface.
+                auto bottom = static_cast<float>(neighbor_height + 1);
+                auto side_height = static_cast<float>(height - neighbor_height);
+                append_box_face(result, block, side.facing, { cell_x, bottom, cell_z },
+                                { size, side_height, size }, brightness);
+            }
+        }
+    }
+
+    return result;
+}
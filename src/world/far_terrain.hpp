@@ -0,0 +1,28 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "world/block_vertex.hpp"
+
+// Column of chunks beyond the full detail distance, rendered only as the surface of the terrain. It never has any chunk
+// data.
+struct FarTerrainComponent
+{
+    glm::ivec2 position{ 0, 0 };
+
+    // The mesh is only handed over to the renderer (through a mesh renderer component) while the column is visible.
+    std::shared_ptr<BlockMesh> mesh = nullptr;
+    Aabb bounds{};       // Bounds of the mesh in world space.
+    usize mesh_size = 0; // In bytes.
+    bool visible = false;
+
+    // Far terrain entities are reused for other columns once they go out of range, like chunk entities. The generation
+    // changes whenever that happens, so that the result of the task which was launched for the previous column can be
+    // told apart.
+    u32 generation = 0;
+};
+
+// Generates the surface mesh of a column of chunks straight from the world generator's height noise. The column is
+// divided into square cells of cell_size blocks, each one meshed as its top face and the sides which are exposed
+// because the neighboring cell is lower. Cells below the sea level are meshed as the surface of the sea.
+[[nodiscard]] auto generate_far_terrain_mesh(glm::ivec2 column_position, i32 cell_size)
+    -> zth::Vector<BlockVertex>;
@@ -0,0 +1,362 @@
+#include "world/fluids.hpp"
+
+#include <future>
+#include <thread>
+
+#include "world/chunk.hpp"
+
+namespace {
+
+// Cells are split between the threads in batches of at least this many.
+constexpr usize min_cells_per_thread = 1024;
+
+constexpr glm::ivec3 up{ 0, 1, 0 };
+
+constexpr std::array<glm::ivec3, 4> side_offsets = {
+    glm::ivec3{ 1, 0, 0 },
+    glm::ivec3{ -1, 0, 0 },
+    glm::ivec3{ 0, 0, 1 },
+    glm::ivec3{ 0, 0, -1 },
+};
+
+[[nodiscard]] auto chunk_of(glm::ivec3 block_position) -> glm::ivec3
+{
+    auto [x, y, z] = block_position;
+    return { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+}
+
+[[nodiscard]] auto chunk_origin(glm::ivec3 chunk_position) -> glm::ivec3
+{
+    auto [x, y, z] = chunk_position;
+    return { chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+}
+
+// Orders the cells by their chunk first, so the cells of a chunk are next to each other.
+[[nodiscard]] auto chunk_major_less(glm::ivec3 a, glm::ivec3 b) -> bool
+{
+    auto key = [](glm::ivec3 position) {
+        auto chunk = chunk_of(position);
+        return std::tuple{ chunk.x, chunk.y, chunk.z, position.x, position.y, position.z };
+    };
+
+    return key(a) < key(b);
+}
+
+// Returns the first and the last coordinate (inclusive) along one axis of the chunk's layer of blocks which borders
+// the neighbor in the given direction.
+[[nodiscard]] auto border_range(i32 direction, i32 size) -> std::pair<i32, i32>
+{
+    if (direction > 0)
+        return { size - 1, size - 1 };
+
+    if (direction < 0)
+        return { 0, 0 };
+
+    return { 0, size - 1 };
+}
+
+// Number of levels the fluid loses with every block it spreads sideways.
+[[nodiscard]] constexpr auto level_decay(BlockType fluid) -> i32
+{
+    return fluid == BlockType::Lava ? 2 : 1;
+}
+
+} // namespace
+
+class FluidSimulation::CellReader
+{
+public:
+    explicit CellReader(const ChunkLookup& lookup, const zth::UnorderedMap<glm::ivec3, u8>& levels)
+        : _lookup(lookup), _levels(levels)
+    {}
+
+    // Returns nil if the cell's chunk isn't loaded.
+    [[nodiscard]] auto get(glm::ivec3 position) -> Optional<Cell>
+    {
+        // @multithreaded
+
+        auto chunk_position = chunk_of(position);
+
+        if (!_cached || chunk_position != _chunk_position)
+        {
+            _chunk = _lookup(chunk_position);
+            _chunk_position = chunk_position;
+            _cached = true;
+        }
+
+        if (!_chunk)
+            return nil;
+
+        auto block = (*_chunk)[position - chunk_origin(chunk_position)];
+
+        if (!is_fluid(block))
+            return Cell{ .block = block, .level = 0 };
+
+        auto level = _levels.find(position);
+        return Cell{ .block = block, .level = level != _levels.end() ? level->second : source_level };
+    }
+
+private:
+    const ChunkLookup& _lookup;
+    const zth::UnorderedMap<glm::ivec3, u8>& _levels;
+
+    glm::ivec3 _chunk_position{ 0, 0, 0 };
+    const ChunkData* _chunk = nullptr;
+    bool _cached = false;
+};
+
+FluidSimulation::FluidSimulation(ChunkLookup lookup, BlockWriter write_blocks)
+    : _lookup(std::move(lookup)), _write_blocks(std::move(write_blocks))
+{}
+
+auto FluidSimulation::block_changed(glm::ivec3 block_position) -> void
+{
+    _levels.erase(block_position);
+    _active_cells.push_back(block_position);
+}
+
+auto FluidSimulation::add_chunk(glm::ivec3 chunk_position) -> void
+{
+    for (auto direction : neighbor_offsets)
+    {
+        auto neighbor_position = chunk_position + direction;
+        auto neighbor = _lookup(neighbor_position);
+
+        if (!neighbor)
+            continue;
+
+        auto origin = chunk_origin(neighbor_position);
+        auto [first_x, last_x] = border_range(-direction.x, chunk_size.x);
+        auto [first_y, last_y] = border_range(-direction.y, chunk_size.y);
+        auto [first_z, last_z] = border_range(-direction.z, chunk_size.z);
+
+        for (auto x = first_x; x <= last_x; x++)
+        {
+            for (auto y = first_y; y <= last_y; y++)
+            {
+                for (auto z = first_z; z <= last_z; z++)
+                {
+                    if (is_fluid((*neighbor)[{ x, y, z }]))
+                        _active_cells.push_back(origin + glm::ivec3{ x, y, z });
+                }
+            }
+        }
+    }
+}
+
+auto FluidSimulation::remove_chunk(glm::ivec3 chunk_position) -> void
+{
+    auto in_chunk = [chunk_position](glm::ivec3 position) { return chunk_of(position) == chunk_position; };
+
+    if (!_levels.empty())
+        std::erase_if(_levels, [&](const auto& kv) { return in_chunk(kv.first); });
+
+    std::erase_if(_active_cells, in_chunk);
+}
+
+auto FluidSimulation::clear() -> void
+{
+    _levels.clear();
+    _active_cells.clear();
+}
+
+auto FluidSimulation::tick(const FrameBudget& budget) -> void
+{
+    _tick++;
+
+    if (step_interval > 0 && _tick % static_cast<u64>(step_interval) == 0)
+        step(budget);
+}
+
+auto FluidSimulation::step(const FrameBudget& budget) -> void
+{
+    auto lava_turn = lava_slowdown <= 1 || _step % static_cast<u64>(lava_slowdown) == 0;
+    _step++;
+
+    if (_active_cells.empty())
+        return;
+
+    std::ranges::sort(_active_cells, chunk_major_less);
+    auto [duplicates_begin, duplicates_end] = std::ranges::unique(_active_cells);
+    _active_cells.erase(duplicates_begin, duplicates_end);
+
+    // The active cells which don't fit into this step stay active. A changed cell affects only its neighbors.
+    auto active_count = std::min(_active_cells.size(), max_active_cells_per_step);
+    _evaluated_cells.clear();
+
+    for (auto position : std::span{ _active_cells }.first(active_count))
+    {
+        _evaluated_cells.push_back(position);
+
+        for (auto offset : neighbor_offsets)
+            _evaluated_cells.push_back(position + offset);
+    }
+
+    _active_cells.erase(_active_cells.begin(), std::next(_active_cells.begin(), static_cast<zth::isize>(active_count)));
+
+    std::ranges::sort(_evaluated_cells, chunk_major_less);
+    auto [evaluated_begin, evaluated_end] = std::ranges::unique(_evaluated_cells);
+    _evaluated_cells.erase(evaluated_begin, evaluated_end);
+
+    // Every thread gets a contiguous range of cells, which thanks to the order covers only a few chunks. The cells are
+    // only read until all of them are evaluated. The calling thread evaluates its share as well.
+    auto max_threads = std::max<usize>(std::thread::hardware_concurrency(), 1);
+    auto thread_count = std::clamp<usize>(_evaluated_cells.size() / min_cells_per_thread, 1, max_threads);
+    auto cells_per_thread = (_evaluated_cells.size() + thread_count - 1) / thread_count;
+
+    _changes.resize(thread_count);
+
+    auto evaluate_range = [&](usize thread) {
+        auto first = thread * cells_per_thread;
+        auto last = std::min(first + cells_per_thread, _evaluated_cells.size());
+
+        CellReader reader{ _lookup, _levels };
+        auto& changes = _changes[thread];
+        changes.clear();
+
+        for (auto i = first; i < last; i++)
+        {
+            if (auto change = evaluate(reader, _evaluated_cells[i], lava_turn))
+                changes.push_back(*change);
+        }
+    };
+
+    zth::Vector<std::future<void>> workers;
+    workers.reserve(thread_count - 1);
+
+    for (usize i = 1; i < thread_count; i++)
+        workers.push_back(std::async(std::launch::async, evaluate_range, i));
+
+    evaluate_range(0);
+
+    for (auto& worker : workers)
+        worker.get();
+
+    // The changes are in the same chunk-major order as the cells, so the changes of a chunk are next to each other
+    // (split in two at most where the range of one thread ends). At least one chunk is written every step, so that the
+    // fluid keeps moving even if the budget is too small.
+    usize chunks_written_already = 0;
+    auto out_of_budget = false;
+
+    for (const auto& changes : _changes)
+    {
+        for (auto first = changes.begin(); first != changes.end();)
+        {
+            auto chunk_position = chunk_of(first->position);
+            auto last = std::find_if(first, changes.end(), [&](const Change& change) {
+                return chunk_of(change.position) != chunk_position;
+            });
+            std::span chunk_changes{ first, last };
+            first = last;
+
+            auto change_count = static_cast<double>(chunk_changes.size());
+
+            if (out_of_budget || (chunks_written_already > 0 && !budget.fits(_write_cost.predict(change_count))))
+            {
+                out_of_budget = true;
+
+                for (const auto& change : chunk_changes)
+                    _active_cells.push_back(change.position);
+
+                continue;
+            }
+
+            auto started_at = budget.elapsed();
+            apply_changes(chunk_position, chunk_changes);
+            _write_cost.add(change_count, budget.elapsed() - started_at);
+            chunks_written_already++;
+        }
+    }
+}
+
+auto FluidSimulation::apply_changes(glm::ivec3 chunk_position, std::span<const Change> changes) -> void
+{
+    // Writing the blocks relights them and marks the chunk for remeshing, which is done once for the whole tick by the
+    // owner of the block writer. Changes of the level alone aren't visible, they only keep the cell active.
+    _writes.clear();
+
+    for (const auto& [position, from, to] : changes)
+    {
+        if (to.block != from.block)
+            _writes.push_back(BlockWrite{ .position = position, .block = to.block, .replaces = from.block });
+    }
+
+    if (!_writes.empty() && !_write_blocks(chunk_position, _writes))
+        return;
+
+    for (const auto& [position, from, to] : changes)
+    {
+        if (to.block == from.block)
+            _active_cells.push_back(position);
+
+        if (is_fluid(to.block) && to.level < source_level)
+            _levels.insert_or_assign(position, to.level);
+        else
+            _levels.erase(position);
+    }
+}
+
+auto FluidSimulation::evaluate(CellReader& reader, glm::ivec3 position, bool lava_turn) -> Optional<Change>
+{
+    // @multithreaded
+
+    auto current = reader.get(position);
+
+    if (!current || is_solid(current->block))
+        return nil;
+
+    auto touches_water = std::ranges::any_of(neighbor_offsets, [&](glm::ivec3 offset) {
+        auto neighbor = reader.get(position + offset);
+        return neighbor && neighbor->block == BlockType::Water;
+    });
+
+    Cell next;
+
+    if (is_fluid(current->block) && current->level == source_level)
+    {
+        // Sources never drain.
+        next = *current;
+    }
+    else
+    {
+        auto offer = [&](BlockType fluid, i32 level) {
+            if (level > next.level)
+                next = Cell{ .block = fluid, .level = static_cast<u8>(level) };
+        };
+
+        // Falling fluid is almost as high as a source, so it spreads out again wherever it lands.
+        if (auto above = reader.get(position + up); above && is_fluid(above->block))
+            offer(above->block, source_level - 1);
+
+        for (auto offset : side_offsets)
+        {
+            auto side = reader.get(position + offset);
+
+            if (!side || !is_fluid(side->block))
+                continue;
+
+            // Fluid only spreads sideways once it can't fall any further, i.e. when it lies on a solid block or on a
+            // source.
+            auto below_side = reader.get(position + offset - up);
+
+            if (!below_side || below_side->block == BlockType::Air
+                || (below_side->block == side->block && below_side->level < source_level))
+            {
+                continue;
+            }
+
+            offer(side->block, side->level - level_decay(side->block));
+        }
+    }
+
+    if ((current->block == BlockType::Lava || next.block == BlockType::Lava) && touches_water)
+        next = Cell{ .block = BlockType::Stone, .level = 0 };
+
+    if (next.block == current->block && next.level == current->level)
+        return nil;
+
+    if (!lava_turn && (current->block == BlockType::Lava || next.block == BlockType::Lava))
+        return Change{ .position = position, .from = *current, .to = *current };
+
+    return Change{ .position = position, .from = *current, .to = next };
+}
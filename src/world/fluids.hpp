@@ -0,0 +1,104 @@
+#pragma once
+
+#include "frame_budget.hpp"
+#include "hash.hpp"
+#include "world/block.hpp"
+#include "world/raycast.hpp"
+#include "world/ticks.hpp"
+
+// Changes several blocks of a single loaded chunk at once, returns false if the chunk isn't loaded. The changes have to
+// be reported back to the fluid simulation through block_changed.
+using BlockWriter = std::function<bool(glm::ivec3 chunk_position, std::span<const BlockWrite> writes)>;
+
+// Simulates water and lava as a cellular automaton over the loaded chunks. Every fluid block has a level: sources are
+// full and never drain, flowing fluid is as high as the highest fluid flowing into it. Fluid falls down whenever it can
+// and spreads sideways otherwise, losing a level (water) or two (lava) with every block. Lava which touches water turns
+// into stone.
+//
+// Only the cells which changed since the last step are active, in a sparse set of world positions which doesn't care
+// about the borders between chunks. A step evaluates just the active cells and their neighbors, so its cost depends on
+// the moving front of the fluid, not on the size of the lakes it fills. Every evaluated cell works out its next state
+// only from the current state of its neighbors, so the cells are evaluated in parallel without any locks, grouped by
+// the chunk they lie in, and the changes are applied afterwards on the calling thread.
+//
+// The changes are written one chunk at a time, so that every chunk is relit only once per step however many of its
+// blocks changed. Writing stops once the frame's time budget runs out, and the cells whose changes weren't written stay
+// active, so they're evaluated again on the next step.
+class FluidSimulation
+{
+public:
+    // A step runs every step_interval ticks, and lava only moves on every lava_slowdown-th step.
+    i32 step_interval = 5;
+    i32 lava_slowdown = 3;
+
+    // Bounds the work of a single step during large floods. The active cells which don't fit wait for the next step,
+    // which slows the fluid down instead of stalling the frame.
+    usize max_active_cells_per_step = 4096;
+
+    static constexpr u8 source_level = 8;
+
+public:
+    explicit FluidSimulation(ChunkLookup lookup, BlockWriter write_blocks);
+
+    ZTH_NO_COPY(FluidSimulation)
+    ZTH_DEFAULT_MOVE(FluidSimulation)
+
+    ~FluidSimulation() = default;
+
+    // Has to be called whenever a block of a loaded chunk changes, including the changes made by the simulation. A
+    // fluid block placed from outside the simulation is a source.
+    auto block_changed(glm::ivec3 block_position) -> void;
+    // Wakes up the fluid along the borders of the chunk's loaded neighbors, so that it flows into the chunk.
+    auto add_chunk(glm::ivec3 chunk_position) -> void;
+    auto remove_chunk(glm::ivec3 chunk_position) -> void;
+    auto clear() -> void;
+
+    auto tick(const FrameBudget& budget) -> void;
+
+    [[nodiscard]] auto active_cells() const -> usize { return _active_cells.size(); }
+    [[nodiscard]] auto flowing_cells() const -> usize { return _levels.size(); }
+
+private:
+    struct Cell
+    {
+        BlockType block = BlockType::Air;
+        u8 level = 0;
+    };
+
+    struct Change
+    {
+        glm::ivec3 position;
+        Cell from;
+        Cell to;
+    };
+
+    // Reads the cells of the loaded chunks, caching the last chunk it looked up.
+    class CellReader;
+
+    ChunkLookup _lookup;
+    BlockWriter _write_blocks;
+
+    // Levels of the flowing fluid. Fluid blocks which don't have one are sources.
+    zth::UnorderedMap<glm::ivec3, u8> _levels;
+    // Cells which changed since they were last evaluated.
+    zth::Vector<glm::ivec3> _active_cells;
+
+    u64 _tick = 0;
+    u64 _step = 0;
+
+    // Reused every step.
+    zth::Vector<glm::ivec3> _evaluated_cells;
+    zth::Vector<zth::Vector<Change>> _changes;
+    zth::Vector<BlockWrite> _writes;
+
+    // Measured cost of writing the changes of a chunk, by their number.
+    CostModel _write_cost{ std::chrono::microseconds{ 50 } };
+
+private:
+    auto step(const FrameBudget& budget) -> void;
+    // Writes the changes of a single chunk.
+    auto apply_changes(glm::ivec3 chunk_position, std::span<const Change> changes) -> void;
+    // Returns nil if the cell stays as it is. Changes which lava would make outside of its turn are returned with the
+    // cell staying as it is, so that the cell is evaluated again on the next step.
+    [[nodiscard]] static auto evaluate(CellReader& reader, glm::ivec3 position, bool lava_turn) -> Optional<Change>;
+};
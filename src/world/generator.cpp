@@ -1,37 +1,316 @@
 #include "world/generator.hpp"
 
+#include <glm/gtc/noise.hpp>
+
 #include "world/chunk.hpp"
 
-auto WorldGenerator::generate(glm::ivec2 chunk_position) -> std::shared_ptr<ChunkData>
+namespace {
+
+// The overhang and cave noise is sampled for a few blocks above the chunk as well, so the strata stage knows how deep
+// below the open air the chunk's topmost blocks lie.
+constexpr i32 strata_depth = 4;
+
+constexpr glm::ivec3 field_size{ chunk_size.x, chunk_size.y + strata_depth, chunk_size.z };
+constexpr i32 blocks_in_field = field_size.x * field_size.y * field_size.z;
+
+constexpr glm::ivec3 lattice_size{
+    field_size.x / WorldGenerator::lattice_step + 1,
+    field_size.y / WorldGenerator::lattice_step + 1,
+    field_size.z / WorldGenerator::lattice_step + 1,
+};
+constexpr i32 points_in_lattice = lattice_size.x * lattice_size.y * lattice_size.z;
+
+static_assert(field_size.x % WorldGenerator::lattice_step == 0);
+static_assert(field_size.y % WorldGenerator::lattice_step == 0);
+static_assert(field_size.z % WorldGenerator::lattice_step == 0);
+
+using Lattice = std::array<float, points_in_lattice>;
+using Field = std::array<float, blocks_in_field>;
+
+// Every noise gets its own stream, which the seed maps onto a different part of the noise.
+constexpr u32 overhang_stream = 0x100;
+constexpr u32 cave_stream = 0x101;
+
+[[nodiscard]] auto seed_offset(u32 stream) -> glm::vec3
+{
+    // @multithreaded
+
+    // SplitMix64 finalizer.
+    auto hash = ((static_cast<u64>(WorldGenerator::seed) << 32) | stream) + 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    hash ^= hash >> 31;
+
+    // Kept small enough that the sample positions don't lose float precision.
+    auto component = [&](i32 shift) {
+        auto bits = static_cast<float>((hash >> shift) & 0x1fffff);
+        return bits / static_cast<float>(0x200000) * 1024.0f;
+    };
+
+    return { component(0), component(21), component(42) };
+}
+
+// Evaluates the 3D noise at the lattice points of a chunk, which lie lattice_step blocks apart starting at the chunk's
+// first block.
+auto evaluate_lattice(Lattice& lattice, glm::ivec3 chunk_start, float scale, u32 stream) -> void
+{
+    // @multithreaded
+
+    auto offset = seed_offset(stream);
+    std::mdspan view{ lattice.data(), lattice_size.x, lattice_size.y, lattice_size.z };
+
+    for (i32 x = 0; x < lattice_size.x; x++)
+    {
+        for (i32 y = 0; y < lattice_size.y; y++)
+        {
+            for (i32 z = 0; z < lattice_size.z; z++)
+            {
+                auto position = glm::vec3{ chunk_start + glm::ivec3{ x, y, z } * WorldGenerator::lattice_step };
+                view[x, y, z] = glm::perlin(position * scale + offset);
+            }
+        }
+    }
+}
+
+// Unlike std::lerp, this doesn't branch, so the loops using it get vectorized.
+[[nodiscard]] constexpr auto mix(float from, float to, float t) -> float
+{
+    return from + (to - from) * t;
+}
+
+// Trilinearly interpolates the lattice into a value per block. The interpolation is split into one pass per axis, and
+// every pass runs its innermost loop over contiguous z values with the same weights, so the compiler vectorizes them.
+auto interpolate_lattice(const Lattice& lattice, Field& field) -> void
+{
+    // @multithreaded
+
+    constexpr auto step = WorldGenerator::lattice_step;
+
+    // Weight of the next lattice point for each block between two lattice points.
+    constexpr auto weights = [] {
+        std::array<float, step> result{};
+
+        for (i32 i = 0; i < step; i++)
+            result[static_cast<usize>(i)] = static_cast<float>(i) / static_cast<float>(step);
+
+        return result;
+    }();
+
+    auto weight = [&](i32 i) { return weights[static_cast<usize>(i % step)]; };
+
+    std::array<float, lattice_size.x * lattice_size.y * field_size.z> along_z;
+    std::array<float, lattice_size.x * field_size.y * field_size.z> along_y;
+
+    std::mdspan lattice_view{ lattice.data(), lattice_size.x, lattice_size.y, lattice_size.z };
+    std::mdspan along_z_view{ along_z.data(), lattice_size.x, lattice_size.y, field_size.z };
+    std::mdspan along_y_view{ along_y.data(), lattice_size.x, field_size.y, field_size.z };
+    std::mdspan field_view{ field.data(), field_size.x, field_size.y, field_size.z };
+
+    for (i32 x = 0; x < lattice_size.x; x++)
+    {
+        for (i32 y = 0; y < lattice_size.y; y++)
+        {
+            for (i32 z = 0; z < field_size.z; z++)
+            {
+                auto from = lattice_view[x, y, z / step];
+                auto to = lattice_view[x, y, z / step + 1];
+                along_z_view[x, y, z] = mix(from, to, weight(z));
+            }
+        }
+    }
+
+    for (i32 x = 0; x < lattice_size.x; x++)
+    {
+        for (i32 y = 0; y < field_size.y; y++)
+        {
+            auto t = weight(y);
+
+            for (i32 z = 0; z < field_size.z; z++)
+                along_y_view[x, y, z] = mix(along_z_view[x, y / step, z], along_z_view[x, y / step + 1, z], t);
+        }
+    }
+
+    for (i32 x = 0; x < field_size.x; x++)
+    {
+        auto t = weight(x);
+
+        for (i32 y = 0; y < field_size.y; y++)
+        {
+            for (i32 z = 0; z < field_size.z; z++)
+                field_view[x, y, z] = mix(along_y_view[x / step, y, z], along_y_view[x / step + 1, y, z], t);
+        }
+    }
+}
+
+// Block at the given depth below the open air, in a column with its surface at the given height.
+[[nodiscard]] auto block_below_surface(i32 depth, i32 surface_height) -> BlockType
+{
+    if (depth < 0)
+        return BlockType::Air;
+    else if (depth == 0)
+        return WorldGenerator::surface_block(surface_height);
+    else if (depth < 4)
+        return surface_height <= WorldGenerator::beach_height ? BlockType::Sand : BlockType::Dirt;
+    else
+        return BlockType::Stone;
+}
+
+} // namespace
+
+HeightMap::HeightMap(glm::ivec2 origin, glm::ivec2 size)
+    : _origin(origin), _size(size), _heights(static_cast<usize>(size.x) * static_cast<usize>(size.y))
+{
+    // @multithreaded
+
+    for (i32 x = 0; x < size.x; x++)
+    {
+        for (i32 z = 0; z < size.y; z++)
+            _heights[static_cast<usize>(x * size.y + z)] = WorldGenerator::noise(origin.x + x, origin.y + z);
+    }
+}
+
+auto HeightMap::covering(std::span<const glm::ivec3> chunk_positions) -> HeightMap
+{
+    // @multithreaded
+
+    ZTH_ASSERT(!chunk_positions.empty());
+
+    auto min = glm::ivec2{ chunk_positions.front().x, chunk_positions.front().z };
+    auto max = min;
+
+    for (auto chunk_position : chunk_positions)
+    {
+        min = glm::min(min, glm::ivec2{ chunk_position.x, chunk_position.z });
+        max = glm::max(max, glm::ivec2{ chunk_position.x, chunk_position.z });
+    }
+
+    return HeightMap{ { chunk_x_to_world_x(min.x), chunk_z_to_world_z(min.y) },
+                      (max - min + 1) * glm::ivec2{ chunk_size.x, chunk_size.z } };
+}
+
+auto HeightMap::at(i32 world_x, i32 world_z) const -> i32
+{
+    auto x = world_x - _origin.x;
+    auto z = world_z - _origin.y;
+    ZTH_ASSERT(x >= 0 && x < _size.x && z >= 0 && z < _size.y);
+    return _heights[static_cast<usize>(x * _size.y + z)];
+}
+
+auto WorldGenerator::generate(glm::ivec3 chunk_position) -> std::shared_ptr<ChunkData>
+{
+    // @multithreaded
+
+    HeightMap heights{ { chunk_x_to_world_x(chunk_position.x), chunk_z_to_world_z(chunk_position.z) },
+                       { chunk_size.x, chunk_size.z } };
+    return generate(chunk_position, heights);
+}
+
+auto WorldGenerator::generate(glm::ivec3 chunk_position, const HeightMap& heights) -> std::shared_ptr<ChunkData>
 {
     // @multithreaded
 
     auto chunk_data = std::make_shared_for_overwrite<ChunkData>();
+    auto& data = *chunk_data;
+
+    auto [chunk_pos_x, chunk_pos_y, chunk_pos_z] = chunk_position;
+    glm::ivec3 chunk_start{ chunk_x_to_world_x(chunk_pos_x), chunk_y_to_world_y(chunk_pos_y),
+                            chunk_z_to_world_z(chunk_pos_z) };
 
-    auto [chunk_pos_x, chunk_pos_z] = chunk_position;
-    auto chunk_start_x = chunk_x_to_world_x(chunk_pos_x);
-    auto chunk_start_z = chunk_z_to_world_z(chunk_pos_z);
+    // --- Surface ---
+    std::array<i32, static_cast<usize>(chunk_size.x * chunk_size.z)> surface;
+    std::mdspan surface_view{ surface.data(), chunk_size.x, chunk_size.z };
 
-    // @speed: We're iterating over the blocks in a not cache-efficient way.
     for (i32 x = 0; x < chunk_size.x; x++)
     {
         for (i32 z = 0; z < chunk_size.z; z++)
+            surface_view[x, z] = heights.at(chunk_start.x + x, chunk_start.z + z);
+    }
+
+    auto [lowest, highest] = std::ranges::minmax(surface);
+    auto overhang = static_cast<i32>(std::ceil(std::max(overhang_amplitude, 0.0f)));
+
+    // Chunks which lie entirely above the surface (overhangs included) and the sea are only air, and chunks which lie
+    // deep enough below the surface without any caves are only stone. Neither needs the density noise.
+    if (chunk_start.y > std::max(highest + overhang, sea_level))
+    {
+        data.blocks().fill(BlockType::Air);
+        return chunk_data;
+    }
+
+    auto field_top = chunk_start.y + field_size.y - 1;
+
+    if (!caves_enabled && field_top < lowest - overhang)
+    {
+        data.blocks().fill(BlockType::Stone);
+        return chunk_data;
+    }
+
+    // --- Density ---
+    Lattice lattice;
+    Field overhang_field;
+    Field cave_field;
+
+    if (overhang > 0)
+    {
+        evaluate_lattice(lattice, chunk_start, overhang_scale, overhang_stream);
+        interpolate_lattice(lattice, overhang_field);
+    }
+    else
+    {
+        overhang_field.fill(0.0f);
+    }
+
+    // Caves stay cave_min_depth below the surface, so chunks which lie above that in every column don't need the cave
+    // noise.
+    auto has_caves = caves_enabled && chunk_start.y < highest - cave_min_depth;
+
+    if (has_caves)
+    {
+        evaluate_lattice(lattice, chunk_start, cave_scale, cave_stream);
+        interpolate_lattice(lattice, cave_field);
+    }
+
+    std::mdspan overhang_view{ overhang_field.data(), field_size.x, field_size.y, field_size.z };
+    std::mdspan cave_view{ cave_field.data(), field_size.x, field_size.y, field_size.z };
+
+    // --- Strata ---
+    // Walks every column from the top down, counting how many solid blocks lie between a block and the open air above
+    // it. The blocks above the sampled part of the columns are assumed to be solid, which only matters for chunks deep
+    // enough below the surface to be made of stone anyway.
+    for (i32 x = 0; x < chunk_size.x; x++)
+    {
+        std::array<i32, static_cast<usize>(chunk_size.z)> depths;
+        depths.fill(strata_depth);
+
+        for (auto y = field_size.y - 1; y >= 0; y--)
         {
-            auto height = noise(chunk_start_x + x, chunk_start_z + z);
+            auto world_y = chunk_start.y + y;
 
-            for (i32 y = 0; y < chunk_size.y; y++)
+            for (i32 z = 0; z < chunk_size.z; z++)
             {
-                glm::ivec3 coords{ x, y, z };
-                auto& data = *chunk_data;
-
-                if (y > height)
-                    data[coords] = BlockType::Air;
-                else if (y == height)
-                    data[coords] = BlockType::Grass;
-                else if (y > height - 4)
-                    data[coords] = BlockType::Dirt;
+                auto height = surface_view[x, z];
+                auto& depth = depths[static_cast<usize>(z)];
+
+                auto density = static_cast<float>(height - world_y) + overhang_amplitude * overhang_view[x, y, z];
+                auto solid = world_y <= height + overhang && density >= 0.0f;
+                auto carved = solid && has_caves && world_y < height - cave_min_depth
+                              && cave_view[x, y, z] > cave_threshold;
+
+                if (carved)
+                    solid = false;
+
+                depth = solid ? depth + 1 : -1;
+
+                if (y >= chunk_size.y)
+                    continue;
+
+                // The floors of caves stay bare stone.
+                if (solid && world_y < height - cave_min_depth)
+                    data[glm::ivec3{ x, y, z }] = BlockType::Stone;
+                else if (!solid && !carved && world_y <= sea_level)
+                    data[glm::ivec3{ x, y, z }] = BlockType::Water;
                 else
-                    data[coords] = BlockType::Stone;
+                    data[glm::ivec3{ x, y, z }] = block_below_surface(depth, height);
             }
         }
     }
@@ -39,13 +318,64 @@ auto WorldGenerator::generate(glm::ivec2 chunk_position) -> std::shared_ptr<Chun
     return chunk_data;
 }
 
+auto WorldGenerator::generate_region(std::span<const glm::ivec3> chunk_positions)
+    -> zth::Vector<std::shared_ptr<ChunkData>>
+{
+    // @multithreaded
+
+    if (chunk_positions.empty())
+        return {};
+
+    return generate_region(chunk_positions, HeightMap::covering(chunk_positions));
+}
+
+auto WorldGenerator::generate_region(std::span<const glm::ivec3> chunk_positions, const HeightMap& heights)
+    -> zth::Vector<std::shared_ptr<ChunkData>>
+{
+    // @multithreaded
+
+    zth::Vector<std::shared_ptr<ChunkData>> result;
+    result.reserve(chunk_positions.size());
+
+    // The chunks are filled on the calling thread. Every caller is a task of its own already, and spawning threads per
+    // region would multiply the number of threads by the number of running tasks.
+    for (auto chunk_position : chunk_positions)
+        result.push_back(generate(chunk_position, heights));
+
+    return result;
+}
+
 auto WorldGenerator::noise(i32 world_x, i32 world_z) -> i32
 {
-    glm::vec2 position{ world_x, world_z };
-    position *= scale;
+    // @multithreaded
+
+    auto position = glm::vec2{ world_x, world_z } * scale;
+    auto sum = 0.0f;
+    auto amplitude = 1.0f;
+    auto total_amplitude = 0.0f;
+
+    for (i32 octave = 0; octave < std::max(octaves, 1); octave++)
+    {
+        auto offset = glm::vec2{ seed_offset(static_cast<u32>(octave)) };
+        sum += zth::Random::perlin_noise(position + offset) * amplitude;
+        total_amplitude += amplitude;
+
+        position *= lacunarity;
+        amplitude *= persistence;
+    }
 
-    auto noise = zth::Random::perlin_noise(position) * 0.5f + 0.5f;
+    auto noise = sum / total_amplitude * 0.5f + 0.5f;
     auto height = std::lerp(min_height, max_height, noise);
 
-    return static_cast<i32>(height * static_cast<float>(chunk_size.y));
+    return static_cast<i32>(height * static_cast<float>(terrain_height));
+}
+
+auto WorldGenerator::surface_block(i32 surface_height) -> BlockType
+{
+    return surface_height <= beach_height ? BlockType::Sand : BlockType::Grass;
+}
+
+auto WorldGenerator::sky_height(i32 surface_height) -> i32
+{
+    return surface_height + static_cast<i32>(std::ceil(std::max(overhang_amplitude, 0.0f))) + 1;
 }
@@ -2,18 +2,103 @@
 
 #include "fwd.hpp"
 
+#include "world/block.hpp"
+
+// Heights of the terrain's surface over a rectangle of world columns. Evaluating the noise is the expensive part of
+// generating a chunk, so the heights are evaluated once and shared by all the chunks stacked above the same columns.
+class HeightMap
+{
+public:
+    // Evaluates the heights of size.x by size.y columns, starting at the world column origin (x, z).
+    explicit HeightMap(glm::ivec2 origin, glm::ivec2 size);
+
+    // Covers all the columns of the chunks.
+    [[nodiscard]] static auto covering(std::span<const glm::ivec3> chunk_positions) -> HeightMap;
+
+    // The column has to lie within the rectangle.
+    [[nodiscard]] auto at(i32 world_x, i32 world_z) const -> i32;
+
+    [[nodiscard]] auto origin() const -> glm::ivec2 { return _origin; }
+    [[nodiscard]] auto size() const -> glm::ivec2 { return _size; }
+
+private:
+    glm::ivec2 _origin;
+    glm::ivec2 _size;
+    zth::Vector<i32> _heights; // Laid out with z changing the fastest.
+};
+
+// Chunks are generated in stages:
+// 1. Surface: the height of every column, from a few octaves of 2D noise (see HeightMap).
+// 2. Density: 3D noise which bends the surface into overhangs and carves caves out of the ground. It's only evaluated
+//    on a coarse lattice of points lattice_step blocks apart and trilinearly interpolated in between, and not at all
+//    for chunks which lie entirely above the surface.
+// 3. Strata: the solid blocks become grass, dirt or stone depending on how deep below the open air they lie. Low lying
+//    columns are covered with sand instead of grass and dirt, and the open air below the sea level is filled with
+//    water. Caves stay dry.
+// 4. Decoration: features like trees and ore veins, which may reach into the neighboring chunks. It's run separately,
+//    see decoration.hpp.
+//
+// Generation only depends on the settings below and on the chunk's position, so chunks can be generated on any number
+// of threads in any order and the world always comes out the same. The settings must not change while chunks are being
+// generated.
 class WorldGenerator
 {
 public:
+    // Worlds generated with the same seed are identical.
+    static inline u32 seed = 0;
+    // Has to be bumped whenever a change makes the generator produce different chunks for the same seed, so that the
+    // chunks stored by older versions are generated again.
+    static constexpr u32 version = 3;
+
     static inline float scale = 0.015f;
+    static inline i32 octaves = 4;
+    static inline float lacunarity = 2.0f;  // Frequency multiplier between successive octaves.
+    static inline float persistence = 0.5f; // Amplitude multiplier between successive octaves.
+    // Minimum and maximum terrain heights as fractions of terrain_height.
     static inline float min_height = 0.3f;
     static inline float max_height = 0.45f;
+    static inline i32 terrain_height = 256;
+    // Columns whose surface lies at most this high are covered with sand.
+    static inline i32 beach_height = 90;
+    // Height of the topmost block of the sea.
+    static inline i32 sea_level = 88;
+
+    // How far (in blocks) the overhang noise can move the surface up or down.
+    static inline float overhang_scale = 0.04f;
+    static inline float overhang_amplitude = 6.0f;
+
+    // Caves are carved where the cave noise exceeds the threshold, but never closer to the surface than
+    // cave_min_depth.
+    static inline bool caves_enabled = true;
+    static inline float cave_scale = 0.05f;
+    static inline float cave_threshold = 0.45f;
+    static inline i32 cave_min_depth = 6;
+
+    static constexpr i32 lattice_step = 4;
 
 public:
     WorldGenerator() = delete;
 
-    [[nodiscard]] static auto generate(glm::ivec2 chunk_position) -> std::shared_ptr<ChunkData>;
+    [[nodiscard]] static auto generate(glm::ivec3 chunk_position) -> std::shared_ptr<ChunkData>;
+    // The height map has to cover all the columns of the chunk.
+    [[nodiscard]] static auto generate(glm::ivec3 chunk_position, const HeightMap& heights)
+        -> std::shared_ptr<ChunkData>;
 
-private:
+    // Generates a group of chunks which lie close to each other, e.g. a few columns of chunks. The heights of all the
+    // columns the chunks cover are evaluated only once, and then the chunks are filled one after another on the calling
+    // thread. The result holds the chunks in the same order as the positions.
+    [[nodiscard]] static auto generate_region(std::span<const glm::ivec3> chunk_positions)
+        -> zth::Vector<std::shared_ptr<ChunkData>>;
+    // The height map has to cover all the columns of the chunks.
+    [[nodiscard]] static auto generate_region(std::span<const glm::ivec3> chunk_positions, const HeightMap& heights)
+        -> zth::Vector<std::shared_ptr<ChunkData>>;
+
+    // Returns the height of the terrain's surface (the y coordinate of the topmost block) at the given world column,
+    // not counting overhangs.
     [[nodiscard]] static auto noise(i32 world_x, i32 world_z) -> i32;
+    // Returns the block at the top of a column, given the height of its surface.
+    [[nodiscard]] static auto surface_block(i32 surface_height) -> BlockType;
+    // Returns the lowest y coordinate above which the column is open to the sky, given the height of its surface.
+    // Overhangs can rise above the surface, but never above this.
+    [[nodiscard]] static auto sky_height(i32 surface_height) -> i32;
 };
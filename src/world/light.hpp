@@ -0,0 +1,42 @@
+#pragma once
+
+// Every block holds two light levels from 0 to max_light packed into a byte: sky light in the high nibble and block
+// light (emitted by blocks) in the low nibble. Only transparent blocks and blocks which emit light hold any light.
+constexpr inline u8 max_light = 15;
+
+[[nodiscard]] constexpr auto sky_light(u8 light) -> u8
+{
+    return static_cast<u8>(light >> 4);
+}
+
+[[nodiscard]] constexpr auto block_light(u8 light) -> u8
+{
+    return static_cast<u8>(light & 0xf);
+}
+
+[[nodiscard]] constexpr auto pack_light(u8 sky, u8 block) -> u8
+{
+    return static_cast<u8>((sky << 4) | block);
+}
+
+// Light of the blocks around the world's edges and around chunks which aren't loaded.
+constexpr inline u8 full_light = pack_light(max_light, 0);
+
+// Indexed with the packed light, every level of light is 20% darker than the one above it.
+constexpr inline auto light_brightness = [] {
+    std::array<float, std::numeric_limits<u8>::max() + 1> levels{};
+    levels[max_light] = 1.0f;
+
+    for (auto level = max_light; level > 0; level--)
+        levels[level - 1u] = levels[level] * 0.8f;
+
+    std::array<float, std::numeric_limits<u8>::max() + 1> result{};
+
+    for (usize light = 0; light < result.size(); light++)
+    {
+        auto packed = static_cast<u8>(light);
+        result[light] = std::max(levels[sky_light(packed)], levels[block_light(packed)]);
+    }
+
+    return result;
+}();
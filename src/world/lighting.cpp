@@ -0,0 +1,326 @@
+#include "world/lighting.hpp"
+
+#include "world/chunk.hpp"
+#include "world/generator.hpp"
+
+namespace {
+
+[[nodiscard]] auto chunk_origin(glm::ivec3 chunk_position) -> glm::ivec3
+{
+    auto [x, y, z] = chunk_position;
+    return { chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+}
+
+[[nodiscard]] auto chunk_of(glm::ivec3 block_position) -> glm::ivec3
+{
+    auto [x, y, z] = block_position;
+    return { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+}
+
+// Returns the first and the last coordinate (inclusive) along one axis of the chunk's layer of blocks which borders
+// the neighbor in the given direction.
+[[nodiscard]] auto border_range(i32 direction, i32 size) -> std::pair<i32, i32>
+{
+    if (direction > 0)
+        return { size - 1, size - 1 };
+
+    if (direction < 0)
+        return { 0, 0 };
+
+    return { 0, size - 1 };
+}
+
+} // namespace
+
+auto light_chunk(ChunkData& chunk, glm::ivec3 chunk_position, const HeightMap& heights) -> void
+{
+    // @multithreaded
+
+    auto origin = chunk_origin(chunk_position);
+    auto top = origin.y + chunk_size.y - 1;
+
+    auto open_to_sky = [&](i32 x, i32 z, i32 y) {
+        return y >= WorldGenerator::sky_height(heights.at(origin.x + x, origin.z + z));
+    };
+
+    // Chunks which lie entirely in the open sky are fully lit without any flood fill, unless they hold some features
+    // (see decoration.hpp), which rise above the sky height.
+    auto all_open_to_sky = chunk.empty();
+
+    for (i32 x = 0; x < chunk_size.x && all_open_to_sky; x++)
+    {
+        for (i32 z = 0; z < chunk_size.z && all_open_to_sky; z++)
+            all_open_to_sky = open_to_sky(x, z, origin.y);
+    }
+
+    if (all_open_to_sky)
+    {
+        std::ranges::fill(chunk.lights(), full_light);
+        return;
+    }
+
+    std::ranges::fill(chunk.lights(), u8{ 0 });
+
+    LightPropagator propagator{ [&chunk, chunk_position](glm::ivec3 position) {
+        return position == chunk_position ? &chunk : nullptr;
+    } };
+
+    // Sky light shines straight down the open columns until it hits a block, then it spreads sideways from there.
+    for (i32 x = 0; x < chunk_size.x; x++)
+    {
+        for (i32 z = 0; z < chunk_size.z; z++)
+        {
+            if (!open_to_sky(x, z, top))
+                continue;
+
+            for (auto y = chunk_size.y - 1; y >= 0 && !is_opaque(chunk[{ x, y, z }]); y--)
+            {
+                chunk.light({ x, y, z }) = full_light;
+                propagator.add_source(origin + glm::ivec3{ x, y, z });
+            }
+        }
+    }
+
+    for (i32 x = 0; x < chunk_size.x; x++)
+    {
+        for (i32 y = 0; y < chunk_size.y; y++)
+        {
+            for (i32 z = 0; z < chunk_size.z; z++)
+            {
+                if (auto emission = light_emission(chunk[{ x, y, z }]); emission > 0)
+                {
+                    auto& light = chunk.light({ x, y, z });
+                    light = pack_light(sky_light(light), emission);
+                    propagator.add_source(origin + glm::ivec3{ x, y, z });
+                }
+            }
+        }
+    }
+
+    propagator.propagate();
+}
+
+LightPropagator::LightPropagator(MutableChunkLookup lookup) : _lookup(std::move(lookup)) {}
+
+auto LightPropagator::stitch_chunk(glm::ivec3 chunk_position) -> void
+{
+    _cache_valid = false;
+
+    auto origin = chunk_origin(chunk_position);
+
+    for (auto direction : neighbor_offsets)
+    {
+        if (!_lookup(chunk_position + direction))
+            continue;
+
+        // Both layers of blocks along the border spread their light across it.
+        auto [first_x, last_x] = border_range(direction.x, chunk_size.x);
+        auto [first_y, last_y] = border_range(direction.y, chunk_size.y);
+        auto [first_z, last_z] = border_range(direction.z, chunk_size.z);
+
+        for (auto x = first_x; x <= last_x; x++)
+        {
+            for (auto y = first_y; y <= last_y; y++)
+            {
+                for (auto z = first_z; z <= last_z; z++)
+                {
+                    auto position = origin + glm::ivec3{ x, y, z };
+                    add_source(position);
+                    add_source(position + direction);
+                }
+            }
+        }
+    }
+
+    propagate();
+}
+
+auto LightPropagator::update_block(glm::ivec3 block_position) -> void
+{
+    update_blocks({ &block_position, 1 });
+}
+
+auto LightPropagator::update_blocks(std::span<const glm::ivec3> block_positions) -> void
+{
+    _cache_valid = false;
+
+    // Takes away the light which the blocks held or emitted, along with all the light which came from them.
+    for (auto block_position : block_positions)
+    {
+        auto [chunk, coordinates] = locate(block_position);
+
+        if (!chunk)
+            continue;
+
+        auto& light = chunk->light(coordinates);
+
+        for (auto channel : { Channel::Sky, Channel::Block })
+        {
+            if (auto level = get_level(light, channel); level > 0)
+            {
+                auto& queue = _removal_queues[std::to_underlying(channel)];
+                queue.push_back(Removal{ .position = block_position, .level = level });
+            }
+        }
+
+        light = 0;
+        mark_changed(block_position);
+    }
+
+    for (auto channel : { Channel::Sky, Channel::Block })
+        propagate_removals(channel);
+
+    // Lets the light back in.
+    for (auto block_position : block_positions)
+    {
+        auto [chunk, coordinates] = locate(block_position);
+
+        if (!chunk)
+            continue;
+
+        auto block = (*chunk)[coordinates];
+
+        if (!is_opaque(block))
+        {
+            for (auto offset : neighbor_offsets)
+                add_source(block_position + offset);
+        }
+
+        if (auto emission = light_emission(block); emission > 0)
+        {
+            auto& light = chunk->light(coordinates);
+            light = set_level(light, Channel::Block, emission);
+            add_source(block_position);
+        }
+    }
+
+    propagate();
+}
+
+auto LightPropagator::add_source(glm::ivec3 block_position) -> void
+{
+    for (auto& queue : _add_queues)
+        queue.push_back(block_position);
+}
+
+auto LightPropagator::propagate() -> void
+{
+    _cache_valid = false;
+
+    for (auto channel : { Channel::Sky, Channel::Block })
+        propagate_additions(channel);
+}
+
+auto LightPropagator::locate(glm::ivec3 block_position) -> std::pair<ChunkData*, glm::ivec3>
+{
+    auto chunk_position = chunk_of(block_position);
+
+    if (!_cache_valid || chunk_position != _cached_chunk_position)
+    {
+        _cached_chunk = _lookup(chunk_position);
+        _cached_chunk_position = chunk_position;
+        _cache_valid = true;
+    }
+
+    return { _cached_chunk, block_position - chunk_origin(chunk_position) };
+}
+
+auto LightPropagator::mark_changed(glm::ivec3 block_position) -> void
+{
+    auto chunk_position = chunk_of(block_position);
+
+    if (!std::ranges::contains(_changed_chunks, chunk_position))
+        _changed_chunks.push_back(chunk_position);
+}
+
+auto LightPropagator::get_level(u8 light, Channel channel) -> u8
+{
+    return channel == Channel::Sky ? sky_light(light) : block_light(light);
+}
+
+auto LightPropagator::set_level(u8 light, Channel channel, u8 level) -> u8
+{
+    return channel == Channel::Sky ? pack_light(level, block_light(light)) : pack_light(sky_light(light), level);
+}
+
+auto LightPropagator::propagate_additions(Channel channel) -> void
+{
+    auto& queue = _add_queues[std::to_underlying(channel)];
+
+    while (!queue.empty())
+    {
+        auto position = queue.front();
+        queue.pop_front();
+
+        auto [chunk, coordinates] = locate(position);
+
+        if (!chunk)
+            continue;
+
+        auto level = get_level(chunk->light(coordinates), channel);
+
+        if (level <= 1)
+            continue;
+
+        for (usize i = 0; i < neighbor_count; i++)
+        {
+            auto neighbor_position = position + neighbor_offsets[i];
+            auto [neighbor_chunk, neighbor_coordinates] = locate(neighbor_position);
+
+            if (!neighbor_chunk || is_opaque((*neighbor_chunk)[neighbor_coordinates]))
+                continue;
+
+            auto straight_down = channel == Channel::Sky && level == max_light && i == minus_y_idx;
+            auto neighbor_level = straight_down ? max_light : static_cast<u8>(level - 1);
+            auto& neighbor_light = neighbor_chunk->light(neighbor_coordinates);
+
+            if (get_level(neighbor_light, channel) >= neighbor_level)
+                continue;
+
+            neighbor_light = set_level(neighbor_light, channel, neighbor_level);
+            mark_changed(neighbor_position);
+            queue.push_back(neighbor_position);
+        }
+    }
+}
+
+auto LightPropagator::propagate_removals(Channel channel) -> void
+{
+    auto& queue = _removal_queues[std::to_underlying(channel)];
+
+    while (!queue.empty())
+    {
+        auto [position, level] = queue.front();
+        queue.pop_front();
+
+        for (usize i = 0; i < neighbor_count; i++)
+        {
+            auto neighbor_position = position + neighbor_offsets[i];
+            auto [neighbor_chunk, neighbor_coordinates] = locate(neighbor_position);
+
+            if (!neighbor_chunk)
+                continue;
+
+            auto& neighbor_light = neighbor_chunk->light(neighbor_coordinates);
+            auto neighbor_level = get_level(neighbor_light, channel);
+
+            if (neighbor_level == 0)
+                continue;
+
+            // Blocks which are darker than the removed light (or lit by full sky light shining down through it) were
+            // lit by it. The other ones are lit from elsewhere and spread their light back once the removal is done.
+            auto straight_down = channel == Channel::Sky && level == max_light && i == minus_y_idx;
+
+            if (neighbor_level < level || straight_down)
+            {
+                neighbor_light = set_level(neighbor_light, channel, 0);
+                mark_changed(neighbor_position);
+                queue.push_back(Removal{ .position = neighbor_position, .level = neighbor_level });
+            }
+            else
+            {
+                _add_queues[std::to_underlying(channel)].push_back(neighbor_position);
+            }
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <functional>
+
+#include "fwd.hpp"
+
+class HeightMap;
+
+// Returns the data of the chunk at the given position, or nullptr if the chunk isn't loaded.
+using MutableChunkLookup = std::function<ChunkData*(glm::ivec3 chunk_position)>;
+
+// Lights a freshly loaded chunk on its own, as if none of its neighbors were loaded. Sky light shines down the columns
+// which the height map shows to be open to the sky above the chunk, and both kinds of light spread through the chunk.
+// The light coming in from the neighbors is added once the chunk is stitched to them.
+auto light_chunk(ChunkData& chunk, glm::ivec3 chunk_position, const HeightMap& heights) -> void;
+
+// Spreads light between blocks with a breadth-first flood fill, which crosses the borders between chunks. Light loses
+// one level with every block it passes, except for full sky light shining straight down, so all the work is bounded to
+// the blocks within max_light blocks of where the light changed.
+//
+// Removing light (when a block is placed or stops emitting light) runs a second flood fill first, which darkens every
+// block that was lit by the removed light and collects the blocks lit from elsewhere along its edge, which then spread
+// their light back into the darkened blocks.
+//
+// The queues are kept between the calls, so nothing is allocated once they've grown large enough.
+class LightPropagator
+{
+public:
+    explicit LightPropagator(MutableChunkLookup lookup);
+
+    ZTH_NO_COPY(LightPropagator)
+    ZTH_DEFAULT_MOVE(LightPropagator)
+
+    ~LightPropagator() = default;
+
+    // Spreads the light across the borders between a newly loaded chunk and its loaded neighbors, in both directions.
+    auto stitch_chunk(glm::ivec3 chunk_position) -> void;
+    // Relights the surroundings of a block which was just changed.
+    auto update_block(glm::ivec3 block_position) -> void;
+    // Relights the surroundings of several blocks which were just changed with a single pass of each flood fill, which
+    // visits the blocks lit by more than one of them only once.
+    auto update_blocks(std::span<const glm::ivec3> block_positions) -> void;
+
+    // Chunks whose light changed since the last time they were cleared.
+    [[nodiscard]] auto changed_chunks() const -> std::span<const glm::ivec3> { return _changed_chunks; }
+    auto clear_changed_chunks() -> void { _changed_chunks.clear(); }
+
+    // Makes the block spread its light. Call propagate afterwards.
+    auto add_source(glm::ivec3 block_position) -> void;
+    auto propagate() -> void;
+
+private:
+    enum class Channel : u8
+    {
+        Sky = 0,
+        Block,
+    };
+
+    static constexpr usize channel_count = 2;
+
+    struct Removal
+    {
+        glm::ivec3 position;
+        u8 level;
+    };
+
+    MutableChunkLookup _lookup;
+
+    std::array<zth::Deque<glm::ivec3>, channel_count> _add_queues;
+    std::array<zth::Deque<Removal>, channel_count> _removal_queues;
+    zth::Vector<glm::ivec3> _changed_chunks;
+
+    // The chunk which was looked up last.
+    glm::ivec3 _cached_chunk_position{ 0, 0, 0 };
+    ChunkData* _cached_chunk = nullptr;
+    bool _cache_valid = false;
+
+private:
+    // Returns the block's chunk and the block's coordinates within it.
+    [[nodiscard]] auto locate(glm::ivec3 block_position) -> std::pair<ChunkData*, glm::ivec3>;
+    auto mark_changed(glm::ivec3 block_position) -> void;
+
+    [[nodiscard]] static auto get_level(u8 light, Channel channel) -> u8;
+    [[nodiscard]] static auto set_level(u8 light, Channel channel, u8 level) -> u8;
+
+    auto propagate_additions(Channel channel) -> void;
+    auto propagate_removals(Channel channel) -> void;
+};
@@ -0,0 +1,7 @@
+#include "world/occlusion.hpp"
+
+auto OcclusionCuller::chunk_bounds(glm::ivec3 chunk_position) -> Aabb
+{
+    auto min = glm::vec3{ chunk_position * chunk_size };
+    return Aabb{ .min = min, .max = min + glm::vec3{ chunk_size } };
+}
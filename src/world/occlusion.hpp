@@ -0,0 +1,90 @@
+#pragma once
+
+#include "frustum.hpp"
+#include "hash.hpp"
+#include "world/chunk.hpp"
+
+// Finds the chunks which are potentially visible from the camera's chunk by walking from chunk to chunk, only ever
+// moving away from the camera and only leaving a chunk through a face which is connected to the face it was entered
+// through.
+class OcclusionCuller
+{
+public:
+    explicit OcclusionCuller() = default;
+
+    // The lookup is called with a chunk's position and returns the chunk's visibility, or nil if the walk shouldn't
+    // continue into that chunk. Neighbors which lie entirely outside of the frustum (if provided) are skipped as well.
+    // Returns the set of potentially visible chunks, which stays valid until the next call.
+    template<std::invocable<glm::ivec3> Lookup>
+    auto find_visible_chunks(glm::ivec3 camera_chunk, Lookup&& lookup, const Frustum* frustum = nullptr)
+        -> const zth::UnorderedMap<glm::ivec3, u8>&;
+
+    [[nodiscard]] auto visible_chunks() const -> const zth::UnorderedMap<glm::ivec3, u8>& { return _visited; }
+
+private:
+    static constexpr usize no_face = neighbor_count;
+
+    struct Step
+    {
+        glm::ivec3 position;
+        usize entry_face;
+        u8 directions; // Bitmask of the directions travelled to reach this chunk.
+    };
+
+    // Maps the positions of visited chunks to the directions travelled to reach them.
+    zth::UnorderedMap<glm::ivec3, u8> _visited;
+    zth::Deque<Step> _queue;
+
+private:
+    [[nodiscard]] static auto chunk_bounds(glm::ivec3 chunk_position) -> Aabb;
+};
+
+template<std::invocable<glm::ivec3> Lookup>
+auto OcclusionCuller::find_visible_chunks(glm::ivec3 camera_chunk, Lookup&& lookup, const Frustum* frustum)
+    -> const zth::UnorderedMap<glm::ivec3, u8>&
+{
+    _visited.clear();
+    _queue.clear();
+
+    _visited.emplace(camera_chunk, u8{ 0 });
+    _queue.push_back(Step{ .position = camera_chunk, .entry_face = no_face, .directions = 0 });
+
+    while (!_queue.empty())
+    {
+        auto step = _queue.front();
+        _queue.pop_front();
+
+        Optional<ChunkVisibility> visibility = lookup(step.position);
+
+        if (!visibility)
+            continue;
+
+        for (usize direction = 0; direction < neighbor_count; direction++)
+        {
+            // Never go back towards the camera.
+            if (step.directions & (1 << opposite_neighbor_offset_idx[direction]))
+                continue;
+
+            if (step.entry_face != no_face && !visibility->connected(step.entry_face, direction))
+                continue;
+
+            auto neighbor_position = step.position + neighbor_offsets[direction];
+
+            if (_visited.contains(neighbor_position))
+                continue;
+
+            if (frustum && !frustum->intersects(chunk_bounds(neighbor_position)))
+                continue;
+
+            auto directions = static_cast<u8>(step.directions | (1 << direction));
+            _visited.emplace(neighbor_position, directions);
+            _queue.push_back(Step{
+                .position = neighbor_position,
+                .entry_face = static_cast<usize>(opposite_neighbor_offset_idx[direction]),
+                .directions = directions,
+            });
+        }
+    }
+
+    return _visited;
+}
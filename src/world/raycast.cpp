@@ -0,0 +1,145 @@
+#include "world/raycast.hpp"
+
+#include <future>
+#include <thread>
+
+#include "world/chunk.hpp"
+
+namespace {
+
+// Rays are split between the threads in batches of at least this many.
+constexpr usize min_rays_per_thread = 64;
+
+// Face which the ray enters a block through after stepping along the axis, indexed by the axis and by whether the step
+// was positive.
+constexpr std::array<std::array<BlockFacing, 2>, 3> entry_faces = { {
+    { Facing_Left, Facing_Right },
+    { Facing_Down, Facing_Up },
+    { Facing_Forward, Facing_Backward },
+} };
+
+[[nodiscard]] auto chunk_of(glm::ivec3 block_position) -> glm::ivec3
+{
+    auto [x, y, z] = block_position;
+    return { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+}
+
+[[nodiscard]] auto chunk_origin(glm::ivec3 chunk_position) -> glm::ivec3
+{
+    auto [x, y, z] = chunk_position;
+    return { chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+}
+
+} // namespace
+
+auto raycast(const ChunkLookup& lookup, const Ray& ray) -> Optional<RaycastHit>
+{
+    // @multithreaded
+
+    auto length = glm::length(ray.direction);
+
+    if (!(length > 0.0f) || ray.max_distance < 0.0f)
+        return nil;
+
+    auto direction = ray.direction / length;
+
+    glm::ivec3 block{ glm::floor(ray.origin) };
+    glm::ivec3 step{ 0, 0, 0 };
+    // Distance along the ray to the next block boundary on each axis, and the distance between two boundaries.
+    glm::vec3 next_boundary{ std::numeric_limits<float>::infinity() };
+    glm::vec3 boundary_spacing{ std::numeric_limits<float>::infinity() };
+
+    for (glm::length_t axis = 0; axis < 3; axis++)
+    {
+        if (direction[axis] > 0.0f)
+        {
+            step[axis] = 1;
+            next_boundary[axis] = (static_cast<float>(block[axis] + 1) - ray.origin[axis]) / direction[axis];
+            boundary_spacing[axis] = 1.0f / direction[axis];
+        }
+        else if (direction[axis] < 0.0f)
+        {
+            step[axis] = -1;
+            next_boundary[axis] = (ray.origin[axis] - static_cast<float>(block[axis])) / -direction[axis];
+            boundary_spacing[axis] = -1.0f / direction[axis];
+        }
+    }
+
+    // The block is tracked relative to the chunk it lies in, so the chunk only has to be looked up again once the ray
+    // leaves it.
+    auto chunk_position = chunk_of(block);
+    auto chunk = lookup(chunk_position);
+    auto local = block - chunk_origin(chunk_position);
+
+    auto distance = 0.0f;
+    auto face = Facing_None;
+
+    while (true)
+    {
+        if (chunk)
+        {
+            if (auto type = (*chunk)[local]; is_solid(type))
+                return RaycastHit{ .block_position = block, .block = type, .face = face, .distance = distance };
+        }
+
+        // Step into the neighboring block whose boundary the ray crosses first.
+        glm::length_t axis = 0;
+
+        if (next_boundary.y < next_boundary[axis])
+            axis = 1;
+
+        if (next_boundary.z < next_boundary[axis])
+            axis = 2;
+
+        distance = next_boundary[axis];
+
+        if (distance > ray.max_distance)
+            return nil;
+
+        block[axis] += step[axis];
+        local[axis] += step[axis];
+        next_boundary[axis] += boundary_spacing[axis];
+        face = entry_faces[static_cast<usize>(axis)][step[axis] > 0 ? 0 : 1];
+
+        if (!ChunkData::valid_coordinates(local))
+        {
+            chunk_position = chunk_of(block);
+            chunk = lookup(chunk_position);
+            local = block - chunk_origin(chunk_position);
+        }
+    }
+}
+
+auto raycast(const ChunkLookup& lookup, std::span<const Ray> rays) -> zth::Vector<Optional<RaycastHit>>
+{
+    zth::Vector<Optional<RaycastHit>> result(rays.size());
+
+    if (rays.empty())
+        return result;
+
+    // Every thread gets a contiguous range of rays, as neighboring rays tend to pass through the same chunks. The
+    // calling thread casts its share as well.
+    auto max_threads = std::max<usize>(std::thread::hardware_concurrency(), 1);
+    auto thread_count = std::clamp<usize>(rays.size() / min_rays_per_thread, 1, max_threads);
+    auto rays_per_thread = (rays.size() + thread_count - 1) / thread_count;
+
+    auto cast = [&](usize first) {
+        auto last = std::min(first + rays_per_thread, rays.size());
+
+        for (auto i = first; i < last; i++)
+            result[i] = raycast(lookup, rays[i]);
+    };
+
+    zth::Vector<std::future<void>> workers;
+    workers.reserve(thread_count - 1);
+
+    for (usize i = 1; i < thread_count; i++)
+        workers.push_back(std::async(std::launch::async, cast, i * rays_per_thread));
+
+    cast(0);
+
+    for (auto& worker : workers)
+        worker.get();
+
+    return result;
+}
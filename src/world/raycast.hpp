@@ -0,0 +1,34 @@
+#pragma once
+
+#include <functional>
+
+#include "fwd.hpp"
+
+#include "world/block.hpp"
+
+struct Ray
+{
+    glm::vec3 origin{ 0.0f };
+    glm::vec3 direction{ 0.0f, 0.0f, -1.0f }; // Doesn't have to be normalized.
+    float max_distance = 0.0f;                // In blocks.
+};
+
+struct RaycastHit
+{
+    glm::ivec3 block_position{ 0, 0, 0 }; // In world space.
+    BlockType block = BlockType::Air;
+    BlockFacing face = Facing_None; // Face of the block which the ray entered through, none if it started inside it.
+    float distance = 0.0f;          // From the ray's origin to the point where it entered the block.
+};
+
+// Returns the data of the chunk at the given position, or nullptr if the chunk isn't loaded. Lookups made by the
+// batched raycast run on several threads at once.
+using ChunkLookup = std::function<const ChunkData*(glm::ivec3 chunk_position)>;
+
+// Finds the first solid block along the ray, stepping through the blocks it passes one by one (Amanatides and Woo's
+// voxel traversal). The chunks are looked up only when the ray crosses into another chunk, and the ones which aren't
+// loaded are treated as air.
+[[nodiscard]] auto raycast(const ChunkLookup& lookup, const Ray& ray) -> Optional<RaycastHit>;
+
+// Casts all the rays in parallel. The result holds the hits in the same order as the rays.
+[[nodiscard]] auto raycast(const ChunkLookup& lookup, std::span<const Ray> rays) -> zth::Vector<Optional<RaycastHit>>;
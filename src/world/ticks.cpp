@@ -0,0 +1,245 @@
+#include "world/ticks.hpp"
+
+namespace {
+
+// Grass spreads onto dirt around it which is lit at least this much, trying this many blocks per tick.
+constexpr u8 grass_spread_min_light = 9;
+constexpr i32 grass_spread_attempts = 4;
+
+[[nodiscard]] auto chunk_origin(glm::ivec3 chunk_position) -> glm::ivec3
+{
+    auto [x, y, z] = chunk_position;
+    return { chunk_x_to_world_x(x), chunk_y_to_world_y(y), chunk_z_to_world_z(z) };
+}
+
+[[nodiscard]] auto chunk_of(glm::ivec3 block_position) -> glm::ivec3
+{
+    auto [x, y, z] = block_position;
+    return { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+}
+
+// Laid out like the blocks of a chunk.
+[[nodiscard]] auto index_of(glm::ivec3 coordinates) -> usize
+{
+    auto [x, y, z] = coordinates;
+    return static_cast<usize>((x * chunk_size.y + y) * chunk_size.z + z);
+}
+
+[[nodiscard]] auto coordinates_of(usize index) -> glm::ivec3
+{
+    auto i = static_cast<i32>(index);
+    return { i / (chunk_size.y * chunk_size.z), i / chunk_size.z % chunk_size.y, i % chunk_size.z };
+}
+
+} // namespace
+
+TickScheduler::TickScheduler(ChunkLookup lookup, BlockSetter set_block, u64 seed)
+    : _lookup(std::move(lookup)), _set_block(std::move(set_block)), _random_state(seed)
+{}
+
+auto TickScheduler::add_chunk(glm::ivec3 chunk_position, const ChunkData& chunk) -> void
+{
+    Section section;
+    const auto& blocks = chunk.blocks();
+
+    // Built a word at a time, which the compiler turns into wide compares.
+    for (usize word = 0; word < words_per_section; word++)
+    {
+        u64 bits = 0;
+
+        for (usize bit = 0; bit < bits_per_word; bit++)
+            bits |= static_cast<u64>(block_properties(blocks[word * bits_per_word + bit]).randomly_ticked) << bit;
+
+        section.randomly_ticked[word] = bits;
+        section.count += static_cast<usize>(std::popcount(bits));
+    }
+
+    if (section.count > 0)
+        _sections.insert_or_assign(chunk_position, section);
+    else
+        _sections.erase(chunk_position);
+}
+
+auto TickScheduler::remove_chunk(glm::ivec3 chunk_position) -> void
+{
+    _sections.erase(chunk_position);
+}
+
+auto TickScheduler::clear() -> void
+{
+    _sections.clear();
+
+    for (auto& slot : _wheel)
+        slot.clear();
+
+    _scheduled_update_count = 0;
+}
+
+auto TickScheduler::block_changed(glm::ivec3 block_position, BlockType block) -> void
+{
+    auto chunk_position = chunk_of(block_position);
+    auto index = index_of(block_position - chunk_origin(chunk_position));
+    auto word = index / bits_per_word;
+    auto mask = u64{ 1 } << (index % bits_per_word);
+
+    if (block_properties(block).randomly_ticked)
+    {
+        auto& section = _sections[chunk_position];
+
+        if (!(section.randomly_ticked[word] & mask))
+        {
+            section.randomly_ticked[word] |= mask;
+            section.count++;
+        }
+    }
+    else if (auto kv = _sections.find(chunk_position); kv != _sections.end())
+    {
+        auto& [_, section] = *kv;
+
+        if (section.randomly_ticked[word] & mask)
+        {
+            section.randomly_ticked[word] &= ~mask;
+
+            if (--section.count == 0)
+                _sections.erase(kv);
+        }
+    }
+
+    // The block itself may have to fall, and so may the one which stood on it.
+    for (auto position : { block_position, block_position + glm::ivec3{ 0, 1, 0 } })
+    {
+        if (auto neighbor = get_block(position); neighbor && falls(*neighbor))
+            schedule(position, fall_delay);
+    }
+}
+
+auto TickScheduler::schedule(glm::ivec3 block_position, u32 delay) -> void
+{
+    ZTH_ASSERT(delay > 0);
+
+    auto due_at = _tick + delay;
+    _wheel[due_at % wheel_size].push_back(ScheduledUpdate{ .position = block_position, .tick = due_at });
+    _scheduled_update_count++;
+}
+
+auto TickScheduler::tick() -> void
+{
+    // Scheduled updates. The slot also holds the updates which are due in later turns of the wheel.
+    auto& slot = _wheel[_tick % wheel_size];
+
+    _due_updates.clear();
+
+    for (const auto& update : slot)
+    {
+        if (update.tick == _tick)
+            _due_updates.push_back(update.position);
+    }
+
+    std::erase_if(slot, [this](const ScheduledUpdate& update) { return update.tick == _tick; });
+    _scheduled_update_count -= _due_updates.size();
+
+    for (auto position : _due_updates)
+        run_scheduled_update(position);
+
+    // Random ticks. Only the picks which hit a randomly ticked block are kept, so most of the work is testing bits.
+    _random_ticks.clear();
+
+    for (const auto& [chunk_position, section] : _sections)
+    {
+        auto origin = chunk_origin(chunk_position);
+
+        for (i32 i = 0; i < random_ticks_per_section; i++)
+        {
+            auto index = static_cast<usize>(random() % static_cast<u64>(blocks_in_chunk));
+
+            if (section.randomly_ticked[index / bits_per_word] & (u64{ 1 } << (index % bits_per_word)))
+                _random_ticks.push_back(origin + coordinates_of(index));
+        }
+    }
+
+    for (auto position : _random_ticks)
+        run_random_tick(position);
+
+    _tick++;
+}
+
+auto TickScheduler::random() -> u64
+{
+    // SplitMix64.
+    auto hash = _random_state += 0x9e3779b97f4a7c15ull;
+    hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+    return hash ^ (hash >> 31);
+}
+
+auto TickScheduler::random_below(i32 bound) -> i32
+{
+    ZTH_ASSERT(bound > 0);
+    return static_cast<i32>(random() % static_cast<u64>(bound));
+}
+
+auto TickScheduler::get_block(glm::ivec3 block_position) const -> Optional<BlockType>
+{
+    auto chunk_position = chunk_of(block_position);
+    auto chunk = _lookup(chunk_position);
+
+    if (!chunk)
+        return nil;
+
+    return (*chunk)[block_position - chunk_origin(chunk_position)];
+}
+
+auto TickScheduler::get_light(glm::ivec3 block_position) const -> Optional<u8>
+{
+    auto chunk_position = chunk_of(block_position);
+    auto chunk = _lookup(chunk_position);
+
+    if (!chunk)
+        return nil;
+
+    auto light = chunk->light(block_position - chunk_origin(chunk_position));
+    return std::max(sky_light(light), block_light(light));
+}
+
+auto TickScheduler::run_scheduled_update(glm::ivec3 block_position) -> void
+{
+    auto block = get_block(block_position);
+
+    if (!block)
+        return;
+
+    if (falls(*block))
+    {
+        auto below = block_position - glm::ivec3{ 0, 1, 0 };
+
+        // Falling into a chunk which isn't loaded would lose the block.
+        if (get_block(below) == BlockType::Air && _set_block(below, *block))
+            _set_block(block_position, BlockType::Air);
+    }
+}
+
+auto TickScheduler::run_random_tick(glm::ivec3 block_position) -> void
+{
+    // An earlier tick may have changed the block already.
+    if (get_block(block_position) != BlockType::Grass)
+        return;
+
+    // Grass dies under an opaque block, and spreads onto the lit dirt around it otherwise.
+    if (auto above = get_block(block_position + glm::ivec3{ 0, 1, 0 }); above && is_opaque(*above))
+    {
+        _set_block(block_position, BlockType::Dirt);
+        return;
+    }
+
+    for (i32 i = 0; i < grass_spread_attempts; i++)
+    {
+        auto target = block_position + glm::ivec3{ random_below(3) - 1, random_below(5) - 3, random_below(3) - 1 };
+        auto above = target + glm::ivec3{ 0, 1, 0 };
+
+        if (get_block(target) == BlockType::Dirt && get_block(above) == BlockType::Air
+            && get_light(above).value_or(0) >= grass_spread_min_light)
+        {
+            _set_block(target, BlockType::Grass);
+        }
+    }
+}
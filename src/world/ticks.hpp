@@ -0,0 +1,103 @@
+#pragma once
+
+#include <functional>
+
+#include "hash.hpp"
+#include "world/block.hpp"
+#include "world/chunk.hpp"
+#include "world/raycast.hpp"
+
+// Changes a block of a loaded chunk, returns false if the block's chunk isn't loaded. The change has to be reported
+// back to the tick scheduler through block_changed.
+using BlockSetter = std::function<bool(glm::ivec3 block_position, BlockType block)>;
+
+// Runs the gameplay block updates of the world, one tick at a time:
+//
+// - Random ticks: every tick, a few random blocks of every section (chunk) get ticked, like grass spreading onto dirt.
+// Every section keeps a bitset of its blocks which react to random ticks, so a random pick only tests a bit, and
+// sections which have none of them aren't in the active set at all and are never visited.
+// - Scheduled updates: blocks can ask to be updated after a number of ticks, like falling blocks once the block below
+// them is gone. The updates wait in a timer wheel with a slot for every tick of its turn, so a tick only visits the
+// updates which are due (and the ones scheduled whole turns of the wheel ahead, which share their slot).
+//
+// All the changes go through the block setter, which relights the world and collects the chunks which need to be
+// remeshed, so they can be remeshed together once the tick is over.
+class TickScheduler
+{
+public:
+    // Random ticks every active section gets per tick.
+    i32 random_ticks_per_section = 3;
+
+    // Number of ticks a falling block waits before it falls one block further.
+    static constexpr u32 fall_delay = 2;
+    // Number of slots of the timer wheel, which is the furthest ahead an update can be scheduled without waiting for
+    // several turns of the wheel.
+    static constexpr usize wheel_size = 256;
+
+public:
+    explicit TickScheduler(ChunkLookup lookup, BlockSetter set_block, u64 seed = 0);
+
+    ZTH_NO_COPY(TickScheduler)
+    ZTH_DEFAULT_MOVE(TickScheduler)
+
+    ~TickScheduler() = default;
+
+    // Builds the section's bitset of randomly ticked blocks out of a newly loaded chunk.
+    auto add_chunk(glm::ivec3 chunk_position, const ChunkData& chunk) -> void;
+    // Updates scheduled in an unloaded chunk are dropped once they're due.
+    auto remove_chunk(glm::ivec3 chunk_position) -> void;
+    auto clear() -> void;
+
+    // Has to be called whenever a block of a loaded chunk changes, including the changes made by the ticks. Schedules
+    // updates of the neighboring blocks which react to the change.
+    auto block_changed(glm::ivec3 block_position, BlockType block) -> void;
+    // Updates the block after the given number of ticks (at least one).
+    auto schedule(glm::ivec3 block_position, u32 delay) -> void;
+
+    // Runs the scheduled updates which are due, then the random ticks.
+    auto tick() -> void;
+
+    [[nodiscard]] auto active_sections() const -> usize { return _sections.size(); }
+    [[nodiscard]] auto scheduled_updates() const -> usize { return _scheduled_update_count; }
+    [[nodiscard]] auto ticks() const -> u64 { return _tick; }
+
+private:
+    static constexpr usize bits_per_word = 64;
+    static constexpr usize words_per_section = blocks_in_chunk / bits_per_word;
+
+    struct Section
+    {
+        std::array<u64, words_per_section> randomly_ticked{};
+        usize count = 0;
+    };
+
+    struct ScheduledUpdate
+    {
+        glm::ivec3 position;
+        u64 tick;
+    };
+
+    ChunkLookup _lookup;
+    BlockSetter _set_block;
+    u64 _random_state;
+
+    zth::UnorderedMap<glm::ivec3, Section> _sections;
+
+    std::array<zth::Vector<ScheduledUpdate>, wheel_size> _wheel;
+    usize _scheduled_update_count = 0;
+    u64 _tick = 0;
+
+    // Reused every tick. The blocks to update are collected first, as updating them changes the sections.
+    zth::Vector<glm::ivec3> _due_updates;
+    zth::Vector<glm::ivec3> _random_ticks;
+
+private:
+    [[nodiscard]] auto random() -> u64;
+    [[nodiscard]] auto random_below(i32 bound) -> i32;
+
+    [[nodiscard]] auto get_block(glm::ivec3 block_position) const -> Optional<BlockType>;
+    [[nodiscard]] auto get_light(glm::ivec3 block_position) const -> Optional<u8>;
+
+    auto run_scheduled_update(glm::ivec3 block_position) -> void;
+    auto run_random_tick(glm::ivec3 block_position) -> void;
+};
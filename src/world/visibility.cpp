@@ -0,0 +1,150 @@
+#include "world/visibility.hpp"
+
+#include "world/chunk.hpp"
+
+namespace {
+
+static_assert(ChunkVisibility::face_count == neighbor_count);
+
+// Bit which represents the pair of faces in a chunk visibility's mask.
+constexpr auto face_pair_bits = [] {
+    std::array<std::array<u16, neighbor_count>, neighbor_count> result{};
+    u16 bit = 0;
+
+    for (usize a = 0; a < neighbor_count; a++)
+    {
+        for (usize b = a + 1; b < neighbor_count; b++)
+        {
+            result[a][b] = static_cast<u16>(1 << bit);
+            result[b][a] = static_cast<u16>(1 << bit);
+            bit++;
+        }
+    }
+
+    return result;
+}();
+
+[[nodiscard]] auto index_to_coordinates(usize index) -> glm::ivec3
+{
+    auto i = static_cast<i32>(index);
+    return { i / (chunk_size.y * chunk_size.z), i / chunk_size.z % chunk_size.y, i % chunk_size.z };
+}
+
+[[nodiscard]] auto coordinates_to_index(glm::ivec3 coordinates) -> usize
+{
+    auto [x, y, z] = coordinates;
+    return static_cast<usize>((x * chunk_size.y + y) * chunk_size.z + z);
+}
+
+// Bitmask of the chunk's faces which the block touches.
+[[nodiscard]] auto touched_faces(glm::ivec3 coordinates) -> u8
+{
+    auto [x, y, z] = coordinates;
+    u8 faces = 0;
+
+    faces |= static_cast<u8>((x == chunk_size.x - 1) << plus_x_idx);
+    faces |= static_cast<u8>((x == 0) << minus_x_idx);
+    faces |= static_cast<u8>((z == chunk_size.z - 1) << plus_z_idx);
+    faces |= static_cast<u8>((z == 0) << minus_z_idx);
+    faces |= static_cast<u8>((y == chunk_size.y - 1) << plus_y_idx);
+    faces |= static_cast<u8>((y == 0) << minus_y_idx);
+
+    return faces;
+}
+
+// Both chunks and chunk neighborhoods are indexed with the chunk's coordinates.
+template<typename Chunk> [[nodiscard]] auto compute_visibility(const Chunk& chunk) -> ChunkVisibility
+{
+    ChunkVisibility result;
+
+    std::bitset<blocks_in_chunk> visited;
+    std::array<u16, blocks_in_chunk> stack; // Purposefully left uninitialized.
+    static_assert(blocks_in_chunk <= std::numeric_limits<u16>::max() + 1);
+
+    for (usize start = 0; start < static_cast<usize>(blocks_in_chunk); start++)
+    {
+        if (visited[start] || is_opaque(chunk[index_to_coordinates(start)]))
+            continue;
+
+        // Flood fill a single pocket of air.
+
+        usize stack_size = 0;
+        stack[stack_size++] = static_cast<u16>(start);
+        visited[start] = true;
+
+        u8 faces = 0;
+
+        while (stack_size > 0)
+        {
+            auto coordinates = index_to_coordinates(stack[--stack_size]);
+            faces |= touched_faces(coordinates);
+
+            for (auto offset : neighbor_offsets)
+            {
+                auto neighbor = coordinates + offset;
+
+                if (!ChunkData::valid_coordinates(neighbor))
+                    continue;
+
+                auto neighbor_index = coordinates_to_index(neighbor);
+
+                if (visited[neighbor_index] || is_opaque(chunk[neighbor]))
+                    continue;
+
+                visited[neighbor_index] = true;
+                stack[stack_size++] = static_cast<u16>(neighbor_index);
+            }
+        }
+
+        result.connect_all(faces);
+
+        // Every pair is connected already, there's nothing more to find.
+        if (result.mask() == ChunkVisibility::all().mask())
+            break;
+    }
+
+    return result;
+}
+
+} // namespace
+
+auto ChunkVisibility::compute(const ChunkData& chunk) -> ChunkVisibility
+{
+    // @multithreaded
+
+    return compute_visibility(chunk);
+}
+
+auto ChunkVisibility::compute(const ChunkNeighborhood& neighborhood) -> ChunkVisibility
+{
+    // @multithreaded
+
+    return compute_visibility(neighborhood);
+}
+
+auto ChunkVisibility::connected(usize face_a, usize face_b) const -> bool
+{
+    ZTH_ASSERT(face_a < face_count && face_b < face_count);
+    return _mask & face_pair_bits[face_a][face_b];
+}
+
+auto ChunkVisibility::connect(usize face_a, usize face_b) -> void
+{
+    ZTH_ASSERT(face_a < face_count && face_b < face_count);
+    _mask |= face_pair_bits[face_a][face_b];
+}
+
+auto ChunkVisibility::connect_all(u8 faces) -> void
+{
+    for (usize a = 0; a < face_count; a++)
+    {
+        if (!(faces & (1 << a)))
+            continue;
+
+        for (usize b = a + 1; b < face_count; b++)
+        {
+            if (faces & (1 << b))
+                connect(a, b);
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "fwd.hpp"
+
+// Set of pairs of a chunk's faces which are connected through non-opaque blocks, i.e. whether it's possible to see
+// through the chunk when looking in through one face and out through the other. Faces are identified with the same
+// indices which are used to access a neighbors array. There are 15 pairs of faces, so the set fits in 15 bits.
+class ChunkVisibility
+{
+public:
+    static constexpr usize face_count = 6;
+
+    constexpr explicit ChunkVisibility() = default;
+
+    // Every face is connected to every other face, which is the case for a chunk consisting only of air. Used for the
+    // chunks whose visibility hasn't been computed yet.
+    [[nodiscard]] static constexpr auto all() -> ChunkVisibility
+    {
+        ChunkVisibility result;
+        result._mask = all_pairs_mask;
+        return result;
+    }
+
+    // Floods the air inside the chunk and connects all the faces which each pocket of air touches.
+    [[nodiscard]] static auto compute(const ChunkData& chunk) -> ChunkVisibility;
+    // Only looks at the chunk inside the neighborhood, not at its apron.
+    [[nodiscard]] static auto compute(const ChunkNeighborhood& neighborhood) -> ChunkVisibility;
+
+    [[nodiscard]] auto connected(usize face_a, usize face_b) const -> bool;
+    auto connect(usize face_a, usize face_b) -> void;
+    // Connects every pair of faces from the bitmask of faces.
+    auto connect_all(u8 faces) -> void;
+
+    [[nodiscard]] auto mask() const -> u16 { return _mask; }
+
+private:
+    static constexpr u16 all_pairs_mask = (1 << 15) - 1;
+
+    u16 _mask = 0;
+};
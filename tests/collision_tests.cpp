@@ -0,0 +1,196 @@
+#include "test.hpp"
+#include "test_world.hpp"
+#include "world/collision.hpp"
+
+namespace {
+
+// Box roughly the size of the player with its feet at the given position.
+[[nodiscard]] auto player_box(glm::vec3 feet) -> Aabb
+{
+    return Aabb{ .min = feet - glm::vec3{ 0.4f, 0.0f, 0.4f }, .max = feet + glm::vec3{ 0.4f, 1.8f, 0.4f } };
+}
+
+// Loads the chunks around the origin with a floor at y = 0, as unloaded chunks are solid.
+[[nodiscard]] auto make_floor_world() -> TestWorld
+{
+    TestWorld world;
+    world.load_chunks({ -1, -1, -1 }, { 1, 1, 1 });
+    world.fill({ -8, 0, -8 }, { 8, 0, 8 }, BlockType::Stone);
+    return world;
+}
+
+} // namespace
+
+TEST(move_box_lands_on_floor)
+{
+    auto world = make_floor_world();
+
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 1.5f, 0.5f }), { 0.0f, -1.0f, 0.0f });
+
+    CHECK(approximately_equal(result.displacement, { 0.0f, -0.5f, 0.0f }));
+    CHECK(result.collided == glm::bvec3(false, true, false));
+    CHECK(result.grounded);
+}
+
+TEST(move_box_falls_freely_through_air)
+{
+    auto world = make_floor_world();
+
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 5.0f, 0.5f }), { 0.0f, -1.0f, 0.0f });
+
+    CHECK(approximately_equal(result.displacement, { 0.0f, -1.0f, 0.0f }));
+    CHECK(!glm::any(result.collided));
+    CHECK(!result.grounded);
+}
+
+TEST(move_box_walks_along_floor)
+{
+    auto world = make_floor_world();
+
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 1.0f, 0.5f }), { 2.0f, 0.0f, -1.0f });
+
+    CHECK(approximately_equal(result.displacement, { 2.0f, 0.0f, -1.0f }));
+    CHECK(!glm::any(result.collided));
+    CHECK(result.grounded);
+}
+
+TEST(move_box_slides_along_wall)
+{
+    auto world = make_floor_world();
+    world.fill({ 3, 1, -8 }, { 3, 4, 8 }, BlockType::Stone);
+
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 1.0f, 0.5f }), { 3.0f, 0.0f, 1.0f });
+
+    // The box stops at the wall but keeps moving along it.
+    CHECK(approximately_equal(result.displacement, { 2.1f, 0.0f, 1.0f }));
+    CHECK(result.collided == glm::bvec3(true, false, false));
+}
+
+TEST(move_box_stops_in_inner_corner)
+{
+    auto world = make_floor_world();
+    world.fill({ 3, 1, -8 }, { 3, 4, 8 }, BlockType::Stone);
+    world.fill({ -8, 1, 3 }, { 8, 4, 3 }, BlockType::Stone);
+
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 1.0f, 0.5f }), { 3.0f, 0.0f, 3.0f });
+
+    CHECK(approximately_equal(result.displacement, { 2.1f, 0.0f, 2.1f }));
+    CHECK(result.collided == glm::bvec3(true, false, true));
+}
+
+TEST(move_box_catches_on_outer_corner)
+{
+    auto world = make_floor_world();
+    world.set_block({ 3, 1, 3 }, BlockType::Stone);
+
+    // The x axis is resolved first and passes beside the block, which then stops the movement along z.
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 1.0f, 0.5f }), { 3.0f, 0.0f, 3.0f });
+
+    CHECK(approximately_equal(result.displacement, { 3.0f, 0.0f, 2.1f }));
+    CHECK(result.collided == glm::bvec3(false, false, true));
+}
+
+TEST(move_box_doesnt_tunnel_at_high_speed)
+{
+    TestWorld world;
+    world.load_chunks({ -1, -1, -1 }, { 7, 13, 1 });
+    world.fill({ -8, 0, -8 }, { 8, 0, 8 }, BlockType::Stone);
+    world.fill({ 10, 1, -8 }, { 10, 4, 8 }, BlockType::Stone);
+
+    // A single block thick wall stops a box moving many blocks in one step.
+    auto sideways = move_box(world.lookup(), player_box({ 0.5f, 1.0f, 0.5f }), { 100.0f, 0.0f, 0.0f });
+
+    CHECK(approximately_equal(sideways.displacement, { 9.1f, 0.0f, 0.0f }));
+    CHECK(sideways.collided.x);
+
+    // So does a single block thick floor.
+    auto falling = move_box(world.lookup(), player_box({ 0.5f, 200.0f, 0.5f }), { 0.0f, -1000.0f, 0.0f });
+
+    CHECK(approximately_equal(falling.displacement, { 0.0f, -199.0f, 0.0f }));
+    CHECK(falling.collided.y);
+    CHECK(falling.grounded);
+}
+
+TEST(move_box_stays_grounded_when_rebuilt_around_the_eye)
+{
+    TestWorld world;
+    world.load_chunks({ -1, 1, -1 }, { 1, 4, 1 });
+    world.fill({ -8, 30, -8 }, { 8, 30, 8 }, BlockType::Stone);
+    world.fill({ -8, 63, -8 }, { 8, 63, 8 }, BlockType::Stone);
+
+    // Like the player's, the box is rebuilt around the eye every frame. After landing from some heights its bottom is
+    // rounded to slightly above the floor, e.g. to 31.0000019 when landing on y = 31 with the eye at 32.63. It has to
+    // stay grounded even in frames which don't move it down, like ones which only move it sideways.
+    constexpr float eye_height = 1.62f;
+
+    for (auto floor_height : { 31.0f, 64.0f })
+    {
+        for (auto i = 1; i <= 50; i++)
+        {
+            glm::vec3 eye{ 0.5f, floor_height + eye_height + static_cast<float>(i) * 0.01f, 0.5f };
+
+            for (auto displacement : { glm::vec3{ 0.0f, -0.5f, 0.0f }, glm::vec3{ 0.1f, 0.0f, 0.0f },
+                                       glm::vec3{ 0.0f, 0.0f, 0.1f } })
+            {
+                auto result =
+                    move_box(world.lookup(), player_box(eye - glm::vec3{ 0.0f, eye_height, 0.0f }), displacement);
+                eye += result.displacement;
+
+                CHECK(result.grounded);
+            }
+        }
+    }
+}
+
+TEST(move_box_treats_unloaded_chunks_as_solid)
+{
+    TestWorld world;
+    world.load_chunk({ 0, 0, 0 });
+
+    auto result = move_box(world.lookup(), player_box({ 14.5f, 1.0f, 0.5f }), { 5.0f, 0.0f, 0.0f });
+
+    CHECK(approximately_equal(result.displacement, { static_cast<float>(chunk_size.x) - 14.9f, 0.0f, 0.0f }));
+    CHECK(result.collided.x);
+}
+
+TEST(move_box_moves_out_of_overlapped_blocks)
+{
+    auto world = make_floor_world();
+    world.fill({ 0, 1, 0 }, { 0, 2, 0 }, BlockType::Stone);
+
+    auto result = move_box(world.lookup(), player_box({ 0.5f, 1.0f, 0.5f }), { 2.0f, 0.0f, 0.0f });
+
+    CHECK(approximately_equal(result.displacement, { 2.0f, 0.0f, 0.0f }));
+    CHECK(!result.collided.x);
+}
+
+TEST(move_boxes_matches_move_box)
+{
+    auto world = make_floor_world();
+    world.fill({ 3, 1, -8 }, { 3, 4, 8 }, BlockType::Stone);
+
+    std::array boxes = {
+        player_box({ 0.5f, 1.5f, 0.5f }),
+        player_box({ 0.5f, 1.0f, 0.5f }),
+        player_box({ -4.5f, 3.0f, -4.5f }),
+        player_box({ 0.5f, 5.0f, 0.5f }),
+    };
+    std::array displacements = {
+        glm::vec3{ 0.0f, -1.0f, 0.0f },
+        glm::vec3{ 3.0f, 0.0f, 1.0f },
+        glm::vec3{ -1.0f, -0.5f, 2.0f },
+        glm::vec3{ 0.0f, 2.0f, 0.0f },
+    };
+    zth::Vector<MoveResult> results(boxes.size());
+
+    move_boxes(world.lookup(), boxes, displacements, results);
+
+    for (usize i = 0; i < boxes.size(); i++)
+    {
+        auto expected = move_box(world.lookup(), boxes[i], displacements[i]);
+
+        CHECK(results[i].displacement == expected.displacement);
+        CHECK(results[i].collided == expected.collided);
+        CHECK(results[i].grounded == expected.grounded);
+    }
+}
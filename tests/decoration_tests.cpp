@@ -0,0 +1,77 @@
+#include "test.hpp"
+#include "world/block.hpp"
+
+namespace {
+
+// Applies the writes to a single block one after another, in the given order.
+[[nodiscard]] auto place_in_order(BlockType block, std::span<const BlockWrite> writes) -> BlockType
+{
+    for (const auto& write : writes)
+    {
+        if (write.applies_to(block))
+            block = write.block;
+    }
+
+    return block;
+}
+
+// Checks that the writes leave the block the same in every order.
+[[nodiscard]] auto same_in_every_order(BlockType block, zth::Vector<BlockWrite> writes, BlockType expected) -> bool
+{
+    std::ranges::sort(writes, {}, &BlockWrite::block);
+
+    do
+    {
+        if (place_in_order(block, writes) != expected)
+            return false;
+    } while (std::ranges::next_permutation(writes, {}, &BlockWrite::block).found);
+
+    return true;
+}
+
+} // namespace
+
+TEST(write_only_goes_over_block_it_replaces)
+{
+    BlockWrite write{ .block = BlockType::Dirt, .replaces = BlockType::Grass };
+
+    CHECK(write.applies_to(BlockType::Grass));
+    CHECK(!write.applies_to(BlockType::Stone));
+    CHECK(!write.applies_to(BlockType::Air));
+    CHECK(!write.applies_to(BlockType::Dirt));
+}
+
+TEST(overlapping_trees_come_out_same_in_every_order)
+{
+    zth::Vector<BlockWrite> writes = {
+        BlockWrite{ .block = BlockType::Leaves },
+        BlockWrite{ .block = BlockType::Log },
+        BlockWrite{ .block = BlockType::Leaves },
+    };
+
+    CHECK(same_in_every_order(BlockType::Air, writes, BlockType::Log));
+}
+
+TEST(overlapping_ore_veins_come_out_same_in_every_order)
+{
+    zth::Vector<BlockWrite> writes = {
+        BlockWrite{ .block = BlockType::CoalOre, .replaces = BlockType::Stone },
+        BlockWrite{ .block = BlockType::IronOre, .replaces = BlockType::Stone },
+    };
+
+    CHECK(same_in_every_order(BlockType::Stone, writes, BlockType::IronOre));
+    // Veins never cut into other blocks.
+    CHECK(same_in_every_order(BlockType::Dirt, writes, BlockType::Dirt));
+}
+
+TEST(features_dont_go_over_blocks_of_other_kinds_of_features)
+{
+    // The ore replaced stone, which the log doesn't go over.
+    BlockWrite log{ .block = BlockType::Log };
+    CHECK(!log.applies_to(BlockType::CoalOre));
+
+    // Leaves rank lower than logs.
+    BlockWrite leaves{ .block = BlockType::Leaves };
+    CHECK(!leaves.applies_to(BlockType::Log));
+    CHECK(log.applies_to(BlockType::Leaves));
+}
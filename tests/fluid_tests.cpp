@@ -0,0 +1,186 @@
+#include "test.hpp"
+#include "test_world.hpp"
+#include "world/fluids.hpp"
+
+namespace {
+
+// Test world with a stone floor at y = 0 whose block changes go through the fluid simulation like the world manager's.
+// The simulation steps on every tick, and lava moves on every step.
+class FluidWorld
+{
+public:
+    TestWorld world;
+    FluidSimulation fluids{ world.lookup(), [this](glm::ivec3 chunk_position, std::span<const BlockWrite> writes) {
+                               return write_blocks(chunk_position, writes);
+                           } };
+
+public:
+    FluidWorld()
+    {
+        world.load_chunks({ -1, 0, -1 }, { 1, 0, 1 });
+        world.fill({ -16, 0, -16 }, { 31, 0, 31 }, BlockType::Stone);
+
+        fluids.step_interval = 1;
+        fluids.lava_slowdown = 1;
+    }
+
+    ZTH_NO_COPY_NO_MOVE(FluidWorld)
+
+    ~FluidWorld() = default;
+
+    // Changes the block from outside the simulation, so fluids placed this way are sources.
+    auto set_block(glm::ivec3 block_position, BlockType block) -> void
+    {
+        world.set_block(block_position, block);
+        fluids.block_changed(block_position);
+    }
+
+    auto run_steps(i32 count, std::chrono::microseconds budget = std::chrono::seconds{ 1 }) -> void
+    {
+        for (i32 i = 0; i < count; i++)
+            fluids.tick(FrameBudget{ budget });
+    }
+
+    [[nodiscard]] auto block(glm::ivec3 block_position) const -> BlockType { return world.block(block_position); }
+
+private:
+    auto write_blocks(glm::ivec3 chunk_position, std::span<const BlockWrite> writes) -> bool
+    {
+        if (!world.lookup()(chunk_position))
+            return false;
+
+        for (const auto& write : writes)
+        {
+            if (write.applies_to(world.block(write.position)))
+                set_block(write.position, write.block);
+        }
+
+        return true;
+    }
+};
+
+} // namespace
+
+TEST(water_decays_as_it_spreads_sideways)
+{
+    FluidWorld world;
+    world.set_block({ 0, 1, 0 }, BlockType::Water);
+
+    world.run_steps(20);
+
+    // Water loses a level with every block, so it reaches 7 blocks from the source.
+    CHECK(world.block({ 7, 1, 0 }) == BlockType::Water);
+    CHECK(world.block({ 8, 1, 0 }) == BlockType::Air);
+    CHECK(world.block({ 0, 1, -7 }) == BlockType::Water);
+    CHECK(world.block({ 0, 1, -8 }) == BlockType::Air);
+    CHECK(world.block({ 4, 1, 3 }) == BlockType::Water);
+    CHECK(world.block({ 4, 1, 4 }) == BlockType::Air);
+
+    // It never climbs.
+    CHECK(world.block({ 1, 2, 0 }) == BlockType::Air);
+
+    // Lava loses two, so it reaches 3 blocks.
+    world.set_block({ 20, 1, 20 }, BlockType::Lava);
+
+    world.run_steps(20);
+
+    CHECK(world.block({ 23, 1, 20 }) == BlockType::Lava);
+    CHECK(world.block({ 24, 1, 20 }) == BlockType::Air);
+}
+
+TEST(water_falls_before_it_spreads)
+{
+    FluidWorld world;
+    world.set_block({ 0, 8, 0 }, BlockType::Water);
+
+    world.run_steps(30);
+
+    for (auto y = 1; y < 8; y++)
+        CHECK(world.block({ 0, y, 0 }) == BlockType::Water);
+
+    // Nothing spreads from the source, as there's air below it.
+    CHECK(world.block({ 1, 8, 0 }) == BlockType::Air);
+    CHECK(world.block({ 1, 7, 0 }) == BlockType::Air);
+
+    // Falling water spreads out as if it was one level below a source.
+    CHECK(world.block({ 6, 1, 0 }) == BlockType::Water);
+    CHECK(world.block({ 7, 1, 0 }) == BlockType::Air);
+}
+
+TEST(water_drains_once_its_source_is_removed)
+{
+    FluidWorld world;
+    world.set_block({ 0, 1, 0 }, BlockType::Water);
+
+    world.run_steps(20);
+
+    CHECK(world.block({ 3, 1, 0 }) == BlockType::Water);
+    CHECK(world.fluids.flowing_cells() > 0);
+
+    world.set_block({ 0, 1, 0 }, BlockType::Air);
+
+    world.run_steps(40);
+
+    for (auto x = -8; x <= 8; x++)
+    {
+        for (auto z = -8; z <= 8; z++)
+            CHECK(world.block({ x, 1, z }) == BlockType::Air);
+    }
+
+    CHECK(world.fluids.flowing_cells() == 0);
+    CHECK(world.fluids.active_cells() == 0);
+}
+
+TEST(lava_touching_water_turns_into_stone)
+{
+    FluidWorld world;
+    world.set_block({ 0, 1, 0 }, BlockType::Water);
+    world.set_block({ 6, 1, 0 }, BlockType::Lava);
+
+    world.run_steps(30);
+
+    // No lava is left next to water, and the lava turned into stone where they met.
+    usize stone_count = 0;
+
+    for (auto x = -8; x <= 14; x++)
+    {
+        for (auto z = -8; z <= 8; z++)
+        {
+            glm::ivec3 position{ x, 1, z };
+
+            if (world.block(position) == BlockType::Stone)
+                stone_count++;
+
+            if (world.block(position) != BlockType::Lava)
+                continue;
+
+            for (auto offset : neighbor_offsets)
+                CHECK(world.block(position + offset) != BlockType::Water);
+        }
+    }
+
+    CHECK(stone_count > 0);
+}
+
+TEST(fluid_changes_wait_for_the_budget)
+{
+    FluidWorld world;
+    world.set_block({ 4, 1, 4 }, BlockType::Water);
+    world.set_block({ 20, 1, 4 }, BlockType::Water);
+
+    // Without any budget only one chunk is written per step, the other one's changes stay active.
+    world.run_steps(1, std::chrono::microseconds{ 0 });
+
+    auto spread_in_first = world.block({ 5, 1, 4 }) == BlockType::Water;
+    auto spread_in_second = world.block({ 21, 1, 4 }) == BlockType::Water;
+
+    CHECK(spread_in_first != spread_in_second);
+    CHECK(world.fluids.active_cells() > 0);
+
+    // They're written on later steps.
+    world.run_steps(40, std::chrono::microseconds{ 0 });
+
+    CHECK(world.block({ 5, 1, 4 }) == BlockType::Water);
+    CHECK(world.block({ 21, 1, 4 }) == BlockType::Water);
+    CHECK(world.block({ 27, 1, 4 }) == BlockType::Water);
+}
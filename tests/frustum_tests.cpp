@@ -0,0 +1,128 @@
+#include "frustum.hpp"
+#include "test.hpp"
+
+namespace {
+
+[[nodiscard]] auto box_around(glm::vec3 center, float half_extent) -> Aabb
+{
+    return Aabb{ .min = center - half_extent, .max = center + half_extent };
+}
+
+[[nodiscard]] auto vertex_at(glm::vec3 position) -> BlockVertex
+{
+    return BlockVertex{
+        .position = position, .normal = { 0.0f, 1.0f, 0.0f }, .uv = { 0.0f, 0.0f }, .brightness = 1.0f
+    };
+}
+
+// Looks down -z from the origin with a 90 degree field of view, so the sides of the frustum are at 45 degrees.
+[[nodiscard]] auto make_camera_frustum() -> Frustum
+{
+    auto view = glm::lookAt(glm::vec3{ 0.0f }, glm::vec3{ 0.0f, 0.0f, -1.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+    auto projection = glm::perspective(glm::radians(90.0f), 1.0f, 0.1f, 100.0f);
+    return Frustum{ projection * view };
+}
+
+} // namespace
+
+TEST(bounds_of_covers_every_vertex)
+{
+    std::array vertices = {
+        vertex_at({ 1.0f, -2.0f, 3.0f }),
+        vertex_at({ -4.0f, 5.0f, 0.0f }),
+        vertex_at({ 0.0f, 0.0f, -6.0f }),
+    };
+
+    auto bounds = bounds_of(vertices);
+
+    CHECK(bounds.min == glm::vec3(-4.0f, -2.0f, -6.0f));
+    CHECK(bounds.max == glm::vec3(1.0f, 5.0f, 3.0f));
+}
+
+TEST(bounds_of_no_vertices_is_empty)
+{
+    auto bounds = bounds_of({});
+
+    CHECK(bounds.min == glm::vec3(0.0f));
+    CHECK(bounds.max == glm::vec3(0.0f));
+}
+
+TEST(identity_frustum_is_clip_volume)
+{
+    Frustum frustum{ glm::mat4{ 1.0f } };
+
+    CHECK(frustum.intersects(box_around({ 0.0f, 0.0f, 0.0f }, 0.5f)));
+
+    CHECK(!frustum.intersects(box_around({ -2.0f, 0.0f, 0.0f }, 0.5f))); // Left.
+    CHECK(!frustum.intersects(box_around({ 2.0f, 0.0f, 0.0f }, 0.5f)));  // Right.
+    CHECK(!frustum.intersects(box_around({ 0.0f, -2.0f, 0.0f }, 0.5f))); // Bottom.
+    CHECK(!frustum.intersects(box_around({ 0.0f, 2.0f, 0.0f }, 0.5f)));  // Top.
+    CHECK(!frustum.intersects(box_around({ 0.0f, 0.0f, -2.0f }, 0.5f))); // Near.
+    CHECK(!frustum.intersects(box_around({ 0.0f, 0.0f, 2.0f }, 0.5f)));  // Far.
+
+    // Boxes which only cross a plane still intersect.
+    CHECK(frustum.intersects(box_around({ -1.25f, 0.0f, 0.0f }, 0.5f)));
+    CHECK(frustum.intersects(box_around({ 0.0f, 1.25f, 0.0f }, 0.5f)));
+    CHECK(frustum.intersects(box_around({ 0.0f, 0.0f, 1.25f }, 0.5f)));
+
+    // A box which contains the whole frustum intersects too.
+    CHECK(frustum.intersects(box_around({ 0.0f, 0.0f, 0.0f }, 10.0f)));
+}
+
+TEST(frustum_planes_follow_translation)
+{
+    // Moves the clip volume to x in [-11, -9].
+    Frustum frustum{ glm::translate(glm::mat4{ 1.0f }, glm::vec3{ 10.0f, 0.0f, 0.0f }) };
+
+    CHECK(frustum.intersects(box_around({ -10.0f, 0.0f, 0.0f }, 0.5f)));
+    CHECK(!frustum.intersects(box_around({ 0.0f, 0.0f, 0.0f }, 0.5f)));
+    CHECK(!frustum.intersects(box_around({ -12.0f, 0.0f, 0.0f }, 0.5f)));
+}
+
+TEST(frustum_planes_follow_scale)
+{
+    // Grows the clip volume to [-4, 4] along every axis.
+    Frustum frustum{ glm::scale(glm::mat4{ 1.0f }, glm::vec3{ 0.25f }) };
+
+    CHECK(frustum.intersects(box_around({ 3.0f, -3.0f, 3.0f }, 0.5f)));
+    CHECK(frustum.intersects(box_around({ 4.25f, 0.0f, 0.0f }, 0.5f)));
+    CHECK(!frustum.intersects(box_around({ 5.0f, 0.0f, 0.0f }, 0.5f)));
+    CHECK(!frustum.intersects(box_around({ 0.0f, -5.0f, 0.0f }, 0.5f)));
+}
+
+TEST(camera_frustum_culls_boxes_outside_of_view)
+{
+    auto frustum = make_camera_frustum();
+
+    CHECK(frustum.intersects(box_around({ 0.0f, 0.0f, -10.0f }, 1.0f)));
+    CHECK(frustum.intersects(box_around({ 8.0f, -8.0f, -10.0f }, 1.0f)));
+
+    CHECK(!frustum.intersects(box_around({ 0.0f, 0.0f, 10.0f }, 1.0f)));   // Behind the camera.
+    CHECK(!frustum.intersects(box_around({ 0.0f, 0.0f, -200.0f }, 1.0f))); // Beyond the far plane.
+    CHECK(!frustum.intersects(box_around({ 20.0f, 0.0f, -10.0f }, 1.0f))); // Right of the view.
+    CHECK(!frustum.intersects(box_around({ 0.0f, 20.0f, -10.0f }, 1.0f))); // Above the view.
+
+    // The center lies on the left plane.
+    CHECK(frustum.intersects(box_around({ -10.0f, 0.0f, -10.0f }, 1.0f)));
+}
+
+TEST(cull_writes_visibility_of_every_box)
+{
+    auto frustum = make_camera_frustum();
+
+    std::array boxes = {
+        box_around({ 0.0f, 0.0f, -10.0f }, 1.0f),
+        box_around({ 0.0f, 0.0f, 10.0f }, 1.0f),
+        box_around({ 5.0f, 0.0f, -50.0f }, 1.0f),
+        box_around({ 0.0f, -30.0f, -10.0f }, 1.0f),
+    };
+    std::array<u8, boxes.size()> visible{};
+
+    auto visible_count = frustum.cull(boxes, visible);
+
+    CHECK(visible_count == 2);
+    CHECK(visible[0]);
+    CHECK(!visible[1]);
+    CHECK(visible[2]);
+    CHECK(!visible[3]);
+}
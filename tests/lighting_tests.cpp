@@ -0,0 +1,153 @@
+#include "test.hpp"
+#include "test_world.hpp"
+#include "world/lighting.hpp"
+
+namespace {
+
+// Test world of two layers of chunks whose block changes are relit like the world manager's. Sky light shines down
+// from the top of the world, and the light spreads as if every chunk had been stitched to its neighbors.
+class LightWorld
+{
+public:
+    static constexpr i32 top = 31;
+
+    TestWorld world;
+    LightPropagator light{ world.mutable_lookup() };
+
+public:
+    explicit LightWorld(bool sky = true)
+    {
+        world.load_chunks({ -1, 0, -1 }, { 1, 1, 1 });
+
+        if (!sky)
+            return;
+
+        for (auto x = -16; x < 32; x++)
+        {
+            for (auto z = -16; z < 32; z++)
+            {
+                world.light({ x, top, z }) = full_light;
+                light.add_source({ x, top, z });
+            }
+        }
+
+        light.propagate();
+    }
+
+    ZTH_NO_COPY_NO_MOVE(LightWorld)
+
+    ~LightWorld() = default;
+
+    auto set_block(glm::ivec3 block_position, BlockType block) -> void
+    {
+        world.set_block(block_position, block);
+        light.update_block(block_position);
+    }
+
+    // Changes all the blocks first and relights them together.
+    auto fill(glm::ivec3 first, glm::ivec3 last, BlockType block) -> void
+    {
+        zth::Vector<glm::ivec3> positions;
+
+        for (auto x = first.x; x <= last.x; x++)
+        {
+            for (auto y = first.y; y <= last.y; y++)
+            {
+                for (auto z = first.z; z <= last.z; z++)
+                    positions.push_back({ x, y, z });
+            }
+        }
+
+        world.fill(first, last, block);
+        light.update_blocks(positions);
+    }
+
+    [[nodiscard]] auto sky(glm::ivec3 block_position) -> u8 { return sky_light(world.light(block_position)); }
+    [[nodiscard]] auto emitted(glm::ivec3 block_position) -> u8 { return block_light(world.light(block_position)); }
+};
+
+} // namespace
+
+TEST(sky_light_shines_down_without_fading)
+{
+    LightWorld world;
+
+    CHECK(world.sky({ 0, 0, 0 }) == max_light);
+    CHECK(world.sky({ -16, 10, 31 }) == max_light);
+}
+
+TEST(placing_blocks_shades_the_blocks_below)
+{
+    LightWorld world;
+    world.fill({ -8, 20, -8 }, { 8, 20, 8 }, BlockType::Stone);
+
+    // The roof holds no light. Below it, the sky light comes in sideways from around the roof's edges and loses a level
+    // with every block.
+    CHECK(world.sky({ 0, 20, 0 }) == 0);
+    CHECK(world.sky({ 9, 19, 0 }) == max_light);
+    CHECK(world.sky({ 8, 19, 0 }) == max_light - 1);
+    CHECK(world.sky({ 0, 19, 0 }) == max_light - 9);
+    CHECK(world.sky({ 0, 0, 0 }) == max_light - 9);
+    CHECK(world.sky({ 0, 21, 0 }) == max_light);
+
+    // A single block only shades the column right below it.
+    world.set_block({ 20, 10, 20 }, BlockType::Stone);
+
+    CHECK(world.sky({ 20, 9, 20 }) == max_light - 1);
+    CHECK(world.sky({ 21, 9, 20 }) == max_light);
+}
+
+TEST(removing_blocks_lets_the_light_back_in)
+{
+    LightWorld world;
+    world.fill({ -8, 20, -8 }, { 8, 20, 8 }, BlockType::Stone);
+    world.set_block({ 0, 20, 0 }, BlockType::Air);
+
+    // The hole lets the sky shine straight down through it.
+    CHECK(world.sky({ 0, 20, 0 }) == max_light);
+    CHECK(world.sky({ 0, 0, 0 }) == max_light);
+    CHECK(world.sky({ 1, 19, 0 }) == max_light - 1);
+    CHECK(world.sky({ 2, 19, 2 }) == max_light - 4);
+
+    world.fill({ -8, 20, -8 }, { 8, 20, 8 }, BlockType::Air);
+
+    for (auto x = -9; x <= 9; x++)
+    {
+        for (auto z = -9; z <= 9; z++)
+            CHECK(world.sky({ x, 10, z }) == max_light);
+    }
+}
+
+TEST(emitted_light_crosses_chunk_borders)
+{
+    LightWorld world{ false };
+    world.light.clear_changed_chunks();
+
+    // Right next to the border to the chunk at x = 1.
+    world.set_block({ 15, 20, 5 }, BlockType::Lava);
+
+    CHECK(world.emitted({ 15, 20, 5 }) == max_light);
+    CHECK(world.emitted({ 16, 20, 5 }) == max_light - 1);
+    CHECK(world.emitted({ 20, 20, 5 }) == max_light - 5);
+    CHECK(world.emitted({ 15, 14, 5 }) == max_light - 6);
+    CHECK(world.emitted({ 20, 14, 5 }) == max_light - 11);
+    CHECK(world.sky({ 16, 20, 5 }) == 0);
+    CHECK(std::ranges::contains(world.light.changed_chunks(), glm::ivec3{ 1, 1, 0 }));
+    CHECK(std::ranges::contains(world.light.changed_chunks(), glm::ivec3{ 1, 0, 0 }));
+
+    // A wall along the border makes the light go around it, underneath.
+    world.fill({ 16, 15, -16 }, { 16, 31, 31 }, BlockType::Stone);
+
+    CHECK(world.emitted({ 16, 20, 5 }) == 0);
+    CHECK(world.emitted({ 16, 14, 5 }) == max_light - 7);
+    CHECK(world.emitted({ 17, 15, 5 }) == max_light - 9);
+
+    // Removing the emitter takes away all of its light, on both sides of the border.
+    world.set_block({ 15, 20, 5 }, BlockType::Air);
+
+    for (auto x = 0; x < 32; x++)
+    {
+        for (auto y = 0; y < 32; y++)
+            CHECK(world.emitted({ x, y, 5 }) == 0);
+    }
+}
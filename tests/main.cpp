@@ -0,0 +1,53 @@
+#include <iostream>
+
+#include "test.hpp"
+
+namespace test {
+
+namespace {
+
+usize failed_checks = 0;
+
+} // namespace
+
+auto test_cases() -> zth::Vector<TestCase>&
+{
+    static zth::Vector<TestCase> cases;
+    return cases;
+}
+
+auto register_test(const char* name, TestFunction function) -> bool
+{
+    test_cases().push_back(TestCase{ .name = name, .function = function });
+    return true;
+}
+
+auto report_failure(const char* expression, std::source_location location) -> void
+{
+    failed_checks++;
+    std::cerr << std::format("{}:{}: CHECK({}) failed.\n", location.file_name(), location.line(), expression);
+}
+
+} // namespace test
+
+auto main() -> int
+{
+    usize failed_tests = 0;
+
+    for (const auto& [name, function] : test::test_cases())
+    {
+        auto failed_checks_before = test::failed_checks;
+        function();
+
+        if (test::failed_checks != failed_checks_before)
+        {
+            failed_tests++;
+            std::cerr << std::format("{} failed.\n", name);
+        }
+    }
+
+    std::cout << std::format("{}/{} tests passed.\n", test::test_cases().size() - failed_tests,
+                             test::test_cases().size());
+
+    return failed_tests == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,279 @@
+#include "test.hpp"
+#include "test_world.hpp"
+#include "world/chunk.hpp"
+
+namespace {
+
+using Quad = std::array<BlockVertex, zth::vertices_per_quad>;
+
+// Copies the chunk at the origin of the world with its 26 neighbors. Every block holds full light, so unless a test
+// changes the light of the neighborhood, the brightness of a vertex only depends on its ambient occlusion.
+[[nodiscard]] auto copy_neighborhood(TestWorld& world) -> std::unique_ptr<ChunkNeighborhood>
+{
+    NeighborsArray neighbors{};
+
+    for (usize i = 0; i < apron_neighbor_count; i++)
+    {
+        auto& neighbor = world.load_chunk(apron_neighbor_offsets[i]);
+        neighbor.lights().fill(full_light);
+        neighbors[i] = &neighbor;
+    }
+
+    auto& chunk = world.load_chunk({ 0, 0, 0 });
+    chunk.lights().fill(full_light);
+
+    auto neighborhood = std::make_unique<ChunkNeighborhood>();
+    neighborhood->copy_chunk(chunk);
+    neighborhood->copy_borders(neighbors);
+
+    return neighborhood;
+}
+
+[[nodiscard]] auto mesh_chunk(TestWorld& world) -> zth::Vector<BlockVertex>
+{
+    return copy_neighborhood(world)->generate_mesh();
+}
+
+// The block is given in the mesh's cells, which are as big as the size.
+[[nodiscard]] auto find_top_face(const zth::Vector<BlockVertex>& mesh, glm::ivec3 block, float size = 1.0f)
+    -> Optional<Quad>
+{
+    auto min = (glm::vec3{ block } + glm::vec3{ 0.0f, 1.0f, 0.0f }) * size;
+    auto max = (glm::vec3{ block } + glm::vec3{ 1.0f, 1.0f, 1.0f }) * size;
+
+    for (usize first = 0; first + zth::vertices_per_quad <= mesh.size(); first += zth::vertices_per_quad)
+    {
+        Quad quad{};
+        std::ranges::copy_n(std::next(mesh.begin(), static_cast<zth::isize>(first)), zth::vertices_per_quad,
+                            quad.begin());
+
+        auto on_top = std::ranges::all_of(quad, [&](const BlockVertex& vertex) {
+            return glm::all(glm::greaterThanEqual(vertex.position, min))
+                   && glm::all(glm::lessThanEqual(vertex.position, max)) && vertex.normal.y > 0.0f;
+        });
+
+        if (on_top)
+            return quad;
+    }
+
+    return nil;
+}
+
+[[nodiscard]] auto brightness_at(const Quad& quad, glm::vec3 corner) -> float
+{
+    auto vertex = std::ranges::find(quad, corner, &BlockVertex::position);
+    return vertex != quad.end() ? vertex->brightness : -1.0f;
+}
+
+// Index of the vertex in the quad as it was emitted. The quad is split into triangles along the diagonal between its
+// first and third vertex.
+[[nodiscard]] auto index_at(const Quad& quad, glm::vec3 corner) -> usize
+{
+    return static_cast<usize>(
+        std::ranges::distance(quad.begin(), std::ranges::find(quad, corner, &BlockVertex::position)));
+}
+
+constexpr glm::ivec3 block{ 8, 8, 8 };
+
+// Corners of the block's top face.
+constexpr glm::vec3 near_near{ 8.0f, 9.0f, 8.0f };
+constexpr glm::vec3 far_near{ 9.0f, 9.0f, 8.0f };
+constexpr glm::vec3 near_far{ 8.0f, 9.0f, 9.0f };
+constexpr glm::vec3 far_far{ 9.0f, 9.0f, 9.0f };
+
+} // namespace
+
+TEST(ambient_occlusion_leaves_open_face_bright)
+{
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+
+    auto top = find_top_face(mesh_chunk(world), block);
+
+    CHECK(top.has_value());
+
+    for (auto corner : { near_near, far_near, near_far, far_far })
+        CHECK(approximately_equal(brightness_at(*top, corner), 1.0f));
+}
+
+TEST(ambient_occlusion_darkens_vertices_by_occluding_blocks)
+{
+    // A block beside the far x edge of the top face, and blocks in front of its far x, far z and near x, near z
+    // corners.
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 1, 1, 0 }, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 1, 1, 1 }, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ -1, 1, -1 }, BlockType::Stone);
+
+    auto top = find_top_face(mesh_chunk(world), block);
+
+    CHECK(top.has_value());
+    // A side and the corner.
+    CHECK(approximately_equal(brightness_at(*top, far_far), 0.65f));
+    // A side.
+    CHECK(approximately_equal(brightness_at(*top, far_near), 0.8f));
+    // A corner.
+    CHECK(approximately_equal(brightness_at(*top, near_near), 0.8f));
+    CHECK(approximately_equal(brightness_at(*top, near_far), 1.0f));
+}
+
+TEST(ambient_occlusion_is_full_between_two_sides)
+{
+    // Both sides of the vertex are opaque, the corner between them doesn't matter.
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 1, 1, 0 }, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 0, 1, 1 }, BlockType::Stone);
+
+    auto top = find_top_face(mesh_chunk(world), block);
+
+    CHECK(top.has_value());
+    CHECK(approximately_equal(brightness_at(*top, far_far), 0.5f));
+}
+
+TEST(ambient_occlusion_ignores_non_opaque_blocks)
+{
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 1, 1, 0 }, BlockType::Water);
+
+    auto top = find_top_face(mesh_chunk(world), block);
+
+    CHECK(top.has_value());
+    CHECK(approximately_equal(brightness_at(*top, far_far), 1.0f));
+}
+
+TEST(ambient_occlusion_reads_chunks_across_edges)
+{
+    // The block lies on the chunk's top edge along x, so the block beside its top face lies in the neighbor which only
+    // shares that edge with the chunk.
+    TestWorld world;
+    glm::ivec3 edge_block{ chunk_size.x - 1, chunk_size.y - 1, 8 };
+    world.set_block(edge_block, BlockType::Stone);
+    world.set_block(edge_block + glm::ivec3{ 1, 1, 0 }, BlockType::Stone);
+
+    auto top = find_top_face(mesh_chunk(world), edge_block);
+
+    CHECK(top.has_value());
+
+    auto far_x = static_cast<float>(chunk_size.x);
+    auto top_y = static_cast<float>(chunk_size.y);
+    CHECK(approximately_equal(brightness_at(*top, { far_x, top_y, 8.0f }), 0.8f));
+    CHECK(approximately_equal(brightness_at(*top, { far_x, top_y, 9.0f }), 0.8f));
+    CHECK(approximately_equal(brightness_at(*top, { far_x - 1.0f, top_y, 8.0f }), 1.0f));
+}
+
+TEST(ambient_occlusion_darkens_the_light_of_the_face)
+{
+    // Both end up in the same attribute, so a dim face is darkened even further by the blocks around it.
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 1, 1, 0 }, BlockType::Stone);
+
+    auto neighborhood = copy_neighborhood(world);
+    neighborhood->light(block + glm::ivec3{ 0, 1, 0 }) = pack_light(9, 0);
+
+    auto top = find_top_face(neighborhood->generate_mesh(), block);
+    auto face_brightness = light_brightness[pack_light(9, 0)];
+
+    CHECK(top.has_value());
+    CHECK(approximately_equal(brightness_at(*top, far_far), face_brightness * 0.8f));
+    CHECK(approximately_equal(brightness_at(*top, near_far), face_brightness));
+}
+
+TEST(quad_is_split_away_from_dark_corner)
+{
+    // Whichever corner is darkened, the diagonal which the quad is split along mustn't run through it, or the dark
+    // corner would shade a stripe along the whole diagonal.
+    for (auto [offset, corner] : { std::pair{ glm::ivec3{ -1, 1, -1 }, near_near },
+                                   std::pair{ glm::ivec3{ 1, 1, -1 }, far_near },
+                                   std::pair{ glm::ivec3{ -1, 1, 1 }, near_far },
+                                   std::pair{ glm::ivec3{ 1, 1, 1 }, far_far } })
+    {
+        TestWorld world;
+        world.set_block(block, BlockType::Stone);
+        world.set_block(block + offset, BlockType::Stone);
+
+        auto top = find_top_face(mesh_chunk(world), block);
+
+        CHECK(top.has_value());
+        CHECK(approximately_equal(brightness_at(*top, corner), 0.8f));
+        CHECK(index_at(*top, corner) % 2 == 1);
+    }
+}
+
+TEST(quad_is_split_along_brighter_diagonal)
+{
+    // Blocks beside the near x and the near z edges fully occlude the near corner and half occlude the two corners next
+    // to it.
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ -1, 1, 0 }, BlockType::Stone);
+    world.set_block(block + glm::ivec3{ 0, 1, -1 }, BlockType::Stone);
+
+    auto top = find_top_face(mesh_chunk(world), block);
+
+    CHECK(top.has_value());
+    CHECK(approximately_equal(brightness_at(*top, near_near), 0.5f));
+    CHECK(approximately_equal(brightness_at(*top, far_near), 0.8f));
+    CHECK(approximately_equal(brightness_at(*top, near_far), 0.8f));
+    CHECK(approximately_equal(brightness_at(*top, far_far), 1.0f));
+    // The diagonal between the half occluded corners is the brighter one.
+    CHECK(index_at(*top, near_near) % 2 == 1);
+    CHECK(index_at(*top, far_near) % 2 == 0);
+}
+
+TEST(light_dims_faces_without_scaling_normals)
+{
+    TestWorld world;
+    world.set_block(block, BlockType::Stone);
+
+    auto neighborhood = copy_neighborhood(world);
+    neighborhood->light(block + glm::ivec3{ 0, 1, 0 }) = pack_light(10, 3);
+
+    auto top = find_top_face(neighborhood->generate_mesh(), block);
+
+    CHECK(top.has_value());
+
+    for (const auto& vertex : *top)
+    {
+        CHECK(approximately_equal(vertex.brightness, light_brightness[pack_light(10, 3)]));
+        CHECK(approximately_equal(glm::length(vertex.normal), 1.0f));
+    }
+}
+
+TEST(lod_mesh_is_lit_by_the_cells_in_front)
+{
+    // A floor of two cells at the first level of detail, and the cells in front of its top faces. One of them lies
+    // under the open sky, the other one is dim, but it takes the strongest sky light and block light of its blocks.
+    TestWorld world;
+    world.fill({ 0, 0, 0 }, { 3, 7, 1 }, BlockType::Stone);
+
+    auto neighborhood = copy_neighborhood(world);
+
+    for (auto x = 0; x < 2; x++)
+    {
+        for (auto y = 8; y < 10; y++)
+        {
+            for (auto z = 0; z < 2; z++)
+                neighborhood->light({ x, y, z }) = pack_light(4, 0);
+        }
+    }
+
+    neighborhood->light({ 1, 9, 0 }) = pack_light(6, 0);
+    neighborhood->light({ 0, 8, 1 }) = pack_light(2, 5);
+
+    auto mesh = neighborhood->generate_lod_mesh(1);
+    auto dim = find_top_face(mesh, { 0, 3, 0 }, 2.0f);
+    auto open = find_top_face(mesh, { 1, 3, 0 }, 2.0f);
+
+    CHECK(dim.has_value());
+    CHECK(open.has_value());
+
+    for (const auto& vertex : *dim)
+        CHECK(approximately_equal(vertex.brightness, light_brightness[pack_light(6, 5)]));
+
+    for (const auto& vertex : *open)
+        CHECK(approximately_equal(vertex.brightness, 1.0f));
+}
@@ -0,0 +1,195 @@
+#include "test.hpp"
+#include "test_world.hpp"
+#include "world/raycast.hpp"
+
+TEST(raycast_along_axis_hits_first_solid_block)
+{
+    TestWorld world;
+    world.set_block({ 5, 0, 0 }, BlockType::Stone);
+    world.set_block({ 7, 0, 0 }, BlockType::Dirt);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 0.5f, 0.5f, 0.5f }, .direction = { 1.0f, 0.0f, 0.0f },
+                                            .max_distance = 10.0f });
+
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(5, 0, 0));
+    CHECK(hit->block == BlockType::Stone);
+    CHECK(hit->face == Facing_Left);
+    CHECK(approximately_equal(hit->distance, 4.5f));
+}
+
+TEST(raycast_down_enters_through_top_face)
+{
+    TestWorld world;
+    world.set_block({ 0, 2, 0 }, BlockType::Grass);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 0.5f, 10.5f, 0.5f }, .direction = { 0.0f, -1.0f, 0.0f },
+                                            .max_distance = 20.0f });
+
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(0, 2, 0));
+    CHECK(hit->face == Facing_Up);
+    CHECK(approximately_equal(hit->distance, 7.5f));
+}
+
+TEST(raycast_passes_through_non_solid_blocks)
+{
+    TestWorld world;
+    world.set_block({ 0, 0, -2 }, BlockType::Water);
+    world.set_block({ 0, 0, -4 }, BlockType::Stone);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 0.5f, 0.5f, 0.5f }, .direction = { 0.0f, 0.0f, -1.0f },
+                                            .max_distance = 10.0f });
+
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(0, 0, -4));
+    CHECK(hit->face == Facing_Backward);
+}
+
+TEST(raycast_diagonal_hits_wall_where_the_ray_crosses_it)
+{
+    TestWorld world;
+    world.fill({ 4, -8, -8 }, { 4, 8, 8 }, BlockType::Stone);
+
+    glm::vec3 direction{ 1.0f, 0.5f, 0.25f };
+    auto hit =
+        raycast(world.lookup(), Ray{ .origin = { 0.5f, 0.5f, 0.5f }, .direction = direction, .max_distance = 10.0f });
+
+    // The ray reaches x = 4 after moving 3.5 blocks along x.
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(4, 2, 1));
+    CHECK(hit->face == Facing_Left);
+    CHECK(approximately_equal(hit->distance, 3.5f * glm::length(direction)));
+}
+
+TEST(raycast_diagonal_steps_through_every_block_it_touches)
+{
+    // A ray slightly below the diagonal of the xy plane crosses the x boundaries first, so it passes through (1, 0)
+    // and never through (0, 1).
+    TestWorld world;
+    world.set_block({ 0, 1, 0 }, BlockType::Stone);
+    world.set_block({ 1, 0, 0 }, BlockType::Dirt);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 0.5f, 0.4f, 0.5f }, .direction = { 1.0f, 1.0f, 0.0f },
+                                            .max_distance = 10.0f });
+
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(1, 0, 0));
+    CHECK(hit->face == Facing_Left);
+}
+
+TEST(raycast_direction_doesnt_have_to_be_normalized)
+{
+    TestWorld world;
+    world.set_block({ 5, 0, 0 }, BlockType::Stone);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 0.5f, 0.5f, 0.5f }, .direction = { 3.0f, 0.0f, 0.0f },
+                                            .max_distance = 10.0f });
+
+    CHECK(hit.has_value());
+    CHECK(approximately_equal(hit->distance, 4.5f));
+}
+
+TEST(raycast_crosses_chunk_borders)
+{
+    TestWorld world;
+    world.set_block({ chunk_size.x + 4, 0, 0 }, BlockType::Stone);
+    world.set_block({ -3, 0, 0 }, BlockType::Stone);
+
+    auto forward = raycast(world.lookup(), Ray{ .origin = { 14.5f, 0.5f, 0.5f }, .direction = { 1.0f, 0.0f, 0.0f },
+                                                .max_distance = 20.0f });
+
+    CHECK(forward.has_value());
+    CHECK(forward->block_position == glm::ivec3(chunk_size.x + 4, 0, 0));
+    CHECK(approximately_equal(forward->distance, static_cast<float>(chunk_size.x + 4) - 14.5f));
+
+    // Into the chunks with negative coordinates.
+    auto backward = raycast(world.lookup(), Ray{ .origin = { 1.5f, 0.5f, 0.5f }, .direction = { -1.0f, 0.0f, 0.0f },
+                                                 .max_distance = 20.0f });
+
+    CHECK(backward.has_value());
+    CHECK(backward->block_position == glm::ivec3(-3, 0, 0));
+    CHECK(backward->face == Facing_Right);
+    CHECK(approximately_equal(backward->distance, 3.5f));
+}
+
+TEST(raycast_treats_unloaded_chunks_as_air)
+{
+    // The chunk in between is never loaded.
+    TestWorld world;
+    world.load_chunk({ 0, 0, 0 });
+    world.set_block({ 2 * chunk_size.x + 8, 0, 0 }, BlockType::Stone);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 8.5f, 0.5f, 0.5f }, .direction = { 1.0f, 0.0f, 0.0f },
+                                            .max_distance = 100.0f });
+
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(2 * chunk_size.x + 8, 0, 0));
+}
+
+TEST(raycast_starting_inside_block_hits_it_right_away)
+{
+    TestWorld world;
+    world.set_block({ 2, 0, 0 }, BlockType::Stone);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 2.5f, 0.5f, 0.5f }, .direction = { 1.0f, 0.0f, 0.0f },
+                                            .max_distance = 10.0f });
+
+    CHECK(hit.has_value());
+    CHECK(hit->block_position == glm::ivec3(2, 0, 0));
+    CHECK(hit->face == Facing_None);
+    CHECK(hit->distance == 0.0f);
+}
+
+TEST(raycast_misses_blocks_beyond_max_distance)
+{
+    TestWorld world;
+    world.set_block({ 5, 0, 0 }, BlockType::Stone);
+
+    Ray ray{ .origin = { 0.5f, 0.5f, 0.5f }, .direction = { 1.0f, 0.0f, 0.0f }, .max_distance = 4.4f };
+    CHECK(!raycast(world.lookup(), ray).has_value());
+
+    // The block is hit as soon as the ray reaches its face.
+    ray.max_distance = 4.5f;
+    CHECK(raycast(world.lookup(), ray).has_value());
+}
+
+TEST(raycast_without_direction_misses)
+{
+    TestWorld world;
+    world.set_block({ 0, 0, 0 }, BlockType::Stone);
+
+    auto hit = raycast(world.lookup(), Ray{ .origin = { 0.5f, 0.5f, 0.5f }, .direction = { 0.0f, 0.0f, 0.0f },
+                                            .max_distance = 10.0f });
+
+    CHECK(!hit.has_value());
+}
+
+TEST(batched_raycast_keeps_order_of_rays)
+{
+    TestWorld world;
+    world.fill({ 5, 0, 0 }, { 5, 0, 255 }, BlockType::Stone);
+
+    // Enough rays to be split between several threads. Every other ray points away from the blocks.
+    zth::Vector<Ray> rays;
+
+    for (auto z = 0; z < 256; z++)
+    {
+        auto direction = z % 2 == 0 ? glm::vec3{ 1.0f, 0.0f, 0.0f } : glm::vec3{ -1.0f, 0.0f, 0.0f };
+        rays.push_back(Ray{ .origin = { 0.5f, 0.5f, static_cast<float>(z) + 0.5f },
+                            .direction = direction,
+                            .max_distance = 10.0f });
+    }
+
+    auto hits = raycast(world.lookup(), rays);
+
+    CHECK(hits.size() == rays.size());
+
+    for (usize i = 0; i < hits.size(); i++)
+    {
+        if (i % 2 == 0)
+            CHECK(hits[i].has_value() && hits[i]->block_position == glm::ivec3(5, 0, static_cast<i32>(i)));
+        else
+            CHECK(!hits[i].has_value());
+    }
+}
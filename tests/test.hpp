@@ -0,0 +1,34 @@
+#pragma once
+
+#include <source_location>
+
+// Minimal unit test harness. Tests are functions defined with TEST, which register themselves before main runs, and
+// report failures with CHECK. A failed check doesn't stop the test, so that one run shows every failure.
+
+namespace test {
+
+using TestFunction = auto (*)() -> void;
+
+struct TestCase
+{
+    const char* name;
+    TestFunction function;
+};
+
+[[nodiscard]] auto test_cases() -> zth::Vector<TestCase>&;
+auto register_test(const char* name, TestFunction function) -> bool;
+auto report_failure(const char* expression, std::source_location location = std::source_location::current()) -> void;
+
+} // namespace test
+
+#define TEST(name)                                                                                                     \
+    static auto name() -> void;                                                                                        \
+    [[maybe_unused]] static const bool name##_registered = test::register_test(#name, name);                          \
+    static auto name() -> void
+
+#define CHECK(expression)                                                                                              \
+    do                                                                                                                 \
+    {                                                                                                                  \
+        if (!(expression))                                                                                             \
+            test::report_failure(#expression);                                                                         \
+    } while (false)
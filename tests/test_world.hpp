@@ -0,0 +1,117 @@
+#pragma once
+
+#include "hash.hpp"
+#include "world/chunk.hpp"
+#include "world/lighting.hpp"
+#include "world/raycast.hpp"
+
+// Hand-built world for the tests. Only the chunks which were loaded or had a block set exist, and they start out full
+// of air.
+class TestWorld
+{
+public:
+    auto load_chunk(glm::ivec3 chunk_position) -> ChunkData&
+    {
+        auto& chunk = _chunks[chunk_position];
+
+        if (!chunk)
+        {
+            chunk = std::make_unique<ChunkData>();
+            chunk->blocks().fill(BlockType::Air);
+            chunk->lights().fill(0);
+        }
+
+        return *chunk;
+    }
+
+    // Loads every chunk between the two chunks (inclusive).
+    auto load_chunks(glm::ivec3 first, glm::ivec3 last) -> void
+    {
+        for (auto x = first.x; x <= last.x; x++)
+        {
+            for (auto y = first.y; y <= last.y; y++)
+            {
+                for (auto z = first.z; z <= last.z; z++)
+                    load_chunk({ x, y, z });
+            }
+        }
+    }
+
+    auto set_block(glm::ivec3 block_position, BlockType block) -> void
+    {
+        auto [chunk_position, coordinates] = locate(block_position);
+        load_chunk(chunk_position)[coordinates] = block;
+    }
+
+    // The block's chunk has to be loaded.
+    [[nodiscard]] auto block(glm::ivec3 block_position) const -> BlockType
+    {
+        auto [chunk_position, coordinates] = locate(block_position);
+        auto chunk = _chunks.find(chunk_position);
+        ZTH_ASSERT(chunk != _chunks.end());
+        return (*chunk->second)[coordinates];
+    }
+
+    // Packed light of the block, see light.hpp. Loads the block's chunk.
+    [[nodiscard]] auto light(glm::ivec3 block_position) -> u8&
+    {
+        auto [chunk_position, coordinates] = locate(block_position);
+        return load_chunk(chunk_position).light(coordinates);
+    }
+
+    // Sets every block between the two blocks (inclusive).
+    auto fill(glm::ivec3 first, glm::ivec3 last, BlockType block) -> void
+    {
+        for (auto x = first.x; x <= last.x; x++)
+        {
+            for (auto y = first.y; y <= last.y; y++)
+            {
+                for (auto z = first.z; z <= last.z; z++)
+                    set_block({ x, y, z }, block);
+            }
+        }
+    }
+
+    // Only valid for as long as the world is.
+    [[nodiscard]] auto lookup() const -> ChunkLookup
+    {
+        return [this](glm::ivec3 chunk_position) -> const ChunkData* {
+            auto chunk = _chunks.find(chunk_position);
+            return chunk != _chunks.end() ? chunk->second.get() : nullptr;
+        };
+    }
+
+    // Only valid for as long as the world is.
+    [[nodiscard]] auto mutable_lookup() -> MutableChunkLookup
+    {
+        return [this](glm::ivec3 chunk_position) -> ChunkData* {
+            auto chunk = _chunks.find(chunk_position);
+            return chunk != _chunks.end() ? chunk->second.get() : nullptr;
+        };
+    }
+
+private:
+    zth::UnorderedMap<glm::ivec3, std::unique_ptr<ChunkData>> _chunks;
+
+private:
+    // Returns the position of the block's chunk and the block's coordinates within it.
+    [[nodiscard]] static auto locate(glm::ivec3 block_position) -> std::pair<glm::ivec3, glm::ivec3>
+    {
+        glm::ivec3 chunk_position{ world_x_to_chunk_x(block_position.x), world_y_to_chunk_y(block_position.y),
+                                   world_z_to_chunk_z(block_position.z) };
+        glm::ivec3 chunk_origin{ chunk_x_to_world_x(chunk_position.x), chunk_y_to_world_y(chunk_position.y),
+                                 chunk_z_to_world_z(chunk_position.z) };
+
+        return { chunk_position, block_position - chunk_origin };
+    }
+};
+
+[[nodiscard]] inline auto approximately_equal(float a, float b, float tolerance = 1e-4f) -> bool
+{
+    return std::abs(a - b) <= tolerance;
+}
+
+[[nodiscard]] inline auto approximately_equal(glm::vec3 a, glm::vec3 b, float tolerance = 1e-4f) -> bool
+{
+    return glm::all(glm::lessThanEqual(glm::abs(a - b), glm::vec3{ tolerance }));
+}
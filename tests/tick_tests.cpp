@@ -0,0 +1,227 @@
+#include "test.hpp"
+#include "test_world.hpp"
+#include "world/ticks.hpp"
+
+namespace {
+
+// Test world whose block changes go through the tick scheduler like the world manager's.
+class TickWorld
+{
+public:
+    TestWorld world;
+    TickScheduler ticks{ world.lookup(), [this](glm::ivec3 block_position, BlockType block) {
+                            return set_block(block_position, block);
+                        } };
+
+public:
+    TickWorld() = default;
+
+    ZTH_NO_COPY_NO_MOVE(TickWorld)
+
+    ~TickWorld() = default;
+
+    // Only changes blocks of loaded chunks.
+    auto set_block(glm::ivec3 block_position, BlockType block) -> bool
+    {
+        if (!world.lookup()(chunk_of(block_position)))
+            return false;
+
+        world.set_block(block_position, block);
+        ticks.block_changed(block_position, block);
+        return true;
+    }
+
+    auto run_ticks(i32 count) -> void
+    {
+        for (i32 i = 0; i < count; i++)
+            ticks.tick();
+    }
+
+private:
+    [[nodiscard]] static auto chunk_of(glm::ivec3 block_position) -> glm::ivec3
+    {
+        auto [x, y, z] = block_position;
+        return { world_x_to_chunk_x(x), world_y_to_chunk_y(y), world_z_to_chunk_z(z) };
+    }
+};
+
+} // namespace
+
+TEST(tick_scheduler_builds_sections_of_loaded_chunks)
+{
+    TickWorld world;
+    world.world.set_block({ 3, 4, 5 }, BlockType::Grass);
+    world.world.load_chunk({ 1, 0, 0 });
+
+    world.ticks.add_chunk({ 0, 0, 0 }, world.world.load_chunk({ 0, 0, 0 }));
+    world.ticks.add_chunk({ 1, 0, 0 }, world.world.load_chunk({ 1, 0, 0 }));
+
+    // Only the chunk with a randomly ticked block is active.
+    CHECK(world.ticks.active_sections() == 1);
+
+    // Adding the chunk again after its grass is gone drops its section.
+    world.world.set_block({ 3, 4, 5 }, BlockType::Dirt);
+    world.ticks.add_chunk({ 0, 0, 0 }, world.world.load_chunk({ 0, 0, 0 }));
+
+    CHECK(world.ticks.active_sections() == 0);
+}
+
+TEST(tick_scheduler_keeps_sections_up_to_date)
+{
+    TickWorld world;
+    world.world.load_chunks({ 0, 0, 0 }, { 1, 0, 0 });
+
+    world.set_block({ 1, 1, 1 }, BlockType::Grass);
+    world.set_block({ 2, 1, 1 }, BlockType::Grass);
+    world.set_block({ 17, 1, 1 }, BlockType::Grass);
+
+    CHECK(world.ticks.active_sections() == 2);
+
+    // Setting the same block again doesn't count it twice, so the section goes away once its last grass is gone.
+    world.set_block({ 1, 1, 1 }, BlockType::Grass);
+    world.set_block({ 1, 1, 1 }, BlockType::Dirt);
+
+    CHECK(world.ticks.active_sections() == 2);
+
+    world.set_block({ 2, 1, 1 }, BlockType::Stone);
+
+    CHECK(world.ticks.active_sections() == 1);
+
+    // Blocks which aren't randomly ticked never add a section.
+    world.set_block({ 4, 4, 4 }, BlockType::Stone);
+
+    CHECK(world.ticks.active_sections() == 1);
+
+    world.ticks.remove_chunk({ 1, 0, 0 });
+
+    CHECK(world.ticks.active_sections() == 0);
+}
+
+TEST(tick_scheduler_runs_updates_when_due)
+{
+    TickWorld world;
+    world.world.load_chunk({ 0, 0, 0 });
+    world.world.set_block({ 0, 5, 0 }, BlockType::Sand);
+
+    world.ticks.schedule({ 0, 5, 0 }, 3);
+
+    CHECK(world.ticks.scheduled_updates() == 1);
+
+    world.run_ticks(3);
+
+    CHECK(world.world.block({ 0, 5, 0 }) == BlockType::Sand);
+
+    world.run_ticks(1);
+
+    CHECK(world.world.block({ 0, 5, 0 }) == BlockType::Air);
+    CHECK(world.world.block({ 0, 4, 0 }) == BlockType::Sand);
+
+    // Moving the sand scheduled its next fall.
+    world.run_ticks(static_cast<i32>(TickScheduler::fall_delay));
+
+    CHECK(world.world.block({ 0, 3, 0 }) == BlockType::Sand);
+}
+
+TEST(tick_scheduler_wraps_around_the_wheel)
+{
+    TickWorld world;
+    world.world.load_chunk({ 0, 0, 0 });
+    world.world.set_block({ 0, 5, 0 }, BlockType::Sand);
+    world.world.set_block({ 8, 5, 0 }, BlockType::Sand);
+
+    // Due a whole turn of the wheel after its slot is first visited.
+    world.ticks.schedule({ 8, 5, 0 }, static_cast<u32>(TickScheduler::wheel_size) + 3);
+
+    // Due in a slot past the end of the wheel.
+    world.run_ticks(static_cast<i32>(TickScheduler::wheel_size) - 2);
+    world.ticks.schedule({ 0, 5, 0 }, 5);
+
+    CHECK(world.ticks.scheduled_updates() == 2);
+
+    world.run_ticks(5);
+
+    CHECK(world.world.block({ 0, 5, 0 }) == BlockType::Sand);
+    CHECK(world.world.block({ 8, 5, 0 }) == BlockType::Sand);
+
+    world.run_ticks(1);
+
+    CHECK(world.world.block({ 0, 5, 0 }) == BlockType::Air);
+    CHECK(world.world.block({ 8, 5, 0 }) == BlockType::Air);
+    CHECK(world.world.block({ 8, 4, 0 }) == BlockType::Sand);
+}
+
+TEST(tick_scheduler_drops_sand_onto_the_floor)
+{
+    TickWorld world;
+    world.world.load_chunks({ 0, -1, 0 }, { 0, 0, 0 });
+    world.world.set_block({ 0, 0, 0 }, BlockType::Stone);
+    world.world.set_block({ 0, 8, 0 }, BlockType::Stone);
+
+    // Removing the block below the sand lets it fall.
+    world.set_block({ 0, 9, 0 }, BlockType::Sand);
+    world.set_block({ 0, 8, 0 }, BlockType::Air);
+
+    world.run_ticks(static_cast<i32>(TickScheduler::fall_delay) * 12);
+
+    CHECK(world.world.block({ 0, 1, 0 }) == BlockType::Sand);
+    CHECK(world.world.block({ 0, 9, 0 }) == BlockType::Air);
+    CHECK(world.ticks.scheduled_updates() == 0);
+
+    // Falling into a chunk which isn't loaded would lose the block.
+    world.set_block({ 0, -16, 0 }, BlockType::Sand);
+    world.run_ticks(static_cast<i32>(TickScheduler::fall_delay) * 2);
+
+    CHECK(world.world.block({ 0, -16, 0 }) == BlockType::Sand);
+}
+
+TEST(grass_dies_under_opaque_blocks)
+{
+    TickWorld world;
+    world.world.load_chunk({ 0, 0, 0 });
+    world.ticks.random_ticks_per_section = blocks_in_chunk;
+
+    for (auto x = 0; x < chunk_size.x; x++)
+    {
+        for (auto z = 0; z < chunk_size.z; z++)
+        {
+            world.set_block({ x, 1, z }, BlockType::Grass);
+            world.set_block({ x, 2, z }, x < 8 ? BlockType::Stone : BlockType::Air);
+        }
+    }
+
+    world.run_ticks(100);
+
+    for (auto x = 0; x < chunk_size.x; x++)
+    {
+        for (auto z = 0; z < chunk_size.z; z++)
+            CHECK(world.world.block({ x, 1, z }) == (x < 8 ? BlockType::Dirt : BlockType::Grass));
+    }
+}
+
+TEST(grass_spreads_onto_lit_dirt)
+{
+    TickWorld world;
+    world.world.load_chunk({ 0, 0, 0 });
+    world.ticks.random_ticks_per_section = blocks_in_chunk;
+
+    world.set_block({ 5, 5, 5 }, BlockType::Grass);
+    world.set_block({ 6, 5, 5 }, BlockType::Dirt);
+    world.set_block({ 5, 4, 6 }, BlockType::Dirt);
+    world.set_block({ 5, 5, 4 }, BlockType::Dirt);
+    world.set_block({ 4, 5, 5 }, BlockType::Dirt);
+    world.set_block({ 4, 6, 5 }, BlockType::Stone);
+
+    world.world.light({ 6, 6, 5 }) = full_light;
+    world.world.light({ 5, 5, 6 }) = pack_light(0, max_light);
+    world.world.light({ 5, 6, 4 }) = pack_light(8, 0);
+
+    world.run_ticks(200);
+
+    // Lit by the sky or a block, or lit too dimly.
+    CHECK(world.world.block({ 6, 5, 5 }) == BlockType::Grass);
+    CHECK(world.world.block({ 5, 4, 6 }) == BlockType::Grass);
+    CHECK(world.world.block({ 5, 5, 4 }) == BlockType::Dirt);
+
+    // Covered by an opaque block.
+    CHECK(world.world.block({ 4, 5, 5 }) == BlockType::Dirt);
+}
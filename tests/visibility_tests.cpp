@@ -0,0 +1,220 @@
+#include "test.hpp"
+#include "world/chunk.hpp"
+#include "world/occlusion.hpp"
+#include "world/visibility.hpp"
+
+namespace {
+
+[[nodiscard]] auto make_filled_chunk(BlockType block) -> std::unique_ptr<ChunkData>
+{
+    auto chunk = std::make_unique<ChunkData>();
+    chunk->blocks().fill(block);
+    chunk->lights().fill(0);
+    return chunk;
+}
+
+// Carves a straight line of air between two blocks which differ in a single coordinate.
+auto carve(ChunkData& chunk, glm::ivec3 from, glm::ivec3 to) -> void
+{
+    auto min = glm::min(from, to);
+    auto max = glm::max(from, to);
+
+    for (auto x = min.x; x <= max.x; x++)
+    {
+        for (auto y = min.y; y <= max.y; y++)
+        {
+            for (auto z = min.z; z <= max.z; z++)
+                chunk[{ x, y, z }] = BlockType::Air;
+        }
+    }
+}
+
+// Checks that exactly the given pairs of faces are connected.
+[[nodiscard]] auto connects_only(ChunkVisibility visibility, std::initializer_list<std::pair<usize, usize>> pairs)
+    -> bool
+{
+    for (usize a = 0; a < neighbor_count; a++)
+    {
+        for (usize b = a + 1; b < neighbor_count; b++)
+        {
+            auto expected = std::ranges::any_of(pairs, [a, b](const auto& pair) {
+                return (pair.first == a && pair.second == b) || (pair.first == b && pair.second == a);
+            });
+
+            if (visibility.connected(a, b) != expected)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+constexpr glm::ivec3 last{ chunk_size.x - 1, chunk_size.y - 1, chunk_size.z - 1 };
+constexpr glm::ivec3 middle{ chunk_size.x / 2, chunk_size.y / 2, chunk_size.z / 2 };
+
+} // namespace
+
+TEST(air_chunk_connects_every_face)
+{
+    auto chunk = make_filled_chunk(BlockType::Air);
+    CHECK(ChunkVisibility::compute(*chunk).mask() == ChunkVisibility::all().mask());
+}
+
+TEST(solid_chunk_connects_no_faces)
+{
+    auto chunk = make_filled_chunk(BlockType::Stone);
+    CHECK(ChunkVisibility::compute(*chunk).mask() == 0);
+}
+
+TEST(transparent_blocks_connect_faces)
+{
+    auto chunk = make_filled_chunk(BlockType::Water);
+    CHECK(ChunkVisibility::compute(*chunk).mask() == ChunkVisibility::all().mask());
+}
+
+TEST(straight_tunnel_connects_opposite_faces)
+{
+    auto chunk = make_filled_chunk(BlockType::Stone);
+    carve(*chunk, { 0, middle.y, middle.z }, { last.x, middle.y, middle.z });
+
+    CHECK(connects_only(ChunkVisibility::compute(*chunk), { { plus_x_idx, minus_x_idx } }));
+}
+
+TEST(bent_tunnel_connects_adjacent_faces)
+{
+    auto chunk = make_filled_chunk(BlockType::Stone);
+    carve(*chunk, { 0, middle.y, middle.z }, { middle.x, middle.y, middle.z });
+    carve(*chunk, { middle.x, middle.y, middle.z }, { middle.x, last.y, middle.z });
+
+    CHECK(connects_only(ChunkVisibility::compute(*chunk), { { minus_x_idx, plus_y_idx } }));
+}
+
+TEST(separate_pockets_dont_connect_each_other)
+{
+    auto chunk = make_filled_chunk(BlockType::Stone);
+    carve(*chunk, { 0, 4, middle.z }, { last.x, 4, middle.z });
+    carve(*chunk, { middle.x, 12, 0 }, { middle.x, 12, last.z });
+
+    auto visibility = ChunkVisibility::compute(*chunk);
+    CHECK(connects_only(visibility, { { plus_x_idx, minus_x_idx }, { plus_z_idx, minus_z_idx } }));
+}
+
+TEST(diagonal_gaps_dont_connect)
+{
+    // The two halves of the tunnel only touch along an edge, which can't be seen through.
+    auto chunk = make_filled_chunk(BlockType::Stone);
+    carve(*chunk, { 0, middle.y, middle.z }, { middle.x, middle.y, middle.z });
+    carve(*chunk, { middle.x + 1, middle.y + 1, middle.z }, { last.x, middle.y + 1, middle.z });
+
+    CHECK(ChunkVisibility::compute(*chunk).mask() == 0);
+}
+
+TEST(wall_separates_its_sides)
+{
+    auto chunk = make_filled_chunk(BlockType::Air);
+
+    for (auto y = 0; y < chunk_size.y; y++)
+    {
+        for (auto z = 0; z < chunk_size.z; z++)
+            (*chunk)[{ middle.x, y, z }] = BlockType::Stone;
+    }
+
+    auto visibility = ChunkVisibility::compute(*chunk);
+
+    CHECK(!visibility.connected(plus_x_idx, minus_x_idx));
+    CHECK(visibility.connected(plus_x_idx, plus_y_idx));
+    CHECK(visibility.connected(minus_x_idx, plus_y_idx));
+    CHECK(visibility.connected(plus_z_idx, minus_z_idx));
+    CHECK(visibility.connected(plus_y_idx, minus_y_idx));
+}
+
+TEST(neighborhood_visibility_ignores_apron)
+{
+    auto chunk = make_filled_chunk(BlockType::Stone);
+    carve(*chunk, { 0, middle.y, middle.z }, { middle.x, middle.y, middle.z });
+    carve(*chunk, { middle.x, middle.y, middle.z }, { middle.x, last.y, middle.z });
+
+    // The apron is all air, which mustn't connect the faces of the chunk.
+    auto air = make_filled_chunk(BlockType::Air);
+    NeighborsArray neighbors;
+    neighbors.fill(air.get());
+
+    auto neighborhood = std::make_unique<ChunkNeighborhood>();
+    neighborhood->copy_chunk(*chunk);
+    neighborhood->copy_borders(neighbors);
+
+    CHECK(ChunkVisibility::compute(*neighborhood).mask() == ChunkVisibility::compute(*chunk).mask());
+    CHECK(connects_only(ChunkVisibility::compute(*neighborhood), { { minus_x_idx, plus_y_idx } }));
+}
+
+TEST(occlusion_culler_never_enters_sealed_chunk)
+{
+    // A corridor of chunks along x, where the third chunk is solid.
+    auto lookup = [](glm::ivec3 chunk_position) -> Optional<ChunkVisibility> {
+        if (chunk_position.y != 0 || chunk_position.z != 0 || chunk_position.x < 0 || chunk_position.x > 4)
+            return nil;
+
+        if (chunk_position.x == 2)
+            return ChunkVisibility{};
+
+        return ChunkVisibility::all();
+    };
+
+    OcclusionCuller culler;
+    const auto& visible_chunks = culler.find_visible_chunks({ 0, 0, 0 }, lookup);
+
+    CHECK(visible_chunks.contains(glm::ivec3{ 0, 0, 0 }));
+    CHECK(visible_chunks.contains(glm::ivec3{ 1, 0, 0 }));
+    // The sealed chunk's surface can be seen, but nothing behind it.
+    CHECK(visible_chunks.contains(glm::ivec3{ 2, 0, 0 }));
+    CHECK(!visible_chunks.contains(glm::ivec3{ 3, 0, 0 }));
+    CHECK(!visible_chunks.contains(glm::ivec3{ 4, 0, 0 }));
+}
+
+TEST(occlusion_culler_follows_connected_faces)
+{
+    // The chunk in the middle only lets the walk through from minus x to plus y.
+    ChunkVisibility bend;
+    bend.connect(minus_x_idx, plus_y_idx);
+
+    auto lookup = [bend](glm::ivec3 chunk_position) -> Optional<ChunkVisibility> {
+        if (glm::any(glm::greaterThan(glm::abs(chunk_position), glm::ivec3{ 2 })))
+            return nil;
+
+        if (chunk_position == glm::ivec3{ 1, 0, 0 })
+            return bend;
+
+        return ChunkVisibility::all();
+    };
+
+    OcclusionCuller culler;
+    const auto& visible_chunks = culler.find_visible_chunks({ 0, 0, 0 }, lookup);
+
+    CHECK(visible_chunks.contains(glm::ivec3{ 1, 0, 0 }));
+    CHECK(visible_chunks.contains(glm::ivec3{ 1, 1, 0 }));
+    CHECK(visible_chunks.contains(glm::ivec3{ 1, 2, 0 }));
+    // Only reachable by leaving the bend through plus x.
+    CHECK(!visible_chunks.contains(glm::ivec3{ 2, 0, 0 }));
+}
+
+TEST(occlusion_culler_skips_chunks_outside_of_frustum)
+{
+    auto lookup = [](glm::ivec3 chunk_position) -> Optional<ChunkVisibility> {
+        if (glm::any(glm::greaterThan(glm::abs(chunk_position), glm::ivec3{ 3 })))
+            return nil;
+
+        return ChunkVisibility::all();
+    };
+
+    // Looks down plus x from the middle of the camera's chunk.
+    auto eye = glm::vec3{ chunk_size } * 0.5f;
+    auto view = glm::lookAt(eye, eye + glm::vec3{ 1.0f, 0.0f, 0.0f }, glm::vec3{ 0.0f, 1.0f, 0.0f });
+    auto projection = glm::perspective(glm::radians(60.0f), 1.0f, 0.1f, 1000.0f);
+    Frustum frustum{ projection * view };
+
+    OcclusionCuller culler;
+    const auto& visible_chunks = culler.find_visible_chunks({ 0, 0, 0 }, lookup, &frustum);
+
+    CHECK(visible_chunks.contains(glm::ivec3{ 3, 0, 0 }));
+    CHECK(!visible_chunks.contains(glm::ivec3{ -2, 0, 0 }));
+}